@@ -0,0 +1,90 @@
+// Compares the table-driven hex formatter with the per-byte printf loop the
+// receive worker used to run (furi_string_cat_printf + furi_string_push_back).
+
+#include "lora_hex_format.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHUNK_SIZE 256
+#define ITERATIONS 20000
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} DynString;
+
+static void dyn_reserve(DynString* str, size_t size) {
+    if(size + 1 > str->capacity) {
+        str->capacity = (size + 1) * 2;
+        str->data = realloc(str->data, str->capacity);
+    }
+}
+
+static void dyn_cat_printf_byte(DynString* str, uint8_t byte) {
+    int length = snprintf(NULL, 0, "%02X", byte);
+    dyn_reserve(str, str->size + length);
+    snprintf(str->data + str->size, str->capacity - str->size, "%02X", byte);
+    str->size += length;
+}
+
+static void dyn_push_back(DynString* str, char c) {
+    dyn_reserve(str, str->size + 1);
+    str->data[str->size++] = c;
+    str->data[str->size] = '\0';
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void) {
+    uint8_t chunk[CHUNK_SIZE];
+    for(size_t i = 0; i < CHUNK_SIZE; i++) {
+        chunk[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    // Baseline: a fresh string per chunk, like new_str in the old worker
+    volatile size_t sink = 0;
+    double start = now_ns();
+    for(int it = 0; it < ITERATIONS; it++) {
+        DynString str = {0};
+        for(size_t i = 0; i < CHUNK_SIZE; i++) {
+            dyn_cat_printf_byte(&str, chunk[i]);
+            dyn_push_back(&str, ' ');
+        }
+        sink += str.size;
+        free(str.data);
+    }
+    double printf_ns = (now_ns() - start) / ((double)ITERATIONS * CHUNK_SIZE);
+
+    char out[LORA_HEX_FORMAT_SIZE(CHUNK_SIZE)];
+    start = now_ns();
+    for(int it = 0; it < ITERATIONS; it++) {
+        sink += lora_hex_format(chunk, CHUNK_SIZE, ' ', out, sizeof(out));
+    }
+    double table_ns = (now_ns() - start) / ((double)ITERATIONS * CHUNK_SIZE);
+
+    // Both paths must produce identical text
+    DynString check = {0};
+    for(size_t i = 0; i < CHUNK_SIZE; i++) {
+        dyn_cat_printf_byte(&check, chunk[i]);
+        dyn_push_back(&check, ' ');
+    }
+    lora_hex_format(chunk, CHUNK_SIZE, ' ', out, sizeof(out));
+    int match = strcmp(check.data, out) == 0;
+    free(check.data);
+
+    printf("hex format, %d x %d byte chunks\n", ITERATIONS, CHUNK_SIZE);
+    printf("  printf loop : %8.2f ns/byte\n", printf_ns);
+    printf("  table       : %8.2f ns/byte\n", table_ns);
+    printf("  speedup     : %8.1fx\n", printf_ns / table_ns);
+    printf("  output      : %s\n", match ? "identical" : "MISMATCH");
+
+    return match ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Replays a stream through the receive path (ISR, worker, view refresh) at
+// every rate the app can set, like the on-device RX Benchmark does with DWT.
+//
+//   bench_rx_pipeline [capture.bin ...]
+//
+// Capture files are the ones the receive scene records to
+// /ext/LoRa_Setting/captures, replayed with their recorded spacing.
+
+#include "lora_rx_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_PACKETS 1024
+
+/** Same list as baud_rates[] in lora_tester.c */
+static const uint32_t rates[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200};
+
+/** Nanoseconds, so a cycle is a nanosecond at cycles_per_us = 1000 */
+static uint32_t clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+static double per(uint64_t total, uint32_t count) {
+    return count ? (double)total / count : 0;
+}
+
+static int run(const char* name, LoraRxBench* bench) {
+    LoraRxBenchResult result;
+    uint32_t lost = 0;
+
+    printf("%s, %zu packets\n", name, bench->count);
+    printf("     baud  isr ns/B  wkr ns/B  view ns  refresh  dropped  overrun  lat avg/max ms\n");
+    for(size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if(!lora_rx_bench_run(bench, rates[i], &result)) {
+            return 1;
+        }
+        printf(
+            "  %7u  %8.1f  %8.1f  %7.0f  %7u  %7u  %7u  %6.1f/%.1f\n",
+            (unsigned)result.baud_rate,
+            per(result.isr_cycles, result.bytes),
+            per(result.worker_cycles, result.bytes),
+            per(result.refresh_cycles, result.refreshes),
+            (unsigned)result.refreshes,
+            (unsigned)result.dropped,
+            (unsigned)result.overruns,
+            result.latency_mean_us / 1000.0,
+            result.latency_max_us / 1000.0);
+        lost += result.dropped + result.overruns;
+    }
+    printf("  max sustainable rate: %u baud\n\n", (unsigned)lora_rx_bench_max_rate(bench));
+    return lost ? 1 : 0;
+}
+
+static int run_capture(const char* path, LoraRxBenchPacket* packets) {
+    uint8_t* image = malloc(LORA_RX_BENCH_CAPTURE_MAX);
+    FILE* file = fopen(path, "rb");
+    if(!file || !image) {
+        fprintf(stderr, "%s: can't read\n", path);
+        if(file) fclose(file);
+        free(image);
+        return 1;
+    }
+    size_t size = fread(image, 1, LORA_RX_BENCH_CAPTURE_MAX, file);
+    fclose(file);
+
+    uint32_t baud_rate;
+    LoraRxBench bench = {
+        .packets = packets, .timed = true, .clock = clock_ns, .cycles_per_us = 1000};
+    bench.count = lora_rx_bench_parse_capture(
+        image, size, packets, MAX_PACKETS, &baud_rate, &bench.rssi_byte);
+    int status = 1;
+    if(bench.count) {
+        printf("(recorded at %u baud) ", (unsigned)baud_rate);
+        status = run(path, &bench);
+    } else {
+        fprintf(stderr, "%s: not a capture\n", path);
+    }
+    free(image);
+    return status;
+}
+
+int main(int argc, char** argv) {
+    static LoraRxBenchPacket packets[MAX_PACKETS];
+    static uint8_t buffer[64 * 1024];
+    int status = 0;
+
+    LoraRxBench bench = {.packets = packets, .clock = clock_ns, .cycles_per_us = 1000};
+    bench.count = lora_rx_bench_synthetic(packets, MAX_PACKETS, buffer, sizeof(buffer));
+    status |= run("synthetic, back to back", &bench);
+
+    bench.rssi_byte = true;
+    status |= run("synthetic with RSSI byte", &bench);
+
+    for(int i = 1; i < argc; i++) {
+        status |= run_capture(argv[i], packets);
+    }
+
+    // Drops at any supported rate on a desktop would mean the path itself is broken
+    return status;
+}
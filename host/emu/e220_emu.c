@@ -0,0 +1,468 @@
+#include "e220_emu.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <lora_config_binary_convert.h>
+
+#define E220_EMU_PIN_AUX 4
+#define E220_EMU_PIN_M0 6
+#define E220_EMU_PIN_M1 7
+
+#define E220_EMU_CMD_WRITE 0xC0
+#define E220_EMU_CMD_READ 0xC1
+#define E220_EMU_CMD_WRITE_TEMPORARY 0xC2
+#define E220_EMU_MAX_COMMAND (3 + LORA_CONFIG_REG_COUNT)
+
+/** Bytes delivered per receive event, about what a hardware FIFO holds per interrupt */
+#define E220_EMU_UART_CHUNK 8
+/** From the last command byte to the first response byte, the datasheet gives no figure */
+#define E220_EMU_TURNAROUND_US 500
+#define E220_EMU_MODE_SWITCH_US 2000
+/** Silence after which host bytes in normal mode are sent as one packet */
+#define E220_EMU_TX_IDLE_BYTES 3
+/** Largest subpacket plus the fixed mode header */
+#define E220_EMU_TX_BUFFER_SIZE (200 + 3)
+
+#define E220_EMU_REG3_FIXED (1 << 6)
+#define E220_EMU_REG3_RSSI_BYTE (1 << 7)
+
+/** Scheduler context for one kind of event, so each can be cancelled on its own */
+typedef struct {
+    E220Emu* emu;
+} E220EmuTimer;
+
+struct E220Emu {
+    uint8_t saved[LORA_CONFIG_REG_COUNT];
+    uint8_t working[LORA_CONFIG_REG_COUNT];
+    /** Follows REG0 once the module has finished writing at the old rate */
+    uint32_t baud_rate;
+
+    E220EmuMode mode;
+    uint32_t mode_switch_us;
+    /** AUX is low while any of these is true */
+    bool switching;
+    bool transmitting;
+    bool outputting;
+
+    uint8_t command[E220_EMU_MAX_COMMAND];
+    size_t command_length;
+    /** The next register reply has its first data byte inverted */
+    bool corrupt_reply;
+    uint8_t tx[E220_EMU_TX_BUFFER_SIZE];
+    size_t tx_length;
+    uint8_t air[E220_EMU_TX_BUFFER_SIZE];
+    size_t air_length;
+    uint16_t air_address;
+    uint8_t air_channel;
+
+    uint8_t* out;
+    size_t out_length;
+    size_t out_position;
+    size_t out_capacity;
+
+    uint8_t rssi_ambient;
+    uint8_t rssi_last;
+    E220EmuAirCallback air_callback;
+    void* air_context;
+    E220EmuStats stats;
+
+    E220EmuTimer mode_timer;
+    E220EmuTimer out_timer;
+    E220EmuTimer idle_timer;
+    E220EmuTimer tx_timer;
+    E220EmuTimer air_timer;
+};
+
+static const uint8_t e220_emu_rssi_command[] = {0xC0, 0xC1, 0xC2, 0xC3};
+
+static uint64_t e220_emu_byte_us(const E220Emu* emu, size_t bytes) {
+    // 8N1, rounded up so a stream never runs faster than the wire
+    return ((uint64_t)bytes * 10 * 1000000 + emu->baud_rate - 1) / emu->baud_rate;
+}
+
+static uint32_t e220_emu_reg_baud_rate(const uint8_t* registers) {
+    return lora_config_uart_rates[registers[LoraReg0] >> 5];
+}
+
+static uint16_t e220_emu_address(const E220Emu* emu) {
+    return (emu->working[LoraRegAddH] << 8) | emu->working[LoraRegAddL];
+}
+
+/** Time on air, 12.25 preamble and 8 header symbols plus the payload at coding rate 4/5 */
+static uint64_t e220_emu_airtime_us(const E220Emu* emu, size_t length) {
+    LoRaConfig config;
+    lora_config_decode(emu->working, &config);
+    uint64_t symbol_us = ((uint64_t)1 << config.sf) * 1000 / config.bw;
+    uint64_t payload_symbols = (length * 8 * 5 + config.sf * 4 - 1) / (config.sf * 4);
+    return symbol_us * 81 / 4 + symbol_us * payload_symbols;
+}
+
+static void e220_emu_idle_event(void* context);
+
+static void e220_emu_update_aux(E220Emu* emu) {
+    furi_shim_gpio_drive(
+        E220_EMU_PIN_AUX, !(emu->switching || emu->transmitting || emu->outputting));
+}
+
+static void e220_emu_out_event(void* context) {
+    E220Emu* emu = ((E220EmuTimer*)context)->emu;
+    size_t length = emu->out_length - emu->out_position;
+    if(length > E220_EMU_UART_CHUNK) {
+        length = E220_EMU_UART_CHUNK;
+    }
+
+    furi_shim_serial_receive(&emu->out[emu->out_position], length, emu->baud_rate);
+    emu->out_position += length;
+    emu->stats.uart_bytes += length;
+
+    size_t remaining = emu->out_length - emu->out_position;
+    if(remaining) {
+        size_t next = remaining > E220_EMU_UART_CHUNK ? E220_EMU_UART_CHUNK : remaining;
+        furi_shim_schedule_us(e220_emu_byte_us(emu, next), e220_emu_out_event, &emu->out_timer);
+    } else {
+        // The USART flags idle after one frame of silence
+        furi_shim_schedule_us(e220_emu_byte_us(emu, 1), e220_emu_idle_event, &emu->idle_timer);
+    }
+}
+
+static void e220_emu_idle_event(void* context) {
+    E220Emu* emu = ((E220EmuTimer*)context)->emu;
+    emu->out_length = 0;
+    emu->out_position = 0;
+    furi_shim_serial_idle();
+
+    // A C0 write to REG0 is echoed at the old rate and takes effect after it
+    emu->baud_rate = e220_emu_reg_baud_rate(emu->working);
+    emu->outputting = false;
+    e220_emu_update_aux(emu);
+}
+
+/** Queue bytes for the host, starting after delay_us unless a stream is already running */
+static void e220_emu_output(E220Emu* emu, const uint8_t* data, size_t length, uint64_t delay_us) {
+    if(emu->out_length + length > emu->out_capacity) {
+        emu->out_capacity = (emu->out_length + length) * 2;
+        emu->out = realloc(emu->out, emu->out_capacity);
+        furi_check(emu->out);
+    }
+    memcpy(&emu->out[emu->out_length], data, length);
+    emu->out_length += length;
+
+    if(!emu->outputting) {
+        emu->outputting = true;
+        e220_emu_update_aux(emu);
+    } else if(emu->out_position + length < emu->out_length) {
+        // Bytes still on the way, they carry the new ones along
+        return;
+    } else {
+        // Caught before the line was flagged idle, so it never is
+        furi_shim_cancel(&emu->idle_timer);
+    }
+
+    size_t first = length > E220_EMU_UART_CHUNK ? E220_EMU_UART_CHUNK : length;
+    furi_shim_schedule_us(
+        delay_us + e220_emu_byte_us(emu, first), e220_emu_out_event, &emu->out_timer);
+}
+
+static void e220_emu_reply_error(E220Emu* emu) {
+    static const uint8_t error[] = {0xFF, 0xFF, 0xFF};
+    emu->stats.bad_commands++;
+    emu->command_length = 0;
+    e220_emu_output(emu, error, sizeof(error), E220_EMU_TURNAROUND_US);
+}
+
+/** Run every complete command in the buffer, keeping a partial one for the next bytes */
+static void e220_emu_config_commands(E220Emu* emu) {
+    while(emu->command_length) {
+        uint8_t opcode = emu->command[0];
+        if(opcode != E220_EMU_CMD_WRITE && opcode != E220_EMU_CMD_READ &&
+           opcode != E220_EMU_CMD_WRITE_TEMPORARY) {
+            e220_emu_reply_error(emu);
+            return;
+        }
+        if(emu->command_length < 3) {
+            return;
+        }
+
+        uint8_t address = emu->command[1];
+        uint8_t length = emu->command[2];
+        if(length == 0 || address + length > LORA_CONFIG_REG_COUNT) {
+            e220_emu_reply_error(emu);
+            return;
+        }
+        size_t size = opcode == E220_EMU_CMD_READ ? 3 : 3 + length;
+        if(emu->command_length < size) {
+            return;
+        }
+
+        if(opcode != E220_EMU_CMD_READ) {
+            memcpy(&emu->working[address], &emu->command[3], length);
+            if(opcode == E220_EMU_CMD_WRITE) {
+                memcpy(&emu->saved[address], &emu->command[3], length);
+            }
+        }
+
+        // Every register command is answered C1 <address> <length> <registers>
+        uint8_t reply[E220_EMU_MAX_COMMAND] = {E220_EMU_CMD_READ, address, length};
+        memcpy(&reply[3], &emu->working[address], length);
+        // The key is write-only, it reads and echoes back as zeros
+        for(uint8_t reg = address; reg < address + length; reg++) {
+            if(reg == LoraRegCryptH || reg == LoraRegCryptL) {
+                reply[3 + reg - address] = 0;
+            }
+        }
+        if(emu->corrupt_reply) {
+            emu->corrupt_reply = false;
+            reply[3] ^= 0xFF;
+        }
+        e220_emu_output(emu, reply, 3 + length, E220_EMU_TURNAROUND_US);
+        emu->stats.commands++;
+
+        emu->command_length -= size;
+        memmove(emu->command, &emu->command[size], emu->command_length);
+    }
+}
+
+static void e220_emu_air_event(void* context) {
+    E220Emu* emu = ((E220EmuTimer*)context)->emu;
+    emu->stats.packets_sent++;
+    emu->transmitting = false;
+    e220_emu_update_aux(emu);
+    if(emu->air_callback) {
+        emu->air_callback(
+            emu->air_address, emu->air_channel, emu->air, emu->air_length, emu->air_context);
+    }
+}
+
+/** The host went quiet, send what it wrote or answer an RSSI command */
+static void e220_emu_tx_event(void* context) {
+    E220Emu* emu = ((E220EmuTimer*)context)->emu;
+    const uint8_t* data = emu->tx;
+    size_t length = emu->tx_length;
+    emu->tx_length = 0;
+
+    if((emu->working[LoraReg1] & LORA_CONFIG_REG1_RSSI_AMBIENT) && length == 6 &&
+       memcmp(data, e220_emu_rssi_command, sizeof(e220_emu_rssi_command)) == 0) {
+        uint8_t address = data[4];
+        uint8_t count = data[5];
+        if(address + count <= 2) {
+            uint8_t values[2] = {emu->rssi_ambient, emu->rssi_last};
+            uint8_t reply[5] = {E220_EMU_CMD_READ, address, count};
+            memcpy(&reply[3], &values[address], count);
+            e220_emu_output(emu, reply, 3 + count, E220_EMU_TURNAROUND_US);
+            emu->stats.rssi_replies++;
+            return;
+        }
+    }
+
+    emu->air_address = e220_emu_address(emu);
+    emu->air_channel = emu->working[LoraReg2];
+    if(emu->working[LoraReg3] & E220_EMU_REG3_FIXED) {
+        // Fixed transmission: the first three bytes are where to, not payload
+        if(length < 3) {
+            return;
+        }
+        emu->air_address = (data[0] << 8) | data[1];
+        emu->air_channel = data[2];
+        data += 3;
+        length -= 3;
+    }
+
+    memcpy(emu->air, data, length);
+    emu->air_length = length;
+    emu->transmitting = true;
+    e220_emu_update_aux(emu);
+    furi_shim_schedule_us(e220_emu_airtime_us(emu, length), e220_emu_air_event, &emu->air_timer);
+}
+
+static void
+    e220_emu_host_tx(const uint8_t* data, size_t length, uint32_t baud_rate, void* context) {
+    E220Emu* emu = context;
+
+    if(baud_rate != emu->baud_rate) {
+        emu->stats.wrong_baud_bytes += length;
+        return;
+    }
+    if(emu->switching || emu->mode == E220EmuModeWorReceive) {
+        emu->stats.ignored_bytes += length;
+        return;
+    }
+
+    if(emu->mode == E220EmuModeConfig) {
+        for(size_t i = 0; i < length; i++) {
+            if(emu->command_length == sizeof(emu->command)) {
+                e220_emu_reply_error(emu);
+            }
+            emu->command[emu->command_length++] = data[i];
+        }
+        e220_emu_config_commands(emu);
+        return;
+    }
+
+    size_t space = sizeof(emu->tx) - emu->tx_length;
+    if(emu->transmitting || length > space) {
+        emu->stats.ignored_bytes += length;
+        return;
+    }
+    memcpy(&emu->tx[emu->tx_length], data, length);
+    emu->tx_length += length;
+    furi_shim_cancel(&emu->tx_timer);
+    furi_shim_schedule_us(
+        e220_emu_byte_us(emu, E220_EMU_TX_IDLE_BYTES), e220_emu_tx_event, &emu->tx_timer);
+}
+
+static void e220_emu_mode_event(void* context) {
+    E220Emu* emu = ((E220EmuTimer*)context)->emu;
+    emu->switching = false;
+    e220_emu_update_aux(emu);
+}
+
+/** Drop AUX and raise it again once the module is ready, restarting any switch in progress */
+static void e220_emu_busy_for(E220Emu* emu, uint64_t us) {
+    emu->switching = true;
+    e220_emu_update_aux(emu);
+    furi_shim_cancel(&emu->mode_timer);
+    furi_shim_schedule_us(us, e220_emu_mode_event, &emu->mode_timer);
+}
+
+static void e220_emu_pin_written(uint8_t pin, bool level, void* context) {
+    E220Emu* emu = context;
+    E220EmuMode mode = emu->mode;
+
+    if(pin == E220_EMU_PIN_M0) {
+        mode = level ? (mode | 1) : (mode & ~1);
+    } else if(pin == E220_EMU_PIN_M1) {
+        mode = level ? (mode | 2) : (mode & ~2);
+    }
+    if(mode == emu->mode) {
+        return;
+    }
+
+    emu->mode = mode;
+    emu->stats.mode_changes++;
+    emu->command_length = 0;
+    emu->tx_length = 0;
+    furi_shim_cancel(&emu->tx_timer);
+    e220_emu_busy_for(emu, emu->mode_switch_us);
+}
+
+E220Emu* e220_emu_alloc(void) {
+    static const uint8_t defaults[LORA_CONFIG_REG_COUNT] = E220_EMU_DEFAULT_REGISTERS;
+    E220Emu* emu = malloc(sizeof(E220Emu));
+    memset(emu, 0, sizeof(E220Emu));
+
+    emu->mode_timer.emu = emu;
+    emu->out_timer.emu = emu;
+    emu->idle_timer.emu = emu;
+    emu->tx_timer.emu = emu;
+    emu->air_timer.emu = emu;
+    emu->mode_switch_us = E220_EMU_MODE_SWITCH_US;
+    e220_emu_set_registers(emu, defaults);
+
+    furi_shim_gpio_set_observer(e220_emu_pin_written, emu);
+    furi_shim_serial_set_peer(e220_emu_host_tx, emu);
+    e220_emu_update_aux(emu);
+    return emu;
+}
+
+void e220_emu_free(E220Emu* emu) {
+    furi_shim_gpio_set_observer(NULL, NULL);
+    furi_shim_serial_set_peer(NULL, NULL);
+    furi_shim_cancel(&emu->mode_timer);
+    furi_shim_cancel(&emu->out_timer);
+    furi_shim_cancel(&emu->idle_timer);
+    furi_shim_cancel(&emu->tx_timer);
+    furi_shim_cancel(&emu->air_timer);
+    free(emu->out);
+    free(emu);
+}
+
+void e220_emu_set_registers(E220Emu* emu, const uint8_t* registers) {
+    memcpy(emu->saved, registers, LORA_CONFIG_REG_COUNT);
+    memcpy(emu->working, registers, LORA_CONFIG_REG_COUNT);
+    emu->baud_rate = e220_emu_reg_baud_rate(registers);
+}
+
+void e220_emu_get_registers(E220Emu* emu, uint8_t* registers, bool saved) {
+    memcpy(registers, saved ? emu->saved : emu->working, LORA_CONFIG_REG_COUNT);
+}
+
+void e220_emu_power_cycle(E220Emu* emu) {
+    furi_shim_cancel(&emu->out_timer);
+    furi_shim_cancel(&emu->idle_timer);
+    furi_shim_cancel(&emu->tx_timer);
+    furi_shim_cancel(&emu->air_timer);
+    emu->outputting = false;
+    emu->transmitting = false;
+    emu->out_length = 0;
+    emu->out_position = 0;
+    emu->command_length = 0;
+    emu->tx_length = 0;
+
+    memcpy(emu->working, emu->saved, LORA_CONFIG_REG_COUNT);
+    emu->baud_rate = e220_emu_reg_baud_rate(emu->working);
+    e220_emu_busy_for(emu, emu->mode_switch_us);
+}
+
+void e220_emu_set_mode_switch_us(E220Emu* emu, uint32_t us) {
+    emu->mode_switch_us = us;
+}
+
+void e220_emu_set_rssi(E220Emu* emu, uint8_t ambient, uint8_t last) {
+    emu->rssi_ambient = ambient;
+    emu->rssi_last = last;
+}
+
+void e220_emu_corrupt_next_reply(E220Emu* emu) {
+    emu->corrupt_reply = true;
+}
+
+void e220_emu_set_air_callback(E220Emu* emu, E220EmuAirCallback callback, void* context) {
+    emu->air_callback = callback;
+    emu->air_context = context;
+}
+
+E220EmuMode e220_emu_get_mode(E220Emu* emu) {
+    return emu->mode;
+}
+
+uint32_t e220_emu_get_baud_rate(E220Emu* emu) {
+    return emu->baud_rate;
+}
+
+bool e220_emu_air_receive(
+    E220Emu* emu,
+    uint16_t address,
+    uint8_t channel,
+    const uint8_t* data,
+    size_t length,
+    uint8_t rssi) {
+    LoRaConfig config;
+    lora_config_decode(emu->working, &config);
+    furi_check(length <= config.subpacket_size);
+
+    bool listening = emu->mode == E220EmuModeNormal || emu->mode == E220EmuModeWorReceive;
+    if(!listening || emu->switching || channel != emu->working[LoraReg2] ||
+       (address != e220_emu_address(emu) && address != 0xFFFF)) {
+        emu->stats.packets_filtered++;
+        return false;
+    }
+
+    emu->rssi_last = rssi;
+    emu->stats.packets_received++;
+    e220_emu_output(emu, data, length, E220_EMU_TURNAROUND_US);
+    if(emu->working[LoraReg3] & E220_EMU_REG3_RSSI_BYTE) {
+        e220_emu_output(emu, &rssi, 1, E220_EMU_TURNAROUND_US);
+    }
+    return true;
+}
+
+void e220_emu_inject_burst(E220Emu* emu, const uint8_t* data, size_t length) {
+    e220_emu_output(emu, data, length, 0);
+}
+
+bool e220_emu_is_outputting(E220Emu* emu) {
+    return emu->outputting;
+}
+
+const E220EmuStats* e220_emu_get_stats(E220Emu* emu) {
+    return &emu->stats;
+}
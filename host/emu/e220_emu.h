@@ -0,0 +1,109 @@
+#pragma once
+
+/* Simulated E220 module on the far end of the host furi shim's USART and
+ * M0/M1/AUX pins. Everything happens on the shim's virtual clock, so a
+ * test sees the module's real UART and air timing without waiting for it. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Registers the module comes up with: 9600 baud, SF9 125 kHz, channel 0 */
+#define E220_EMU_DEFAULT_REGISTERS {0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00}
+
+/** Pin level to mode, M0 is bit 0 and M1 bit 1, as set by lora_tester_set_mode */
+typedef enum {
+    E220EmuModeNormal,
+    E220EmuModeWorTransmit,
+    E220EmuModeWorReceive,
+    E220EmuModeConfig,
+} E220EmuMode;
+
+typedef struct {
+    /** Register commands answered with C1, and commands answered FF FF FF */
+    uint32_t commands;
+    uint32_t bad_commands;
+    /** Host bytes lost to a UART rate the module isn't using */
+    uint32_t wrong_baud_bytes;
+    /** Host bytes that arrived while switching mode or in WOR receive */
+    uint32_t ignored_bytes;
+    uint32_t mode_changes;
+    uint32_t rssi_replies;
+    uint32_t packets_sent;
+    uint32_t packets_received;
+    /** Air packets for another address or channel */
+    uint32_t packets_filtered;
+    /** Bytes the module wrote to the host */
+    uint32_t uart_bytes;
+} E220EmuStats;
+
+/** A packet leaving the antenna, address and channel are where it was sent to */
+typedef void (*E220EmuAirCallback)(
+    uint16_t address,
+    uint8_t channel,
+    const uint8_t* data,
+    size_t length,
+    void* context);
+
+typedef struct E220Emu E220Emu;
+
+/** Connect a module to the shim, only one can exist at a time */
+E220Emu* e220_emu_alloc(void);
+
+void e220_emu_free(E220Emu* emu);
+
+/** Set both the saved and working registers, as if written with C0 */
+void e220_emu_set_registers(E220Emu* emu, const uint8_t* registers);
+
+/** Copy the working registers, or the saved ones a power cycle comes back with */
+void e220_emu_get_registers(E220Emu* emu, uint8_t* registers, bool saved);
+
+/** Lose C2 writes and anything in flight, AUX stays low while the module boots */
+void e220_emu_power_cycle(E220Emu* emu);
+
+/** Time from an M0/M1 change to AUX rising again */
+void e220_emu_set_mode_switch_us(E220Emu* emu, uint32_t us);
+
+/** Register values reported by the RSSI command */
+void e220_emu_set_rssi(E220Emu* emu, uint8_t ambient, uint8_t last);
+
+/** Invert the first data byte of the next register reply, as line noise would */
+void e220_emu_corrupt_next_reply(E220Emu* emu);
+
+void e220_emu_set_air_callback(E220Emu* emu, E220EmuAirCallback callback, void* context);
+
+E220EmuMode e220_emu_get_mode(E220Emu* emu);
+
+/** Rate the module's UART runs at, from REG0 */
+uint32_t e220_emu_get_baud_rate(E220Emu* emu);
+
+/** Receive a packet over the air, written to the host if address and channel match
+ *
+ * @param      length  at most the subpacket size, a sender splits longer data
+ * @param      rssi    RSSI register value, appended when REG3 enables the RSSI byte
+ *
+ * @return     false if the packet was filtered out
+ */
+bool e220_emu_air_receive(
+    E220Emu* emu,
+    uint16_t address,
+    uint8_t channel,
+    const uint8_t* data,
+    size_t length,
+    uint8_t rssi);
+
+/** Write raw bytes to the host back to back at the UART rate, then go idle */
+void e220_emu_inject_burst(E220Emu* emu, const uint8_t* data, size_t length);
+
+/** The module is still writing to the host */
+bool e220_emu_is_outputting(E220Emu* emu);
+
+const E220EmuStats* e220_emu_get_stats(E220Emu* emu);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+/* Host stand-in for the SDK header, only what the app's pure sources use */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef UNUSED
+#define UNUSED(x) (void)(x)
+#endif
+
+#ifndef COUNT_OF
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#endif
+
+typedef struct FuriString FuriString;
@@ -0,0 +1,82 @@
+#pragma once
+
+/* Host stand-in for <furi.h>: asserts, logging, records, FuriString and the
+ * kernel objects the app's drivers use, all running on a virtual clock */
+
+#include <core/common_defines.h>
+#include <assert.h>
+#include <stdio.h>
+
+#define furi_assert(x) assert(x)
+#define furi_check(x) assert(x)
+
+#define FURI_LOG_E(tag, ...) furi_shim_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) furi_shim_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) furi_shim_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) furi_shim_log('D', tag, __VA_ARGS__)
+
+void furi_shim_log(char level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/* There are no interrupts to mask, device callbacks run from the scheduler */
+#define FURI_CRITICAL_ENTER() \
+    do {                      \
+    } while(0)
+#define FURI_CRITICAL_EXIT() \
+    do {                     \
+    } while(0)
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+} FuriStatus;
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+/** Milliseconds of virtual time, see furi_shim_advance_us */
+uint32_t furi_get_tick(void);
+uint32_t furi_kernel_get_tick_frequency(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+/** Runs whatever the scheduler has due in the next milliseconds */
+void furi_delay_ms(uint32_t milliseconds);
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+typedef struct FuriSemaphore FuriSemaphore;
+typedef struct FuriMutex FuriMutex;
+
+/* Waiting runs scheduled events until the object is available or the
+ * timeout has passed in virtual time, a timeout never sleeps for real */
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count);
+void furi_semaphore_free(FuriSemaphore* semaphore);
+FuriStatus furi_semaphore_acquire(FuriSemaphore* semaphore, uint32_t timeout);
+FuriStatus furi_semaphore_release(FuriSemaphore* semaphore);
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_printf(const char* format, ...)
+    __attribute__((format(printf, 1, 2)));
+void furi_string_free(FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_set_str(FuriString* string, const char* cstr);
+void furi_string_cat_str(FuriString* string, const char* cstr);
+int furi_string_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+int furi_string_cat_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+
+#include "furi_shim.h"
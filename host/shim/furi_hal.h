@@ -0,0 +1,53 @@
+#pragma once
+
+/* Host stand-in for <furi_hal.h>: GPIO, the serial port and the cycle counter */
+
+#include <furi.h>
+#include <furi_hal_serial.h>
+
+typedef struct {
+    uint8_t index;
+} GpioPin;
+
+extern const GpioPin gpio_ext_pa4;
+extern const GpioPin gpio_ext_pa6;
+extern const GpioPin gpio_ext_pa7;
+
+typedef enum {
+    GpioModeInput,
+    GpioModeOutputPushPull,
+    GpioModeInterruptRiseFall,
+    GpioModeAnalog,
+} GpioMode;
+
+typedef enum {
+    GpioPullNo,
+    GpioPullUp,
+    GpioPullDown,
+} GpioPull;
+
+typedef enum {
+    GpioSpeedLow,
+    GpioSpeedVeryHigh,
+} GpioSpeed;
+
+typedef void (*GpioExtiCallback)(void* context);
+
+void furi_hal_gpio_init(const GpioPin* pin, GpioMode mode, GpioPull pull, GpioSpeed speed);
+void furi_hal_gpio_init_simple(const GpioPin* pin, GpioMode mode);
+void furi_hal_gpio_write(const GpioPin* pin, bool level);
+bool furi_hal_gpio_read(const GpioPin* pin);
+void furi_hal_gpio_add_int_callback(const GpioPin* pin, GpioExtiCallback callback, void* context);
+void furi_hal_gpio_remove_int_callback(const GpioPin* pin);
+void furi_hal_gpio_enable_int_callback(const GpioPin* pin);
+void furi_hal_gpio_disable_int_callback(const GpioPin* pin);
+
+/** Cycles of the 64 MHz core, CYCCNT follows the virtual clock */
+typedef struct {
+    uint32_t CYCCNT;
+} FuriShimDwt;
+
+FuriShimDwt* furi_shim_dwt(void);
+#define DWT (furi_shim_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
@@ -0,0 +1,43 @@
+#pragma once
+
+/* Host stand-in for the serial HAL, one USART whose far end is the peer set
+ * with furi_shim_serial_set_peer */
+
+#include <furi.h>
+
+typedef enum {
+    FuriHalSerialIdUsart,
+    FuriHalSerialIdLpuart,
+} FuriHalSerialId;
+
+typedef struct FuriHalSerialHandle FuriHalSerialHandle;
+
+typedef enum {
+    FuriHalSerialRxEventData = (1 << 0),
+    FuriHalSerialRxEventIdle = (1 << 1),
+    FuriHalSerialRxEventFrameError = (1 << 2),
+    FuriHalSerialRxEventNoiseError = (1 << 3),
+    FuriHalSerialRxEventOverrunError = (1 << 4),
+} FuriHalSerialRxEvent;
+
+typedef void (*FuriHalSerialAsyncRxCallback)(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    void* context);
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id);
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle);
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud);
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle);
+void furi_hal_serial_set_br(FuriHalSerialHandle* handle, uint32_t baud);
+/** Takes the bytes' time on the wire at the set rate, then hands them to the peer */
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size);
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle);
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors);
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle);
+bool furi_hal_serial_async_rx_available(FuriHalSerialHandle* handle);
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle);
@@ -0,0 +1,217 @@
+#include <furi.h>
+#include <furi_hal.h>
+#include <furi_hal_serial.h>
+
+#define FURI_SHIM_GPIO_COUNT 16
+/** Deep enough for any chunk the emulator delivers between two ISR runs */
+#define FURI_SHIM_SERIAL_FIFO_SIZE 512
+
+const GpioPin gpio_ext_pa4 = {.index = 4};
+const GpioPin gpio_ext_pa6 = {.index = 6};
+const GpioPin gpio_ext_pa7 = {.index = 7};
+
+typedef struct {
+    bool level;
+    GpioExtiCallback callback;
+    void* context;
+    bool enabled;
+} FuriShimGpio;
+
+struct FuriHalSerialHandle {
+    bool acquired;
+    bool initialised;
+    uint32_t baud_rate;
+    FuriHalSerialAsyncRxCallback callback;
+    void* context;
+    uint8_t fifo[FURI_SHIM_SERIAL_FIFO_SIZE];
+    size_t head;
+    size_t tail;
+};
+
+static FuriShimGpio furi_shim_gpio[FURI_SHIM_GPIO_COUNT];
+static FuriShimGpioObserver furi_shim_gpio_observer;
+static void* furi_shim_gpio_observer_context;
+
+static FuriHalSerialHandle furi_shim_serial;
+static FuriShimSerialPeer furi_shim_serial_peer;
+static void* furi_shim_serial_peer_context;
+static uint32_t furi_shim_serial_framing_errors;
+
+static FuriShimDwt furi_shim_dwt_registers;
+
+void furi_hal_gpio_init(const GpioPin* pin, GpioMode mode, GpioPull pull, GpioSpeed speed) {
+    UNUSED(pull);
+    UNUSED(speed);
+    furi_hal_gpio_init_simple(pin, mode);
+}
+
+void furi_hal_gpio_init_simple(const GpioPin* pin, GpioMode mode) {
+    UNUSED(pin);
+    UNUSED(mode);
+}
+
+void furi_hal_gpio_write(const GpioPin* pin, bool level) {
+    furi_shim_gpio[pin->index].level = level;
+    if(furi_shim_gpio_observer) {
+        furi_shim_gpio_observer(pin->index, level, furi_shim_gpio_observer_context);
+    }
+}
+
+bool furi_hal_gpio_read(const GpioPin* pin) {
+    return furi_shim_gpio[pin->index].level;
+}
+
+void furi_hal_gpio_add_int_callback(const GpioPin* pin, GpioExtiCallback callback, void* context) {
+    FuriShimGpio* gpio = &furi_shim_gpio[pin->index];
+    gpio->callback = callback;
+    gpio->context = context;
+    gpio->enabled = true;
+}
+
+void furi_hal_gpio_remove_int_callback(const GpioPin* pin) {
+    FuriShimGpio* gpio = &furi_shim_gpio[pin->index];
+    gpio->callback = NULL;
+    gpio->context = NULL;
+    gpio->enabled = false;
+}
+
+void furi_hal_gpio_enable_int_callback(const GpioPin* pin) {
+    furi_shim_gpio[pin->index].enabled = true;
+}
+
+void furi_hal_gpio_disable_int_callback(const GpioPin* pin) {
+    furi_shim_gpio[pin->index].enabled = false;
+}
+
+void furi_shim_gpio_set_observer(FuriShimGpioObserver observer, void* context) {
+    furi_shim_gpio_observer = observer;
+    furi_shim_gpio_observer_context = context;
+}
+
+void furi_shim_gpio_drive(uint8_t pin, bool level) {
+    FuriShimGpio* gpio = &furi_shim_gpio[pin];
+    if(gpio->level == level) {
+        return;
+    }
+    gpio->level = level;
+    if(gpio->enabled && gpio->callback) {
+        gpio->callback(gpio->context);
+    }
+}
+
+FuriShimDwt* furi_shim_dwt(void) {
+    furi_shim_dwt_registers.CYCCNT =
+        furi_shim_now_us() * furi_hal_cortex_instructions_per_microsecond();
+    return &furi_shim_dwt_registers;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id) {
+    if(serial_id != FuriHalSerialIdUsart || furi_shim_serial.acquired) {
+        return NULL;
+    }
+    furi_shim_serial.acquired = true;
+    return &furi_shim_serial;
+}
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle) {
+    assert(handle->acquired && !handle->initialised);
+    handle->acquired = false;
+}
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud) {
+    assert(handle->acquired);
+    handle->initialised = true;
+    handle->baud_rate = baud;
+    handle->head = handle->tail = 0;
+}
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle) {
+    assert(!handle->callback);
+    handle->initialised = false;
+}
+
+void furi_hal_serial_set_br(FuriHalSerialHandle* handle, uint32_t baud) {
+    assert(handle->initialised);
+    handle->baud_rate = baud;
+}
+
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size) {
+    assert(handle->initialised);
+    // 8N1, ten bits a byte
+    furi_shim_advance_us((uint64_t)buffer_size * 10 * 1000000 / handle->baud_rate);
+    if(furi_shim_serial_peer) {
+        furi_shim_serial_peer(
+            buffer, buffer_size, handle->baud_rate, furi_shim_serial_peer_context);
+    }
+}
+
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors) {
+    UNUSED(report_errors);
+    assert(handle->initialised);
+    handle->callback = callback;
+    handle->context = context;
+}
+
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle) {
+    handle->callback = NULL;
+    handle->context = NULL;
+}
+
+bool furi_hal_serial_async_rx_available(FuriHalSerialHandle* handle) {
+    return handle->head != handle->tail;
+}
+
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle) {
+    assert(handle->head != handle->tail);
+    uint8_t byte = handle->fifo[handle->tail];
+    handle->tail = (handle->tail + 1) % FURI_SHIM_SERIAL_FIFO_SIZE;
+    return byte;
+}
+
+void furi_shim_serial_set_peer(FuriShimSerialPeer peer, void* context) {
+    furi_shim_serial_peer = peer;
+    furi_shim_serial_peer_context = context;
+}
+
+void furi_shim_serial_receive(const uint8_t* data, size_t length, uint32_t baud_rate) {
+    FuriHalSerialHandle* handle = &furi_shim_serial;
+    if(!handle->callback) {
+        return;
+    }
+    // A wrong rate is framing errors and garbage on hardware, here the bytes are just lost
+    if(baud_rate != handle->baud_rate) {
+        furi_shim_serial_framing_errors += length;
+        return;
+    }
+
+    for(size_t i = 0; i < length; i++) {
+        size_t next = (handle->head + 1) % FURI_SHIM_SERIAL_FIFO_SIZE;
+        assert(next != handle->tail);
+        handle->fifo[handle->head] = data[i];
+        handle->head = next;
+    }
+    handle->callback(handle, FuriHalSerialRxEventData, handle->context);
+}
+
+void furi_shim_serial_idle(void) {
+    FuriHalSerialHandle* handle = &furi_shim_serial;
+    if(handle->callback) {
+        handle->callback(handle, FuriHalSerialRxEventIdle, handle->context);
+    }
+}
+
+uint32_t furi_shim_serial_get_framing_errors(void) {
+    return furi_shim_serial_framing_errors;
+}
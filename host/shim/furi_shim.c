@@ -0,0 +1,328 @@
+#include <furi.h>
+#include <storage/storage.h>
+#include <stdarg.h>
+
+#define FURI_SHIM_MAX_FILES 16
+#define FURI_SHIM_MAX_EVENTS 32
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+typedef struct {
+    uint64_t at_us;
+    /** Breaks ties so events due together run in the order they were scheduled */
+    uint64_t sequence;
+    FuriShimEvent event;
+    void* context;
+} FuriShimScheduled;
+
+struct FuriSemaphore {
+    uint32_t count;
+    uint32_t max_count;
+};
+
+struct FuriMutex {
+    bool locked;
+};
+
+static uint64_t furi_shim_now;
+static uint64_t furi_shim_sequence;
+static FuriShimScheduled furi_shim_events[FURI_SHIM_MAX_EVENTS];
+static size_t furi_shim_event_count;
+static bool furi_shim_verbose;
+static char* furi_shim_files[FURI_SHIM_MAX_FILES];
+static size_t furi_shim_file_count;
+
+void furi_shim_set_tick(uint32_t tick) {
+    assert(furi_shim_event_count == 0);
+    furi_shim_now = (uint64_t)tick * 1000;
+}
+
+uint64_t furi_shim_now_us(void) {
+    return furi_shim_now;
+}
+
+void furi_shim_schedule_us(uint64_t delay_us, FuriShimEvent event, void* context) {
+    assert(furi_shim_event_count < FURI_SHIM_MAX_EVENTS);
+    furi_shim_events[furi_shim_event_count++] = (FuriShimScheduled){
+        .at_us = furi_shim_now + delay_us,
+        .sequence = furi_shim_sequence++,
+        .event = event,
+        .context = context,
+    };
+}
+
+void furi_shim_cancel(void* context) {
+    size_t kept = 0;
+    for(size_t i = 0; i < furi_shim_event_count; i++) {
+        if(furi_shim_events[i].context != context) {
+            furi_shim_events[kept++] = furi_shim_events[i];
+        }
+    }
+    furi_shim_event_count = kept;
+}
+
+bool furi_shim_run_next(uint64_t deadline_us) {
+    // A handful of events are pending at most, a linear scan beats keeping a heap
+    size_t next = furi_shim_event_count;
+    for(size_t i = 0; i < furi_shim_event_count; i++) {
+        const FuriShimScheduled* event = &furi_shim_events[i];
+        if(next == furi_shim_event_count || event->at_us < furi_shim_events[next].at_us ||
+           (event->at_us == furi_shim_events[next].at_us &&
+            event->sequence < furi_shim_events[next].sequence)) {
+            next = i;
+        }
+    }
+    if(next == furi_shim_event_count || furi_shim_events[next].at_us > deadline_us) {
+        return false;
+    }
+
+    FuriShimScheduled event = furi_shim_events[next];
+    furi_shim_events[next] = furi_shim_events[--furi_shim_event_count];
+    if(event.at_us > furi_shim_now) {
+        furi_shim_now = event.at_us;
+    }
+    event.event(event.context);
+    return true;
+}
+
+void furi_shim_advance_us(uint64_t us) {
+    uint64_t deadline = furi_shim_now + us;
+    while(furi_shim_run_next(deadline)) {
+    }
+    furi_shim_now = deadline;
+}
+
+void furi_shim_reset(void) {
+    furi_shim_event_count = 0;
+    furi_shim_now = 0;
+}
+
+/** Run events until *count is non-zero, false if timeout ms pass first */
+static bool furi_shim_wait(const volatile uint32_t* count, uint32_t timeout) {
+    uint64_t deadline =
+        timeout == FuriWaitForever ? UINT64_MAX : furi_shim_now + (uint64_t)timeout * 1000;
+    while(!*count) {
+        if(!furi_shim_run_next(deadline)) {
+            // Nothing can ever release it when waiting forever with nothing scheduled
+            assert(timeout != FuriWaitForever);
+            furi_shim_now = deadline;
+            return false;
+        }
+    }
+    return true;
+}
+void furi_shim_set_verbose(bool verbose) {
+    furi_shim_verbose = verbose;
+}
+
+void furi_shim_log(char level, const char* tag, const char* format, ...) {
+    if(!furi_shim_verbose) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void* furi_record_open(const char* name) {
+    // Records are opaque to the code under test, any non-NULL pointer will do
+    return (void*)name;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+uint32_t furi_get_tick(void) {
+    return furi_shim_now / 1000;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    furi_shim_advance_us((uint64_t)milliseconds * 1000);
+}
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count) {
+    FuriSemaphore* semaphore = malloc(sizeof(FuriSemaphore));
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    return semaphore;
+}
+
+void furi_semaphore_free(FuriSemaphore* semaphore) {
+    free(semaphore);
+}
+
+FuriStatus furi_semaphore_acquire(FuriSemaphore* semaphore, uint32_t timeout) {
+    if(!furi_shim_wait(&semaphore->count, timeout)) {
+        return timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+    }
+    semaphore->count--;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_semaphore_release(FuriSemaphore* semaphore) {
+    if(semaphore->count == semaphore->max_count) {
+        return FuriStatusErrorResource;
+    }
+    semaphore->count++;
+    return FuriStatusOk;
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    UNUSED(type);
+    FuriMutex* mutex = malloc(sizeof(FuriMutex));
+    mutex->locked = false;
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    assert(!mutex->locked);
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    // There is one thread, so a held mutex is only ever freed by a scheduled event
+    uint64_t deadline =
+        timeout == FuriWaitForever ? UINT64_MAX : furi_shim_now + (uint64_t)timeout * 1000;
+    while(mutex->locked) {
+        if(!furi_shim_run_next(deadline)) {
+            assert(timeout != FuriWaitForever);
+            furi_shim_now = deadline;
+            return FuriStatusErrorTimeout;
+        }
+    }
+    mutex->locked = true;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    assert(mutex->locked);
+    mutex->locked = false;
+    return FuriStatusOk;
+}
+
+static void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 > string->capacity) {
+        string->capacity = (size + 1) * 2;
+        string->data = realloc(string->data, string->capacity);
+        assert(string->data);
+    }
+}
+
+static int furi_string_vcat(FuriString* string, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+
+    furi_string_reserve(string, string->size + length);
+    vsnprintf(string->data + string->size, length + 1, format, args);
+    string->size += length;
+    return length;
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    string->data = NULL;
+    string->size = 0;
+    string->capacity = 0;
+    furi_string_reserve(string, 0);
+    string->data[0] = '\0';
+    return string;
+}
+
+FuriString* furi_string_alloc_printf(const char* format, ...) {
+    FuriString* string = furi_string_alloc();
+    va_list args;
+    va_start(args, format);
+    furi_string_vcat(string, format, args);
+    va_end(args);
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    furi_string_reset(string);
+    furi_string_cat_str(string, cstr);
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr) {
+    size_t length = strlen(cstr);
+    furi_string_reserve(string, string->size + length);
+    memcpy(string->data + string->size, cstr, length + 1);
+    string->size += length;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    furi_string_reset(string);
+    va_list args;
+    va_start(args, format);
+    int length = furi_string_vcat(string, format, args);
+    va_end(args);
+    return length;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = furi_string_vcat(string, format, args);
+    va_end(args);
+    return length;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+void furi_shim_storage_add(const char* path) {
+    assert(furi_shim_file_count < FURI_SHIM_MAX_FILES);
+    furi_shim_files[furi_shim_file_count++] = strdup(path);
+}
+
+void furi_shim_storage_clear(void) {
+    for(size_t i = 0; i < furi_shim_file_count; i++) {
+        free(furi_shim_files[i]);
+    }
+    furi_shim_file_count = 0;
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    for(size_t i = 0; i < furi_shim_file_count; i++) {
+        if(strcmp(furi_shim_files[i], path) == 0) {
+            if(fileinfo) {
+                fileinfo->size = 0;
+            }
+            return FSE_OK;
+        }
+    }
+    return FSE_NOT_EXIST;
+}
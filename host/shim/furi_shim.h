@@ -0,0 +1,68 @@
+#pragma once
+
+/* Controls for the host furi shim, used by tests, benchmarks and the emulator */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Set what furi_get_tick returns, the scheduler must be idle */
+void furi_shim_set_tick(uint32_t tick);
+
+/** Print FURI_LOG output to stderr, off by default to keep test output short */
+void furi_shim_set_verbose(bool verbose);
+
+/** Make storage_common_stat report path as existing */
+void furi_shim_storage_add(const char* path);
+
+/** Forget every path added with furi_shim_storage_add */
+void furi_shim_storage_clear(void);
+
+/* Virtual time. Device behaviour (a module answering, AUX rising) is
+ * scheduled as events and runs when the code under test waits or when
+ * time is advanced explicitly. */
+
+typedef void (*FuriShimEvent)(void* context);
+
+uint64_t furi_shim_now_us(void);
+
+/** Run event at delay_us from now, events due at the same time run in order */
+void furi_shim_schedule_us(uint64_t delay_us, FuriShimEvent event, void* context);
+
+/** Drop every pending event for context */
+void furi_shim_cancel(void* context);
+
+/** Run events due within us and move the clock on by us */
+void furi_shim_advance_us(uint64_t us);
+
+/** Run the next event due by deadline_us, false if there is none */
+bool furi_shim_run_next(uint64_t deadline_us);
+
+/** Drop all events and return the clock to 0 */
+void furi_shim_reset(void);
+
+/** Told of every furi_hal_gpio_write */
+typedef void (*FuriShimGpioObserver)(uint8_t pin, bool level, void* context);
+
+void furi_shim_gpio_set_observer(FuriShimGpioObserver observer, void* context);
+
+/** Drive an input pin from outside, firing its interrupt on a change */
+void furi_shim_gpio_drive(uint8_t pin, bool level);
+
+/** Gets what the app writes to the serial port, with the rate it was sent at */
+typedef void (*FuriShimSerialPeer)(
+    const uint8_t* data,
+    size_t length,
+    uint32_t baud_rate,
+    void* context);
+
+void furi_shim_serial_set_peer(FuriShimSerialPeer peer, void* context);
+
+/** Bytes arriving from the peer sent at baud_rate, lost unless it matches the port */
+void furi_shim_serial_receive(const uint8_t* data, size_t length, uint32_t baud_rate);
+
+/** The line went idle after the last byte from the peer */
+void furi_shim_serial_idle(void);
+
+/** Bytes dropped because the peer's rate didn't match the port */
+uint32_t furi_shim_serial_get_framing_errors(void);
@@ -0,0 +1,22 @@
+#pragma once
+
+/* Host stand-in for <storage/storage.h>, backed by the fake file list in furi_shim.c */
+
+#include <furi.h>
+
+#define RECORD_STORAGE "storage"
+
+typedef struct Storage Storage;
+
+typedef enum {
+    FSE_OK,
+    FSE_NOT_READY,
+    FSE_EXIST,
+    FSE_NOT_EXIST,
+} FS_Error;
+
+typedef struct {
+    uint64_t size;
+} FileInfo;
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo);
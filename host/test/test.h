@@ -0,0 +1,51 @@
+#pragma once
+
+/* Minimal test harness. Each test file builds to one executable whose main()
+ * runs its cases and returns the number of failed checks. */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef COUNT_OF
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#endif
+
+static int test_failures;
+
+static inline void test_fail(const char* file, int line, const char* message) {
+    fprintf(stderr, "%s:%d: %s\n", file, line, message);
+    test_failures++;
+}
+
+static inline void
+    test_check_eq(const char* file, int line, const char* what, long long a, long long e) {
+    if(a != e) {
+        fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", file, line, what, a, e);
+        test_failures++;
+    }
+}
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if(!(cond)) test_fail(__FILE__, __LINE__, "failed: " #cond); \
+    } while(0)
+
+#define CHECK_EQ(actual, expected) \
+    test_check_eq(__FILE__, __LINE__, #actual, (long long)(actual), (long long)(expected))
+
+#define CHECK_MEM(actual, expected, size)                                      \
+    do {                                                                       \
+        if(memcmp((actual), (expected), (size)) != 0)                          \
+            test_fail(__FILE__, __LINE__, #actual " differs from " #expected); \
+    } while(0)
+
+#define CHECK_STR(actual, expected)                                            \
+    do {                                                                       \
+        if(strcmp((actual), (expected)) != 0)                                  \
+            test_fail(__FILE__, __LINE__, #actual " differs from " #expected); \
+    } while(0)
+
+static inline int test_result(const char* name) {
+    printf("%-24s %s\n", name, test_failures ? "FAIL" : "ok");
+    return test_failures;
+}
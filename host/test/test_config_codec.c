@@ -0,0 +1,152 @@
+// REG0-REG7 encode/decode, register diffs and channel math
+
+#include "test.h"
+#include "lora_config_binary_convert.h"
+
+/* Every field away from its default: 0x1234, 115200 baud, 250 kHz SF6,
+ * 128 byte sub-packets, ambient RSSI on, 17 dBm, channel 15, RSSI byte on,
+ * fixed transmission, 2000 ms WOR, key 0xABCD */
+static const uint8_t sample_registers[LORA_CONFIG_REG_COUNT] =
+    {0x12, 0x34, 0xE5, 0x61, 0x0F, 0xC3, 0xAB, 0xCD};
+
+static void test_defaults(void) {
+    LoRaConfig config;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    const uint8_t expected[LORA_CONFIG_REG_COUNT] = {0x00, 0x00, 0x68, 0x02, 0, 0, 0, 0};
+
+    lora_config_set_defaults(&config);
+    CHECK_EQ(config.baud_rate, 9600);
+    CHECK_EQ(config.bw, 125);
+    CHECK_EQ(config.sf, 7);
+    CHECK_EQ(config.subpacket_size, 200);
+    CHECK_EQ(config.transmitting_power, 13);
+    CHECK_EQ(config.wor_cycle, 500);
+
+    lora_config_encode(&config, registers);
+    CHECK_MEM(registers, expected, sizeof(expected));
+}
+
+static void test_decode(void) {
+    LoRaConfig config;
+    lora_config_decode(sample_registers, &config);
+
+    CHECK_EQ(config.own_address, 0x1234);
+    CHECK_EQ(config.baud_rate, 115200);
+    CHECK_EQ(config.bw, 250);
+    CHECK_EQ(config.sf, 6);
+    CHECK_EQ(config.subpacket_size, 128);
+    CHECK_EQ(config.rssi_ambient_noise_flag, 1);
+    CHECK_EQ(config.transmitting_power, 17);
+    CHECK_EQ(config.own_channel, 15);
+    CHECK_EQ(config.rssi_byte_flag, 1);
+    CHECK_EQ(config.transmission_method_type, 1);
+    CHECK_EQ(config.wor_cycle, 2000);
+    CHECK_EQ(config.encryption_key, 0xABCD);
+}
+
+static void test_round_trip(void) {
+    LoRaConfig config;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    lora_config_decode(sample_registers, &config);
+    lora_config_encode(&config, registers);
+    CHECK_MEM(registers, sample_registers, sizeof(sample_registers));
+
+    // Every valid air data rate survives the trip through bw/sf
+    for(size_t i = 0; i < lora_air_data_rate_count; i++) {
+        uint8_t image[LORA_CONFIG_REG_COUNT] = {0};
+        image[LoraReg0] = lora_air_data_rates[i].code;
+        lora_config_decode(image, &config);
+        lora_config_encode(&config, registers);
+        CHECK_EQ(registers[LoraReg0] & 0x1F, lora_air_data_rates[i].code);
+    }
+}
+
+static void test_reserved_and_invalid(void) {
+    LoRaConfig config;
+    uint8_t registers[LORA_CONFIG_REG_COUNT] = {0};
+
+    // 0x1F is not a valid air data rate and reads back as SF7 BW125
+    registers[LoraReg0] = 0x1F;
+    lora_config_decode(registers, &config);
+    CHECK_EQ(config.bw, 125);
+    CHECK_EQ(config.sf, 7);
+
+    // Values the module can't take fall back to defaults without touching other fields
+    lora_config_set_defaults(&config);
+    config.transmitting_power = 5;
+    config.rssi_byte_flag = 2;
+    config.bw = 125;
+    config.sf = 11;
+    lora_config_encode(&config, registers);
+    CHECK_EQ(registers[LoraReg0] & 0x1F, 0x08);
+    CHECK_EQ(registers[LoraReg1] & 0x03, 2);
+    CHECK_EQ(registers[LoraReg3], 0);
+
+    CHECK_EQ(lora_air_data_rate_find(500, 11), 17);
+    CHECK_EQ(lora_air_data_rate_find(125, 10), -1);
+    CHECK_EQ(lora_air_data_rate_index(0x1A), 17);
+    CHECK_EQ(lora_air_data_rate_index(0x03), -1);
+}
+
+static void test_diff(void) {
+    LoraRegisterRange ranges[LORA_CONFIG_MAX_RANGES];
+    uint8_t target[LORA_CONFIG_REG_COUNT];
+
+    memcpy(target, sample_registers, sizeof(target));
+    CHECK_EQ(lora_config_diff(sample_registers, target, ranges), 0);
+
+    target[LoraReg2] ^= 0x01;
+    CHECK_EQ(lora_config_diff(sample_registers, target, ranges), 1);
+    CHECK_EQ(ranges[0].address, LoraReg2);
+    CHECK_EQ(ranges[0].length, 1);
+
+    // Three unchanged registers between two changes are cheaper to rewrite
+    target[LoraRegAddH] ^= 0x01;
+    CHECK_EQ(lora_config_diff(sample_registers, target, ranges), 1);
+    CHECK_EQ(ranges[0].address, LoraRegAddH);
+    CHECK_EQ(ranges[0].length, 5);
+
+    // Four are not
+    memcpy(target, sample_registers, sizeof(target));
+    target[LoraRegAddH] ^= 0x01;
+    target[LoraReg3] ^= 0x01;
+    CHECK_EQ(lora_config_diff(sample_registers, target, ranges), 2);
+    CHECK_EQ(ranges[1].address, LoraReg3);
+    CHECK_EQ(ranges[1].length, 1);
+}
+
+static void test_hex_string(void) {
+    LoRaConfig config;
+    char hex[33];
+    char small[32];
+
+    lora_config_set_defaults(&config);
+    CHECK(lora_config_to_hex_string(&config, hex, sizeof(hex)));
+    CHECK_STR(hex, "C0 00 08 00 00 68 02 00 00 00 00");
+    CHECK(!lora_config_to_hex_string(&config, small, sizeof(small)));
+}
+
+static void test_channels(void) {
+    CHECK_EQ(lora_config_max_channel(0), 37);
+    CHECK_EQ(lora_config_max_channel(1), 36);
+    CHECK_EQ(lora_config_max_channel(2), 30);
+    CHECK_EQ(lora_config_max_channel(3), 0);
+
+    CHECK_EQ(lora_config_channel_khz(0, 0), 920600);
+    CHECK_EQ(lora_config_channel_khz(37, 0), 928000);
+    CHECK_EQ(lora_config_channel_khz(30, 2), 926800);
+    CHECK_EQ(lora_config_channel_khz(0, 3), 0);
+    CHECK_EQ(LORA_CONFIG_BW_BITS(0xE5), 1);
+}
+
+int main(void) {
+    test_defaults();
+    test_decode();
+    test_round_trip();
+    test_reserved_and_invalid();
+    test_diff();
+    test_hex_string();
+    test_channels();
+    return test_result("config_codec");
+}
@@ -0,0 +1,131 @@
+// Exported .ini files read back through the codec's line parser
+
+#include "test.h"
+#include "lora_config_binary_convert.h"
+
+static void parse_lines(const char* const* lines, size_t count, LoRaConfig* config) {
+    LoraConfigIniParser parser;
+    lora_config_ini_init(&parser);
+    for(size_t i = 0; i < count; i++) {
+        lora_config_ini_parse_line(&parser, lines[i]);
+    }
+    lora_config_ini_finish(&parser, config);
+}
+
+static void test_current_export(void) {
+    // As written by the export scene, line endings included
+    static const char* const lines[] = {
+        "[E220-900JP]\n",
+        "config_version=2\n",
+        "own_address=4660\n",
+        "baud_rate=115200\n",
+        "bw=250\n",
+        "sf=6\n",
+        "subpacket_size=128\n",
+        "rssi_ambient_noise_flag=1\n",
+        "transmitting_power=17\n",
+        "own_channel=15\n",
+        "rssi_byte_flag=1\n",
+        "transmission_method_type=1\n",
+        "wor_cycle=2000\n",
+        "encryption_key=43981\n",
+    };
+    const uint8_t expected[LORA_CONFIG_REG_COUNT] =
+        {0x12, 0x34, 0xE5, 0x61, 0x0F, 0xC3, 0xAB, 0xCD};
+    LoRaConfig config;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    parse_lines(lines, COUNT_OF(lines), &config);
+    CHECK_EQ(config.transmission_method_type, 1);
+    lora_config_encode(&config, registers);
+    CHECK_MEM(registers, expected, sizeof(expected));
+}
+
+static void test_version_1_migration(void) {
+    static const char* const fixed[] = {"transmission_method_type=2\n"};
+    static const char* const transparent[] = {"transmission_method_type=1\n"};
+    static const char* const current[] = {"config_version=2\n", "transmission_method_type=1\n"};
+    LoRaConfig config;
+
+    parse_lines(fixed, COUNT_OF(fixed), &config);
+    CHECK_EQ(config.transmission_method_type, 1);
+    parse_lines(transparent, COUNT_OF(transparent), &config);
+    CHECK_EQ(config.transmission_method_type, 0);
+    parse_lines(current, COUNT_OF(current), &config);
+    CHECK_EQ(config.transmission_method_type, 1);
+}
+
+static void test_missing_and_unknown(void) {
+    LoraConfigIniParser parser;
+    LoRaConfig defaults;
+    LoRaConfig config;
+
+    lora_config_ini_init(&parser);
+    CHECK(!lora_config_ini_parse_line(&parser, "[E220-900JP]\n"));
+    CHECK(!lora_config_ini_parse_line(&parser, "\n"));
+    CHECK(!lora_config_ini_parse_line(&parser, "frequency=920\n"));
+    CHECK(!lora_config_ini_parse_line(&parser, "bandwidth=500\n"));
+    CHECK(lora_config_ini_parse_line(&parser, "own_channel=7"));
+    lora_config_ini_finish(&parser, &config);
+
+    lora_config_set_defaults(&defaults);
+    defaults.own_channel = 7;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    uint8_t expected[LORA_CONFIG_REG_COUNT];
+    lora_config_encode(&config, registers);
+    lora_config_encode(&defaults, expected);
+    CHECK_MEM(registers, expected, sizeof(expected));
+}
+
+static void test_field_widths(void) {
+    static const char* const lines[] = {
+        "own_address=65535\n",
+        "baud_rate=115200\n",
+        "encryption_key=65535\n",
+        "own_channel=300\n",
+    };
+    LoRaConfig config;
+
+    parse_lines(lines, COUNT_OF(lines), &config);
+    CHECK_EQ(config.own_address, 0xFFFF);
+    CHECK_EQ(config.baud_rate, 115200);
+    CHECK_EQ(config.encryption_key, 0xFFFF);
+    // Wider values are truncated to the member, as the old atoi parser did
+    CHECK_EQ(config.own_channel, 300 & 0xFF);
+}
+
+static void test_table_rounding(void) {
+    // Values between table entries load as the hex string encoder rounded them
+    static const char* const between[] = {"subpacket_size=100\n", "wor_cycle=1200\n"};
+    static const char* const outside[] = {"subpacket_size=250\n", "wor_cycle=9000\n"};
+    static const char* const below[] = {"subpacket_size=1\n", "wor_cycle=100\n"};
+    LoRaConfig config;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    parse_lines(between, COUNT_OF(between), &config);
+    lora_config_encode(&config, registers);
+    lora_config_decode(registers, &config);
+    CHECK_EQ(config.subpacket_size, 128);
+    CHECK_EQ(config.wor_cycle, 1000);
+
+    parse_lines(outside, COUNT_OF(outside), &config);
+    lora_config_encode(&config, registers);
+    lora_config_decode(registers, &config);
+    CHECK_EQ(config.subpacket_size, 200);
+    CHECK_EQ(config.wor_cycle, 4000);
+
+    parse_lines(below, COUNT_OF(below), &config);
+    lora_config_encode(&config, registers);
+    lora_config_decode(registers, &config);
+    CHECK_EQ(config.subpacket_size, 32);
+    CHECK_EQ(config.wor_cycle, 500);
+}
+
+int main(void) {
+    test_current_export();
+    test_version_1_migration();
+    test_missing_and_unknown();
+    test_field_widths();
+    test_table_rounding();
+    return test_result("config_ini");
+}
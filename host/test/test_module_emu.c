@@ -0,0 +1,405 @@
+#include "test.h"
+#include "../emu/e220_emu.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <lora_aux.h>
+#include <lora_module.h>
+#include <lora_rssi.h>
+
+static const uint8_t defaults[LORA_CONFIG_REG_COUNT] = E220_EMU_DEFAULT_REGISTERS;
+
+typedef struct {
+    E220Emu* emu;
+    LoraTesterUart* uart;
+    LoraModule* module;
+    LoraAux* aux;
+} Rig;
+
+typedef struct {
+    uint16_t address;
+    uint8_t channel;
+    uint8_t data[64];
+    size_t length;
+    uint32_t packets;
+} AirLog;
+
+typedef struct {
+    uint8_t data[64];
+    size_t length;
+    uint32_t idles;
+} UartLog;
+
+static void rig_init(Rig* rig) {
+    furi_shim_reset();
+    rig->emu = e220_emu_alloc();
+    rig->aux = lora_aux_alloc();
+    rig->uart = lora_tester_uart_alloc();
+    rig->module = lora_module_alloc(rig->uart);
+}
+
+static void rig_free(Rig* rig) {
+    lora_module_free(rig->module);
+    lora_tester_uart_free(rig->uart);
+    lora_aux_free(rig->aux);
+    e220_emu_free(rig->emu);
+}
+
+/** Same pin writes and AUX wait as lora_tester_set_mode */
+static bool rig_set_mode(Rig* rig, E220EmuMode mode) {
+    lora_aux_arm(rig->aux);
+    furi_hal_gpio_write(&gpio_ext_pa6, mode & 1);
+    furi_hal_gpio_write(&gpio_ext_pa7, mode & 2);
+    return lora_aux_wait_high(rig->aux, 100);
+}
+
+static void air_log_cb(
+    uint16_t address,
+    uint8_t channel,
+    const uint8_t* data,
+    size_t length,
+    void* context) {
+    AirLog* log = context;
+    log->address = address;
+    log->channel = channel;
+    log->length = length < sizeof(log->data) ? length : sizeof(log->data);
+    memcpy(log->data, data, log->length);
+    log->packets++;
+}
+
+static void uart_log_cb(const uint8_t* data, size_t length, bool idle, void* context) {
+    UartLog* log = context;
+    for(size_t i = 0; i < length && log->length < sizeof(log->data); i++) {
+        log->data[log->length++] = data[i];
+    }
+    log->idles += idle;
+}
+
+static void test_read_at_module_rate(void) {
+    Rig rig;
+    rig_init(&rig);
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(lora_module_read_registers(rig.module, 0, registers, 8, 1000), LoraModuleStatusOk);
+    CHECK_MEM(registers, defaults, sizeof(defaults));
+
+    // Turnaround plus 11 bytes at 9600 baud, delivered in FIFO sized chunks
+    uint32_t latency = lora_module_get_last_latency_us(rig.module);
+    CHECK(latency >= 500 + 11458 && latency <= 500 + 11458 + 10);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_wrong_rate_times_out(void) {
+    Rig rig;
+    rig_init(&rig);
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 115200));
+    uint64_t start = furi_shim_now_us();
+    CHECK_EQ(
+        lora_module_read_registers(rig.module, 0, registers, 8, 200), LoraModuleStatusTimeout);
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->wrong_baud_bytes, 3);
+    // The timeout is virtual: it passed on the clock, not in wall time
+    CHECK(furi_shim_now_us() - start >= 200000);
+
+    lora_module_set_baud_rate(rig.module, 9600);
+    CHECK_EQ(lora_module_read_registers(rig.module, 0, registers, 8, 200), LoraModuleStatusOk);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_write_survives_power_cycle(void) {
+    Rig rig;
+    rig_init(&rig);
+    uint8_t channel = 5;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(
+        lora_module_write_registers(rig.module, LoraReg2, &channel, 1, 1000), LoraModuleStatusOk);
+
+    lora_aux_arm(rig.aux);
+    e220_emu_power_cycle(rig.emu);
+    CHECK(lora_aux_wait_high(rig.aux, 100));
+    CHECK_EQ(lora_module_read_registers(rig.module, 0, registers, 8, 1000), LoraModuleStatusOk);
+    CHECK_EQ(registers[LoraReg2], 5);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_temporary_write_lost_on_power_cycle(void) {
+    Rig rig;
+    rig_init(&rig);
+    uint8_t channel = 7;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(
+        lora_module_write_registers_temporary(rig.module, LoraReg2, &channel, 1, 1000),
+        LoraModuleStatusOk);
+    CHECK_EQ(lora_module_read_registers(rig.module, 0, registers, 8, 1000), LoraModuleStatusOk);
+    CHECK_EQ(registers[LoraReg2], 7);
+    e220_emu_get_registers(rig.emu, registers, true);
+    CHECK_EQ(registers[LoraReg2], 0);
+
+    lora_aux_arm(rig.aux);
+    e220_emu_power_cycle(rig.emu);
+    CHECK(lora_aux_wait_high(rig.aux, 100));
+    CHECK_EQ(lora_module_read_registers(rig.module, 0, registers, 8, 1000), LoraModuleStatusOk);
+    CHECK_MEM(registers, defaults, sizeof(defaults));
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_write_echo_checked(void) {
+    Rig rig;
+    rig_init(&rig);
+    uint8_t image[LORA_CONFIG_REG_COUNT];
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    memcpy(image, defaults, sizeof(image));
+    image[LoraReg2] = 9;
+    image[LoraRegCryptH] = 0x12;
+    image[LoraRegCryptL] = 0x34;
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    // The key echoes as zeros and still counts as written
+    CHECK_EQ(
+        lora_module_write_registers(rig.module, 0, image, sizeof(image), 1000),
+        LoraModuleStatusOk);
+    e220_emu_get_registers(rig.emu, registers, true);
+    CHECK_MEM(registers, image, sizeof(image));
+
+    // An echo that disagrees with the write is not taken as confirmation
+    uint8_t channel = 10;
+    e220_emu_corrupt_next_reply(rig.emu);
+    CHECK_EQ(
+        lora_module_write_registers(rig.module, LoraReg2, &channel, 1, 1000),
+        LoraModuleStatusBadResponse);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_rate_change_after_echo(void) {
+    Rig rig;
+    rig_init(&rig);
+    uint8_t reg0 = (7 << 5) | (defaults[LoraReg0] & 0x1F);
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    // The echo still comes at the old rate, the new one applies once AUX is back up
+    lora_aux_arm(rig.aux);
+    CHECK_EQ(
+        lora_module_write_registers(rig.module, LoraReg0, &reg0, 1, 1000), LoraModuleStatusOk);
+    CHECK_EQ(e220_emu_get_baud_rate(rig.emu), 9600);
+    CHECK(lora_aux_wait_high(rig.aux, 10));
+    CHECK_EQ(e220_emu_get_baud_rate(rig.emu), 115200);
+
+    lora_module_set_baud_rate(rig.module, 115200);
+    CHECK_EQ(lora_module_read_registers(rig.module, 0, registers, 8, 1000), LoraModuleStatusOk);
+    CHECK_EQ(registers[LoraReg0], reg0);
+    CHECK(lora_module_get_last_latency_us(rig.module) < 2000);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_bad_command(void) {
+    Rig rig;
+    rig_init(&rig);
+    static const uint8_t unknown[] = {0xC5, 0x00, 0x01};
+    static const uint8_t out_of_range[] = {0xC1, 0x07, 0x02};
+    static const uint8_t error[] = {0xFF, 0xFF, 0xFF};
+    uint8_t response[3];
+
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(
+        lora_module_transact(rig.module, unknown, sizeof(unknown), response, 3, 1000),
+        LoraModuleStatusOk);
+    CHECK_MEM(response, error, sizeof(error));
+    CHECK_EQ(
+        lora_module_transact(
+            rig.module, out_of_range, sizeof(out_of_range), response, 3, 1000),
+        LoraModuleStatusOk);
+    CHECK_MEM(response, error, sizeof(error));
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->bad_commands, 2);
+
+    // The module is still in step for the next command
+    uint8_t registers[2];
+    CHECK_EQ(
+        lora_module_read_registers(rig.module, LoraRegCryptH, registers, 2, 100),
+        LoraModuleStatusOk);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_normal_mode_sends_on_air(void) {
+    Rig rig;
+    rig_init(&rig);
+    AirLog air = {0};
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    static const uint8_t read[] = {0xC1, 0x00, 0x08};
+
+    e220_emu_set_air_callback(rig.emu, air_log_cb, &air);
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(
+        lora_module_read_registers(rig.module, 0, registers, 8, 300), LoraModuleStatusTimeout);
+    CHECK_EQ(air.packets, 1);
+    CHECK_EQ(air.length, sizeof(read));
+    CHECK_MEM(air.data, read, sizeof(read));
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->commands, 0);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_mode_switch_aux(void) {
+    Rig rig;
+    rig_init(&rig);
+
+    e220_emu_set_mode_switch_us(rig.emu, 5000);
+    uint64_t start = furi_shim_now_us();
+    lora_aux_arm(rig.aux);
+    furi_hal_gpio_write(&gpio_ext_pa6, true);
+    furi_hal_gpio_write(&gpio_ext_pa7, true);
+    CHECK(!lora_aux_read(rig.aux));
+    CHECK(!lora_aux_wait_high(rig.aux, 3));
+    CHECK(lora_aux_wait_high(rig.aux, 10));
+    CHECK(lora_aux_read(rig.aux));
+    CHECK_EQ(furi_shim_now_us() - start, 5000);
+    CHECK_EQ(e220_emu_get_mode(rig.emu), E220EmuModeConfig);
+    // M0 then M1, passing through WOR transmit on the way
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->mode_changes, 2);
+
+    // Writing the level a pin already has is no mode change
+    lora_aux_arm(rig.aux);
+    furi_hal_gpio_write(&gpio_ext_pa6, true);
+    CHECK(!lora_aux_wait_high(rig.aux, 10));
+
+    rig_free(&rig);
+}
+
+static void test_rssi_command(void) {
+    Rig rig;
+    rig_init(&rig);
+    static const uint8_t command[] = LORA_RSSI_COMMAND;
+    uint8_t response[5];
+    uint8_t reg1 = LORA_CONFIG_REG1_RSSI_AMBIENT;
+
+    e220_emu_set_rssi(rig.emu, 0x40, 0x90);
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(
+        lora_module_write_registers(rig.module, LoraReg1, &reg1, 1, 1000), LoraModuleStatusOk);
+    CHECK(rig_set_mode(&rig, E220EmuModeNormal));
+
+    CHECK_EQ(
+        lora_module_transact(rig.module, command, sizeof(command), response, 5, 1000),
+        LoraModuleStatusOk);
+    CHECK_EQ(response[0], 0xC1);
+    CHECK_EQ(response[1], 0x00);
+    CHECK_EQ(response[2], 0x02);
+    CHECK_EQ(response[3], 0x40);
+    CHECK_EQ(response[4], 0x90);
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->rssi_replies, 1);
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->packets_sent, 0);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_fixed_transmission(void) {
+    Rig rig;
+    rig_init(&rig);
+    AirLog air = {0};
+    uint8_t reg3 = 1 << 6;
+    static const uint8_t packet[] = {0x12, 0x34, 0x05, 'h', 'i'};
+
+    e220_emu_set_air_callback(rig.emu, air_log_cb, &air);
+    CHECK(rig_set_mode(&rig, E220EmuModeConfig));
+    CHECK(lora_module_open(rig.module, 9600));
+    CHECK_EQ(
+        lora_module_write_registers(rig.module, LoraReg3, &reg3, 1, 1000), LoraModuleStatusOk);
+    CHECK(rig_set_mode(&rig, E220EmuModeNormal));
+
+    lora_tester_uart_tx(rig.uart, packet, sizeof(packet));
+    furi_delay_ms(10);
+    // Sending at SF9 125 kHz takes tens of milliseconds, AUX is low meanwhile
+    CHECK(!lora_aux_read(rig.aux));
+    CHECK_EQ(air.packets, 0);
+    furi_delay_ms(200);
+    CHECK(lora_aux_read(rig.aux));
+    CHECK_EQ(air.packets, 1);
+    CHECK_EQ(air.address, 0x1234);
+    CHECK_EQ(air.channel, 5);
+    CHECK_EQ(air.length, 2);
+    CHECK_MEM(air.data, "hi", 2);
+
+    lora_module_close(rig.module);
+    rig_free(&rig);
+}
+
+static void test_air_receive(void) {
+    Rig rig;
+    rig_init(&rig);
+    UartLog log = {0};
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+
+    memcpy(registers, defaults, sizeof(registers));
+    registers[LoraRegAddL] = 0x01;
+    registers[LoraReg2] = 3;
+    registers[LoraReg3] = 1 << 7;
+    e220_emu_set_registers(rig.emu, registers);
+    CHECK(lora_tester_uart_claim(rig.uart, 9600, uart_log_cb, &log, 100));
+
+    CHECK(!e220_emu_air_receive(rig.emu, 0x0001, 4, (const uint8_t*)"abc", 3, 0xA0));
+    CHECK(!e220_emu_air_receive(rig.emu, 0x0002, 3, (const uint8_t*)"abc", 3, 0xA0));
+    CHECK_EQ(e220_emu_get_stats(rig.emu)->packets_filtered, 2);
+
+    lora_aux_arm(rig.aux);
+    CHECK(e220_emu_air_receive(rig.emu, 0x0001, 3, (const uint8_t*)"abc", 3, 0xA0));
+    CHECK(!lora_aux_read(rig.aux));
+    CHECK(lora_aux_wait_high(rig.aux, 100));
+    CHECK_EQ(log.length, 4);
+    CHECK_MEM(log.data, "abc\xA0", 4);
+    CHECK_EQ(log.idles, 1);
+
+    // Broadcast reaches every address
+    CHECK(e220_emu_air_receive(rig.emu, 0xFFFF, 3, (const uint8_t*)"z", 1, 0xB0));
+    furi_delay_ms(100);
+    CHECK_EQ(log.length, 6);
+    CHECK_EQ(log.idles, 2);
+
+    lora_tester_uart_release(rig.uart);
+    rig_free(&rig);
+}
+
+int main(void) {
+    test_read_at_module_rate();
+    test_wrong_rate_times_out();
+    test_write_survives_power_cycle();
+    test_temporary_write_lost_on_power_cycle();
+    test_write_echo_checked();
+    test_rate_change_after_echo();
+    test_bad_command();
+    test_normal_mode_sends_on_air();
+    test_mode_switch_aux();
+    test_rssi_command();
+    test_fixed_transmission();
+    test_air_receive();
+    return test_result("module_emu");
+}
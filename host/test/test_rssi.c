@@ -0,0 +1,74 @@
+// RSSI reply parsing, the sparkline history and the channel survey table
+
+#include "test.h"
+#include "lora_rssi.h"
+
+static LoraRssiParserResult feed(LoraRssiParser* parser, const uint8_t* data, size_t length) {
+    LoraRssiParserResult result = LoraRssiParserData;
+    for(size_t i = 0; i < length; i++) {
+        result = lora_rssi_parser_feed(parser, data[i]);
+    }
+    return result;
+}
+
+static void test_parser(void) {
+    LoraRssiParser parser;
+    const uint8_t reply[] = {0xC1, 0x00, 0x02, 0x50, 0x60};
+    const uint8_t broken[] = {0xC1, 0x00, 0x07};
+
+    lora_rssi_parser_reset(&parser);
+    CHECK_EQ(feed(&parser, reply, 4), LoraRssiParserPending);
+    CHECK_EQ(lora_rssi_parser_feed(&parser, reply[4]), LoraRssiParserReply);
+    CHECK_EQ(parser.values[0], 0x50);
+    CHECK_EQ(parser.values[1], 0x60);
+
+    lora_rssi_parser_reset(&parser);
+    CHECK_EQ(feed(&parser, broken, sizeof(broken)), LoraRssiParserData);
+    CHECK_EQ(lora_rssi_parser_feed(&parser, 0x41), LoraRssiParserData);
+
+    CHECK_EQ(lora_rssi_dbm(0xFF), -1);
+    CHECK_EQ(lora_rssi_dbm(0x00), -256);
+}
+
+static void test_history(void) {
+    LoraRssiHistory history;
+    LoraRssiSummary summary;
+
+    lora_rssi_history_reset(&history);
+    CHECK(!lora_rssi_history_summary(&history, &summary));
+    for(int i = 0; i < LORA_RSSI_HISTORY_SIZE + 2; i++) {
+        lora_rssi_history_push(&history, -100 - i);
+    }
+    CHECK_EQ(history.count, LORA_RSSI_HISTORY_SIZE);
+    CHECK_EQ(lora_rssi_history_get(&history, 0), -100 - (LORA_RSSI_HISTORY_SIZE + 1));
+    CHECK(lora_rssi_history_summary(&history, &summary));
+    CHECK_EQ(summary.max, -102);
+    CHECK_EQ(summary.min, -100 - (LORA_RSSI_HISTORY_SIZE + 1));
+}
+
+static void test_survey(void) {
+    LoraSurvey survey;
+
+    lora_survey_reset(&survey, 31);
+    CHECK_EQ(survey.channels, 31);
+    CHECK_EQ(lora_survey_quietest(&survey), -1);
+
+    lora_survey_set(&survey, 3, -110 * 3 - 1, 3);
+    lora_survey_set(&survey, 5, -120, 1);
+    lora_survey_set(&survey, 7, -120, 1);
+    // Ties go to the lower channel, channels past the band are ignored
+    CHECK_EQ(lora_survey_quietest(&survey), 5);
+    lora_survey_set(&survey, 35, -130, 1);
+    CHECK_EQ(lora_survey_quietest(&survey), 5);
+
+    lora_survey_set(&survey, 5, 0, 0);
+    CHECK_EQ(survey.noise[5], LORA_SURVEY_NO_DATA);
+    CHECK_EQ(lora_survey_quietest(&survey), 7);
+}
+
+int main(void) {
+    test_parser();
+    test_history();
+    test_survey();
+    return test_result("rssi");
+}
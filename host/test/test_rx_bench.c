@@ -0,0 +1,111 @@
+// Stream sources of the receive path benchmark and its emulated timeline
+
+#include "test.h"
+#include "lora_rx_bench.h"
+
+/** Every stage appears free, only the line rate and the scene's timers remain */
+static uint32_t free_clock(void) {
+    static uint32_t cycles;
+    return cycles++;
+}
+
+static size_t put_record(uint8_t* out, uint32_t tick, const uint8_t* data, uint16_t length) {
+    out[0] = tick;
+    out[1] = tick >> 8;
+    out[2] = tick >> 16;
+    out[3] = tick >> 24;
+    out[4] = length;
+    out[5] = length >> 8;
+    out[6] = 0xB4;
+    out[7] = 1;
+    memcpy(&out[8], data, length);
+    return 8 + length;
+}
+
+static void test_parse_capture(void) {
+    uint8_t image[64] = {'E', 'C', 'A', 'P', 1, 0, 0, 0, 0x80, 0x25, 0, 0, 0x10, 0, 0, 0};
+    const uint8_t first[] = {0x01, 0x02, 0x03};
+    const uint8_t second[] = {0x04};
+    LoraRxBenchPacket packets[4];
+    uint32_t baud_rate = 0;
+    bool rssi_byte = false;
+
+    size_t size = 16;
+    size += put_record(&image[size], 1000, first, sizeof(first));
+    size += put_record(&image[size], 1250, second, sizeof(second));
+    CHECK_EQ(lora_rx_bench_parse_capture(image, size, packets, 4, &baud_rate, &rssi_byte), 2);
+    CHECK_EQ(baud_rate, 9600);
+    CHECK(rssi_byte);
+    CHECK_EQ(packets[0].length, 3);
+    CHECK_MEM(packets[0].data, first, sizeof(first));
+    CHECK_EQ(packets[0].start_ms, 0);
+    CHECK_EQ(packets[1].start_ms, 250);
+    CHECK_EQ(packets[1].rssi, 0xB4);
+
+    // A record cut short by the end of the file is left out
+    CHECK_EQ(lora_rx_bench_parse_capture(image, size - 1, packets, 4, &baud_rate, &rssi_byte), 1);
+    CHECK_EQ(lora_rx_bench_parse_capture(image, size, packets, 1, &baud_rate, &rssi_byte), 1);
+
+    image[0] = 'X';
+    CHECK_EQ(lora_rx_bench_parse_capture(image, size, packets, 4, &baud_rate, &rssi_byte), 0);
+}
+
+static void test_synthetic(void) {
+    LoraRxBenchPacket packets[64];
+    uint8_t buffer[1024];
+    size_t count = lora_rx_bench_synthetic(packets, COUNT_OF(packets), buffer, sizeof(buffer));
+    size_t total = 0;
+
+    CHECK(count > 4);
+    for(size_t i = 0; i < count; i++) {
+        CHECK(packets[i].length > 0 && packets[i].length <= 200);
+        CHECK(packets[i].data == &buffer[total]);
+        total += packets[i].length;
+    }
+    CHECK(total <= sizeof(buffer));
+    CHECK_EQ(lora_rx_bench_synthetic(packets, 2, buffer, sizeof(buffer)), 2);
+}
+
+static void test_run(void) {
+    LoraRxBenchPacket packets[64];
+    uint8_t buffer[4096];
+    LoraRxBenchResult result;
+    LoraRxBench bench = {.packets = packets, .clock = free_clock, .cycles_per_us = 64};
+    bench.count = lora_rx_bench_synthetic(packets, COUNT_OF(packets), buffer, sizeof(buffer));
+    uint32_t total = 0;
+    for(size_t i = 0; i < bench.count; i++) {
+        total += packets[i].length;
+    }
+
+    CHECK(lora_rx_bench_run(&bench, 115200, &result));
+    CHECK_EQ(result.baud_rate, 115200);
+    CHECK_EQ(result.bytes, total);
+    CHECK_EQ(result.packets, bench.count);
+    CHECK_EQ(result.dropped, 0);
+    CHECK_EQ(result.overruns, 0);
+    CHECK(result.refreshes > 0);
+    // Worst case is a draw deferred by the 8 fps limit and then by the 100ms tick
+    CHECK(result.latency_max_us <= 125000 + 100000);
+
+    // The RSSI byte goes through the ring but isn't part of the packet
+    bench.rssi_byte = true;
+    CHECK(lora_rx_bench_run(&bench, 9600, &result));
+    CHECK_EQ(result.bytes, total + bench.count);
+    CHECK_EQ(result.packets, bench.count);
+
+    // Recorded spacing stretches the replay, a second between the two packets
+    packets[1].start_ms = 1000;
+    bench.count = 2;
+    bench.timed = true;
+    CHECK(lora_rx_bench_run(&bench, 115200, &result));
+    CHECK(result.duration_ms >= 1000);
+
+    CHECK_EQ(lora_rx_bench_max_rate(&bench), 100000000);
+}
+
+int main(void) {
+    test_parse_capture();
+    test_synthetic();
+    test_run();
+    return test_result("rx_bench");
+}
@@ -0,0 +1,127 @@
+// Packet boundaries from idle/AUX ends, the gap timeout and buffer splits
+
+#include "test.h"
+#include "lora_rx_framer.h"
+
+typedef struct {
+    size_t count;
+    uint8_t data[4][LORA_RX_FRAMER_MAX_PACKET];
+    LoraRxPacket packets[4];
+} Collected;
+
+static void collect(const LoraRxPacket* packet, void* context) {
+    Collected* collected = context;
+    if(collected->count < COUNT_OF(collected->packets)) {
+        memcpy(collected->data[collected->count], packet->data, packet->length);
+        collected->packets[collected->count] = *packet;
+        collected->packets[collected->count].data = collected->data[collected->count];
+    }
+    collected->count++;
+}
+
+static void test_gap(void) {
+    CHECK_EQ(lora_rx_framer_gap_ms(0), 2);
+    CHECK_EQ(lora_rx_framer_gap_ms(1200), 30);
+    CHECK_EQ(lora_rx_framer_gap_ms(9600), 4);
+    CHECK_EQ(lora_rx_framer_gap_ms(115200), 2);
+}
+
+static void test_end(void) {
+    LoraRxFramer framer;
+    Collected collected = {0};
+    const uint8_t first[] = {0x01, 0x02};
+    const uint8_t second[] = {0x03};
+
+    lora_rx_framer_init(&framer, 4, false, collect, &collected);
+    lora_rx_framer_end(&framer);
+    CHECK_EQ(collected.count, 0);
+
+    lora_rx_framer_push(&framer, first, sizeof(first), 100);
+    lora_rx_framer_push(&framer, second, sizeof(second), 101);
+    CHECK(lora_rx_framer_pending(&framer));
+    lora_rx_framer_end(&framer);
+
+    CHECK_EQ(collected.count, 1);
+    CHECK_EQ(collected.packets[0].length, 3);
+    CHECK_EQ(collected.packets[0].start_tick, 100);
+    CHECK(!collected.packets[0].has_rssi);
+    CHECK_EQ(collected.data[0][2], 0x03);
+    CHECK(!lora_rx_framer_pending(&framer));
+    CHECK_EQ(framer.packets, 1);
+}
+
+static void test_rssi_byte(void) {
+    LoraRxFramer framer;
+    Collected collected = {0};
+    const uint8_t packet[] = {0x41, 0x42, 0xA0};
+    const uint8_t lone[] = {0x41};
+
+    lora_rx_framer_init(&framer, 4, true, collect, &collected);
+    lora_rx_framer_push(&framer, packet, sizeof(packet), 0);
+    lora_rx_framer_end(&framer);
+    // A single byte can't be data and RSSI both, it's kept as data
+    lora_rx_framer_push(&framer, lone, sizeof(lone), 0);
+    lora_rx_framer_end(&framer);
+
+    CHECK_EQ(collected.count, 2);
+    CHECK(collected.packets[0].has_rssi);
+    CHECK_EQ(collected.packets[0].rssi, 0xA0);
+    CHECK_EQ(collected.packets[0].length, 2);
+    CHECK(!collected.packets[1].has_rssi);
+    CHECK_EQ(collected.packets[1].length, 1);
+}
+
+static void test_poll(void) {
+    LoraRxFramer framer;
+    Collected collected = {0};
+    const uint8_t data[] = {0x55};
+
+    lora_rx_framer_init(&framer, 4, false, collect, &collected);
+    lora_rx_framer_push(&framer, data, sizeof(data), 1000);
+    lora_rx_framer_poll(&framer, 1003);
+    CHECK_EQ(collected.count, 0);
+    lora_rx_framer_push(&framer, data, sizeof(data), 1003);
+    lora_rx_framer_poll(&framer, 1006);
+    CHECK_EQ(collected.count, 0);
+    lora_rx_framer_poll(&framer, 1007);
+    CHECK_EQ(collected.count, 1);
+    CHECK_EQ(collected.packets[0].length, 2);
+
+    // Tick wrap around
+    lora_rx_framer_push(&framer, data, sizeof(data), UINT32_MAX - 1);
+    lora_rx_framer_poll(&framer, 1);
+    CHECK_EQ(collected.count, 1);
+    lora_rx_framer_poll(&framer, 2);
+    CHECK_EQ(collected.count, 2);
+}
+
+static void test_split(void) {
+    LoraRxFramer framer;
+    Collected collected = {0};
+    uint8_t data[300];
+
+    for(size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+    lora_rx_framer_init(&framer, 4, false, collect, &collected);
+    lora_rx_framer_push(&framer, data, sizeof(data), 5);
+    CHECK_EQ(collected.count, 1);
+    CHECK_EQ(collected.packets[0].length, LORA_RX_FRAMER_MAX_PACKET);
+    CHECK_EQ(framer.splits, 1);
+
+    lora_rx_framer_set_start_tick(&framer, 9);
+    lora_rx_framer_end(&framer);
+    CHECK_EQ(collected.count, 2);
+    CHECK_EQ(collected.packets[1].length, sizeof(data) - LORA_RX_FRAMER_MAX_PACKET);
+    CHECK_EQ(collected.packets[1].start_tick, 9);
+    CHECK_EQ(collected.data[1][0], LORA_RX_FRAMER_MAX_PACKET & 0xFF);
+}
+
+int main(void) {
+    test_gap();
+    test_end();
+    test_rssi_byte();
+    test_poll();
+    test_split();
+    return test_result("rx_framer");
+}
@@ -0,0 +1,104 @@
+// ISR to worker byte ring: ordering, overflow, wrap around and frame marks
+
+#include "test.h"
+#include "lora_rx_ring.h"
+
+static LoraRxRing ring;
+
+static void push_run(size_t count, uint8_t first) {
+    for(size_t i = 0; i < count; i++) {
+        lora_rx_ring_push(&ring, (uint8_t)(first + i));
+    }
+}
+
+static void test_fifo(void) {
+    uint8_t out[8];
+
+    lora_rx_ring_reset(&ring);
+    CHECK_EQ(lora_rx_ring_pop(&ring, out, sizeof(out)), 0);
+    push_run(5, 10);
+    CHECK_EQ(lora_rx_ring_count(&ring), 5);
+    CHECK_EQ(lora_rx_ring_pop(&ring, out, 3), 3);
+    CHECK_EQ(out[0], 10);
+    CHECK_EQ(out[2], 12);
+    CHECK_EQ(lora_rx_ring_pop(&ring, out, sizeof(out)), 2);
+    CHECK_EQ(out[1], 14);
+    CHECK_EQ(lora_rx_ring_count(&ring), 0);
+}
+
+static void test_overflow(void) {
+    uint8_t out[LORA_RX_RING_SIZE];
+
+    lora_rx_ring_reset(&ring);
+    push_run(LORA_RX_RING_SIZE, 0);
+    CHECK(!lora_rx_ring_push(&ring, 0xFF));
+    CHECK_EQ(ring.dropped, 1);
+    CHECK_EQ(lora_rx_ring_pop(&ring, out, sizeof(out)), LORA_RX_RING_SIZE);
+    CHECK_EQ(out[LORA_RX_RING_SIZE - 1], (LORA_RX_RING_SIZE - 1) & 0xFF);
+    CHECK(lora_rx_ring_push(&ring, 0xFF));
+}
+
+static void test_wrap(void) {
+    uint8_t out[64];
+
+    lora_rx_ring_reset(&ring);
+    // Leave the read position 8 bytes short of the end of storage
+    push_run(LORA_RX_RING_SIZE - 8, 0);
+    while(lora_rx_ring_pop(&ring, out, sizeof(out))) {
+    }
+    push_run(20, 100);
+    CHECK_EQ(lora_rx_ring_pop(&ring, out, sizeof(out)), 20);
+    for(size_t i = 0; i < 20; i++) {
+        CHECK_EQ(out[i], 100 + i);
+    }
+}
+
+static void test_marks(void) {
+    uint8_t out[16];
+    bool end_of_frame;
+    LoraRxRingMark mark;
+
+    lora_rx_ring_reset(&ring);
+    push_run(3, 1);
+    CHECK(lora_rx_ring_mark(&ring, 50));
+    // Nothing new since the last mark, no second boundary
+    CHECK(lora_rx_ring_mark(&ring, 51));
+    push_run(4, 4);
+    CHECK(lora_rx_ring_mark(&ring, 60));
+    push_run(2, 8);
+
+    CHECK_EQ(lora_rx_ring_pop_frame(&ring, out, 2, &end_of_frame, &mark), 2);
+    CHECK(!end_of_frame);
+    CHECK_EQ(lora_rx_ring_pop_frame(&ring, out, sizeof(out), &end_of_frame, &mark), 1);
+    CHECK(end_of_frame);
+    CHECK_EQ(mark.start_tick, 50);
+    CHECK_EQ(out[0], 3);
+
+    CHECK_EQ(lora_rx_ring_pop_frame(&ring, out, sizeof(out), &end_of_frame, &mark), 4);
+    CHECK(end_of_frame);
+    CHECK_EQ(mark.start_tick, 60);
+
+    // Bytes after the last boundary come out without one
+    CHECK_EQ(lora_rx_ring_pop_frame(&ring, out, sizeof(out), &end_of_frame, &mark), 2);
+    CHECK(!end_of_frame);
+}
+
+static void test_mark_overflow(void) {
+    lora_rx_ring_reset(&ring);
+    for(size_t i = 0; i < LORA_RX_RING_MARKS; i++) {
+        push_run(1, i);
+        CHECK(lora_rx_ring_mark(&ring, i));
+    }
+    push_run(1, 0);
+    CHECK(!lora_rx_ring_mark(&ring, 0));
+    CHECK_EQ(ring.marks_dropped, 1);
+}
+
+int main(void) {
+    test_fifo();
+    test_overflow();
+    test_wrap();
+    test_marks();
+    test_mark_overflow();
+    return test_result("rx_ring");
+}
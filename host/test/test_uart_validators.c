@@ -0,0 +1,32 @@
+// Validator rejecting names that would overwrite an existing file
+
+#include "test.h"
+#include <furi.h>
+#include "uart_validators.h"
+
+static void test_validator(void) {
+    FuriString* error = furi_string_alloc();
+    ValidatorIsFile* validator = validator_is_file_alloc_init("/ext/LoRa_Setting", ".ini", NULL);
+
+    furi_shim_storage_add("/ext/LoRa_Setting/home.ini");
+    CHECK(validator_is_file_callback("office", error, validator));
+    CHECK_EQ(furi_string_size(error), 0);
+    CHECK(!validator_is_file_callback("home", error, validator));
+    CHECK(furi_string_size(error) > 0);
+    validator_is_file_free(validator);
+
+    // Keeping the name being edited is allowed even though the file exists
+    furi_string_reset(error);
+    validator = validator_is_file_alloc_init("/ext/LoRa_Setting", ".ini", "home");
+    CHECK(validator_is_file_callback("home", error, validator));
+    CHECK_EQ(furi_string_size(error), 0);
+    validator_is_file_free(validator);
+
+    furi_shim_storage_clear();
+    furi_string_free(error);
+}
+
+int main(void) {
+    test_validator();
+    return test_result("uart_validators");
+}
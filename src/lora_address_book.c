@@ -0,0 +1,71 @@
+#include "lora_address_book.h"
+#include <furi.h>
+#include <toolbox/stream/file_stream.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define TAG "LoRaTester"
+
+bool lora_address_book_parse_line(const char* line, LoraAddressEntry* entry) {
+    while(isspace((unsigned char)*line)) {
+        line++;
+    }
+    if(*line == '\0' || *line == '#') {
+        return false;
+    }
+
+    const char* comma = strchr(line, ',');
+    if(!comma || comma == line) {
+        return false;
+    }
+
+    size_t name_length = comma - line;
+    if(name_length >= LORA_ADDRESS_BOOK_NAME_SIZE) {
+        name_length = LORA_ADDRESS_BOOK_NAME_SIZE - 1;
+    }
+
+    char* end;
+    unsigned long address = strtoul(comma + 1, &end, 0);
+    if(end == comma + 1 || *end != ',' || address > 0xFFFF) {
+        return false;
+    }
+
+    const char* channel_start = end + 1;
+    unsigned long channel = strtoul(channel_start, &end, 0);
+    if(end == channel_start || channel > 0xFF) {
+        return false;
+    }
+
+    memcpy(entry->name, line, name_length);
+    entry->name[name_length] = '\0';
+    entry->address = address;
+    entry->channel = channel;
+    return true;
+}
+
+bool lora_address_book_load(LoraAddressBook* book, Storage* storage) {
+    Stream* stream = file_stream_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    bool success = false;
+
+    book->count = 0;
+    if(file_stream_open(stream, LORA_ADDRESS_BOOK_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        while(book->count < LORA_ADDRESS_BOOK_MAX_ENTRIES && stream_read_line(stream, line)) {
+            furi_string_trim(line);
+            if(lora_address_book_parse_line(
+                   furi_string_get_cstr(line), &book->entries[book->count])) {
+                book->count++;
+            }
+        }
+        success = true;
+        FURI_LOG_I(TAG, "Loaded %u address book entries", book->count);
+    } else {
+        FURI_LOG_W(TAG, "No address book at %s", LORA_ADDRESS_BOOK_PATH);
+    }
+
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_string_free(line);
+    return success;
+}
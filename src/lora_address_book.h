@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One "name,address,channel" entry per line, '#' starts a comment */
+#define LORA_ADDRESS_BOOK_PATH "/ext/LoRa_Setting/address_book.txt"
+#define LORA_ADDRESS_BOOK_MAX_ENTRIES 16
+#define LORA_ADDRESS_BOOK_NAME_SIZE 16
+
+/** Address every module in fixed mode accepts, on the given channel */
+#define LORA_ADDRESS_BROADCAST 0xFFFF
+
+/** Bytes a fixed-transmission frame carries ahead of the payload */
+#define LORA_FIXED_HEADER_SIZE 3
+
+typedef struct {
+    char name[LORA_ADDRESS_BOOK_NAME_SIZE];
+    uint16_t address;
+    uint8_t channel;
+} LoraAddressEntry;
+
+typedef struct {
+    LoraAddressEntry entries[LORA_ADDRESS_BOOK_MAX_ENTRIES];
+    size_t count;
+} LoraAddressBook;
+
+/** Parse one address book line
+ *
+ * @return     true if the line held an entry, false for blanks, comments
+ *             and malformed lines
+ */
+bool lora_address_book_parse_line(const char* line, LoraAddressEntry* entry);
+
+/** Load the address book from SD, replacing any previous entries
+ *
+ * @return     false if the file could not be opened
+ */
+bool lora_address_book_load(LoraAddressBook* book, Storage* storage);
+
+/** Write the fixed-transmission header for target in front of a payload
+ *
+ * @param      header  LORA_FIXED_HEADER_SIZE bytes
+ */
+static inline void lora_fixed_header_write(uint8_t* header, const LoraAddressEntry* target) {
+    header[0] = target->address >> 8;
+    header[1] = target->address & 0xFF;
+    header[2] = target->channel;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+#include "lora_aux.h"
+
+#include <furi.h>
+#include <furi_hal.h>
+
+#define LORA_AUX_PIN (&gpio_ext_pa4)
+
+struct LoraAux {
+    FuriSemaphore* rising;
+    LoraAuxCallback callback;
+    void* context;
+};
+
+static void lora_aux_isr(void* context) {
+    LoraAux* aux = context;
+    bool level = furi_hal_gpio_read(LORA_AUX_PIN);
+    if(level) {
+        // Capacity 1, a second edge before the waiter runs is dropped
+        furi_semaphore_release(aux->rising);
+    }
+    if(aux->callback) {
+        aux->callback(level, aux->context);
+    }
+}
+
+LoraAux* lora_aux_alloc(void) {
+    LoraAux* aux = malloc(sizeof(LoraAux));
+    aux->callback = NULL;
+    aux->context = NULL;
+    aux->rising = furi_semaphore_alloc(1, 0);
+
+    furi_hal_gpio_init(LORA_AUX_PIN, GpioModeInterruptRiseFall, GpioPullNo, GpioSpeedVeryHigh);
+    furi_hal_gpio_add_int_callback(LORA_AUX_PIN, lora_aux_isr, aux);
+
+    return aux;
+}
+
+void lora_aux_free(LoraAux* aux) {
+    furi_assert(aux);
+
+    furi_hal_gpio_remove_int_callback(LORA_AUX_PIN);
+    furi_hal_gpio_init(LORA_AUX_PIN, GpioModeAnalog, GpioPullNo, GpioSpeedLow);
+
+    furi_semaphore_free(aux->rising);
+    free(aux);
+}
+
+bool lora_aux_read(LoraAux* aux) {
+    UNUSED(aux);
+    return furi_hal_gpio_read(LORA_AUX_PIN);
+}
+
+void lora_aux_arm(LoraAux* aux) {
+    furi_assert(aux);
+    furi_semaphore_acquire(aux->rising, 0);
+}
+
+bool lora_aux_wait_high(LoraAux* aux, uint32_t timeout_ms) {
+    furi_assert(aux);
+    return furi_semaphore_acquire(aux->rising, furi_ms_to_ticks(timeout_ms)) == FuriStatusOk;
+}
+
+void lora_aux_set_callback(LoraAux* aux, LoraAuxCallback callback, void* context) {
+    furi_assert(aux);
+
+    furi_hal_gpio_disable_int_callback(LORA_AUX_PIN);
+    aux->callback = callback;
+    aux->context = context;
+    furi_hal_gpio_enable_int_callback(LORA_AUX_PIN);
+}
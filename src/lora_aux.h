@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** E220 AUX pin (PA4) monitor.
+ *
+ * AUX is low while the module is busy (outputting a received packet,
+ * transmitting, switching mode) and goes high when it is idle again.
+ */
+typedef struct LoraAux LoraAux;
+
+/** Called from interrupt context on every AUX edge with the new level */
+typedef void (*LoraAuxCallback)(bool level, void* context);
+
+/** Configure PA4 as an input with edge interrupts */
+LoraAux* lora_aux_alloc(void);
+
+/** Release PA4 and return it to analog mode */
+void lora_aux_free(LoraAux* aux);
+
+/** Current AUX level */
+bool lora_aux_read(LoraAux* aux);
+
+/** Forget rising edges seen so far, call before the action that drops AUX */
+void lora_aux_arm(LoraAux* aux);
+
+/** Wait for a rising edge since the last lora_aux_arm
+ *
+ * @return     true if AUX went high within timeout_ms
+ */
+bool lora_aux_wait_high(LoraAux* aux, uint32_t timeout_ms);
+
+/** Set or clear (NULL) the edge callback */
+void lora_aux_set_callback(LoraAux* aux, LoraAuxCallback callback, void* context);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+#include "lora_baud_detect.h"
+#include <furi.h>
+#include <toolbox/stream/file_stream.h>
+#include <stdlib.h>
+
+#define TAG "LoRaTester"
+
+/* C1 00 08 out, C1 00 08 and 8 registers back, 10 bits per byte */
+#define LORA_BAUD_DETECT_FRAME_BITS ((3 + 3 + 8) * 10)
+#define LORA_BAUD_DETECT_TURNAROUND_MS 50
+#define LORA_BAUD_DETECT_DIRECTORY "/ext/LoRa_Setting"
+
+/* E220 factory default first, then rates commonly picked to speed it up */
+static const uint32_t lora_baud_detect_popular[] =
+    {9600, 115200, 19200, 38400, 57600, 4800, 2400, 1200};
+
+static bool lora_baud_detect_push(
+    const uint32_t* rates,
+    size_t count,
+    uint32_t rate,
+    uint32_t* order,
+    size_t* length) {
+    bool candidate = false;
+    for(size_t i = 0; i < count; i++) {
+        if(rates[i] == rate) {
+            candidate = true;
+            break;
+        }
+    }
+    if(!candidate) {
+        return false;
+    }
+    for(size_t i = 0; i < *length; i++) {
+        if(order[i] == rate) {
+            return false;
+        }
+    }
+    order[(*length)++] = rate;
+    return true;
+}
+
+size_t lora_baud_detect_order(
+    const uint32_t* rates,
+    size_t count,
+    uint32_t current,
+    uint32_t last,
+    uint32_t* order) {
+    size_t length = 0;
+
+    lora_baud_detect_push(rates, count, current, order, &length);
+    lora_baud_detect_push(rates, count, last, order, &length);
+    for(size_t i = 0; i < COUNT_OF(lora_baud_detect_popular); i++) {
+        lora_baud_detect_push(rates, count, lora_baud_detect_popular[i], order, &length);
+    }
+    for(size_t i = 0; i < count; i++) {
+        lora_baud_detect_push(rates, count, rates[i], order, &length);
+    }
+
+    return length;
+}
+
+uint32_t lora_baud_detect_timeout_ms(uint32_t baud_rate) {
+    uint32_t wire_ms = (LORA_BAUD_DETECT_FRAME_BITS * 1000 + baud_rate - 1) / baud_rate;
+    return wire_ms + LORA_BAUD_DETECT_TURNAROUND_MS;
+}
+
+uint32_t lora_baud_detect_load(Storage* storage) {
+    Stream* stream = file_stream_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    uint32_t baud_rate = 0;
+
+    if(file_stream_open(stream, LORA_BAUD_DETECT_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       stream_read_line(stream, line)) {
+        baud_rate = strtoul(furi_string_get_cstr(line), NULL, 10);
+    }
+
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_string_free(line);
+    return baud_rate;
+}
+
+bool lora_baud_detect_save(Storage* storage, uint32_t baud_rate) {
+    Stream* stream = file_stream_alloc(storage);
+    bool success = false;
+
+    storage_common_mkdir(storage, LORA_BAUD_DETECT_DIRECTORY);
+    if(file_stream_open(stream, LORA_BAUD_DETECT_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        success = stream_write_format(stream, "%lu\n", baud_rate) > 0;
+    } else {
+        FURI_LOG_W(TAG, "Failed to open %s", LORA_BAUD_DETECT_PATH);
+    }
+
+    file_stream_close(stream);
+    stream_free(stream);
+    return success;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Rate the module last answered at, a single decimal number */
+#define LORA_BAUD_DETECT_PATH "/ext/LoRa_Setting/baud_rate.txt"
+
+/** Order to probe rates in: current, then last, then the rest by how common they are
+ *
+ * @param      rates  candidate rates, every one of them ends up in order once
+ * @param      last   last rate that worked, 0 if unknown
+ * @return     number of rates written to order
+ */
+size_t lora_baud_detect_order(
+    const uint32_t* rates,
+    size_t count,
+    uint32_t current,
+    uint32_t last,
+    uint32_t* order);
+
+/** Wait for a C1 00 08 reply at baud_rate, both frames on the wire plus module turnaround */
+uint32_t lora_baud_detect_timeout_ms(uint32_t baud_rate);
+
+/** Last working rate stored on SD, 0 if none */
+uint32_t lora_baud_detect_load(Storage* storage);
+
+bool lora_baud_detect_save(Storage* storage, uint32_t baud_rate);
+
+#ifdef __cplusplus
+}
+#endif
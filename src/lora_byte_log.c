@@ -0,0 +1,101 @@
+#include "lora_byte_log.h"
+#include <string.h>
+
+#define LORA_BYTE_LOG_MASK (LORA_BYTE_LOG_SIZE - 1)
+#define LORA_BYTE_LOG_MARK_MASK (LORA_BYTE_LOG_MARKS - 1)
+
+_Static_assert(
+    (LORA_BYTE_LOG_SIZE & LORA_BYTE_LOG_MASK) == 0,
+    "LORA_BYTE_LOG_SIZE must be a power of two");
+_Static_assert(
+    (LORA_BYTE_LOG_MARKS & LORA_BYTE_LOG_MARK_MASK) == 0,
+    "LORA_BYTE_LOG_MARKS must be a power of two");
+
+void lora_byte_log_reset(LoraByteLog* log) {
+    log->end = 0;
+    log->mark_count = 0;
+}
+
+void lora_byte_log_append(LoraByteLog* log, const uint8_t* data, size_t length) {
+    if(length > LORA_BYTE_LOG_SIZE) {
+        // Only the tail can be held anyway
+        log->end += length - LORA_BYTE_LOG_SIZE;
+        data += length - LORA_BYTE_LOG_SIZE;
+        length = LORA_BYTE_LOG_SIZE;
+    }
+
+    size_t offset = log->end & LORA_BYTE_LOG_MASK;
+    size_t first = LORA_BYTE_LOG_SIZE - offset;
+    if(first > length) {
+        first = length;
+    }
+    memcpy(&log->data[offset], data, first);
+    memcpy(log->data, data + first, length - first);
+    log->end += length;
+}
+
+void lora_byte_log_mark_packet(LoraByteLog* log) {
+    if(log->mark_count > 0 &&
+       log->marks[(log->mark_count - 1) & LORA_BYTE_LOG_MARK_MASK] == log->end) {
+        return;
+    }
+    log->marks[log->mark_count & LORA_BYTE_LOG_MARK_MASK] = log->end;
+    log->mark_count++;
+}
+
+uint32_t lora_byte_log_begin(const LoraByteLog* log) {
+    return log->end > LORA_BYTE_LOG_SIZE ? log->end - LORA_BYTE_LOG_SIZE : 0;
+}
+
+uint32_t lora_byte_log_end(const LoraByteLog* log) {
+    return log->end;
+}
+
+size_t lora_byte_log_read(const LoraByteLog* log, uint32_t offset, uint8_t* out, size_t length) {
+    uint32_t begin = lora_byte_log_begin(log);
+    if(offset < begin || offset >= log->end) {
+        return 0;
+    }
+    if(length > log->end - offset) {
+        length = log->end - offset;
+    }
+
+    size_t index = offset & LORA_BYTE_LOG_MASK;
+    size_t first = LORA_BYTE_LOG_SIZE - index;
+    if(first > length) {
+        first = length;
+    }
+    memcpy(out, &log->data[index], first);
+    memcpy(out + first, log->data, length - first);
+    return length;
+}
+
+bool lora_byte_log_find_packet(
+    const LoraByteLog* log,
+    uint32_t offset,
+    size_t length,
+    uint32_t* start) {
+    uint32_t held = log->mark_count < LORA_BYTE_LOG_MARKS ? log->mark_count : LORA_BYTE_LOG_MARKS;
+    uint32_t first = log->mark_count - held;
+
+    // Marks are increasing, binary search for the first one >= offset
+    uint32_t low = first;
+    uint32_t high = log->mark_count;
+    while(low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if(log->marks[mid & LORA_BYTE_LOG_MARK_MASK] < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if(low < log->mark_count) {
+        uint32_t mark = log->marks[low & LORA_BYTE_LOG_MARK_MASK];
+        if(mark - offset < length) {
+            *start = mark;
+            return true;
+        }
+    }
+    return false;
+}
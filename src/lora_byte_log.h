@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bytes of history kept, must be a power of two */
+#define LORA_BYTE_LOG_SIZE 4096
+/** Packet start offsets kept, must be a power of two */
+#define LORA_BYTE_LOG_MARKS 64
+
+/** Circular history of received bytes addressed by absolute stream offset.
+ *
+ * Offsets keep counting up as data arrives; the log holds the last
+ * LORA_BYTE_LOG_SIZE bytes, so readers can pin an offset range (for example
+ * a frozen view) without copying anything and simply find it evicted later.
+ */
+typedef struct {
+    uint8_t data[LORA_BYTE_LOG_SIZE];
+    uint32_t end;
+    uint32_t marks[LORA_BYTE_LOG_MARKS];
+    uint32_t mark_count;
+} LoraByteLog;
+
+void lora_byte_log_reset(LoraByteLog* log);
+
+/** Append bytes at the end of the stream */
+void lora_byte_log_append(LoraByteLog* log, const uint8_t* data, size_t length);
+
+/** Record the current end offset as the start of a packet */
+void lora_byte_log_mark_packet(LoraByteLog* log);
+
+/** Oldest offset still held */
+uint32_t lora_byte_log_begin(const LoraByteLog* log);
+
+/** Offset one past the newest byte */
+uint32_t lora_byte_log_end(const LoraByteLog* log);
+
+/** Copy bytes [offset, offset + length) that are still held
+ *
+ * @return     number of bytes copied, 0 if offset was evicted or not yet written
+ */
+size_t lora_byte_log_read(const LoraByteLog* log, uint32_t offset, uint8_t* out, size_t length);
+
+/** Whether a packet starts within [offset, offset + length)
+ *
+ * @param      start  receives the first packet start offset in range
+ */
+bool lora_byte_log_find_packet(
+    const LoraByteLog* log,
+    uint32_t offset,
+    size_t length,
+    uint32_t* start);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,212 @@
+#include "lora_capture.h"
+
+#include <furi_hal_rtc.h>
+#include <toolbox/stream/file_stream.h>
+
+#define TAG "LoRaCapture"
+
+#define LORA_CAPTURE_BUFFER_SIZE 2048
+#define LORA_CAPTURE_HEADER_SIZE 16
+#define LORA_CAPTURE_RECORD_HEADER_SIZE 8
+#define LORA_CAPTURE_FLAG_RSSI (1 << 0)
+
+typedef enum {
+    CaptureEventFlush = (1 << 0),
+    CaptureEventStop = (1 << 1),
+} CaptureEvent;
+
+struct LoraCapture {
+    Stream* stream;
+    FuriString* path;
+    FuriThread* writer;
+
+    uint8_t buffers[2][LORA_CAPTURE_BUFFER_SIZE];
+    size_t fill[2];
+    bool busy[2];
+    uint8_t active;
+
+    uint32_t start_tick;
+    uint32_t records;
+    uint32_t dropped;
+    uint32_t bytes_written;
+    uint32_t write_ms;
+};
+
+static void lora_capture_put_u16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void lora_capture_put_u32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+static void lora_capture_flush_buffer(LoraCapture* capture, uint8_t index) {
+    uint32_t start = furi_get_tick();
+    size_t written = stream_write(capture->stream, capture->buffers[index], capture->fill[index]);
+    uint32_t duration = furi_get_tick() - start;
+
+    if(written != capture->fill[index]) {
+        FURI_LOG_E(TAG, "Short write: %zu of %zu bytes", written, capture->fill[index]);
+    }
+
+    __atomic_add_fetch(&capture->bytes_written, written, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&capture->write_ms, duration, __ATOMIC_RELAXED);
+    capture->fill[index] = 0;
+    __atomic_store_n(&capture->busy[index], false, __ATOMIC_RELEASE);
+}
+
+static int32_t lora_capture_writer(void* context) {
+    LoraCapture* capture = context;
+
+    while(1) {
+        uint32_t events = furi_thread_flags_wait(
+            CaptureEventFlush | CaptureEventStop, FuriFlagWaitAny, FuriWaitForever);
+        if(events & FuriFlagError) {
+            break;
+        }
+
+        for(uint8_t i = 0; i < 2; i++) {
+            if(__atomic_load_n(&capture->busy[i], __ATOMIC_ACQUIRE)) {
+                lora_capture_flush_buffer(capture, i);
+            }
+        }
+
+        if(events & CaptureEventStop) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+// Producer side: hand the active buffer to the writer and switch to the other one
+static bool lora_capture_swap(LoraCapture* capture) {
+    uint8_t next = capture->active ^ 1;
+    if(__atomic_load_n(&capture->busy[next], __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    __atomic_store_n(&capture->busy[capture->active], true, __ATOMIC_RELEASE);
+    furi_thread_flags_set(furi_thread_get_id(capture->writer), CaptureEventFlush);
+    capture->active = next;
+    return true;
+}
+
+LoraCapture* lora_capture_alloc(Storage* storage, uint32_t baud_rate) {
+    LoraCapture* capture = malloc(sizeof(LoraCapture));
+    memset(capture, 0, sizeof(LoraCapture));
+
+    storage_simply_mkdir(storage, LORA_CAPTURE_DIRECTORY);
+
+    DateTime datetime;
+    furi_hal_rtc_get_datetime(&datetime);
+    capture->path = furi_string_alloc_printf(
+        "%s/cap_%04u%02u%02u_%02u%02u%02u%s",
+        LORA_CAPTURE_DIRECTORY,
+        datetime.year,
+        datetime.month,
+        datetime.day,
+        datetime.hour,
+        datetime.minute,
+        datetime.second,
+        LORA_CAPTURE_EXTENSION);
+
+    capture->stream = file_stream_alloc(storage);
+    if(!file_stream_open(
+           capture->stream,
+           furi_string_get_cstr(capture->path),
+           FSAM_WRITE,
+           FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_E(TAG, "Failed to open %s", furi_string_get_cstr(capture->path));
+        stream_free(capture->stream);
+        furi_string_free(capture->path);
+        free(capture);
+        return NULL;
+    }
+
+    capture->start_tick = furi_get_tick();
+
+    uint8_t header[LORA_CAPTURE_HEADER_SIZE] = {'E', 'C', 'A', 'P', 1, 0, 0, 0};
+    lora_capture_put_u32(&header[8], baud_rate);
+    lora_capture_put_u32(&header[12], capture->start_tick);
+    memcpy(capture->buffers[0], header, sizeof(header));
+    capture->fill[0] = sizeof(header);
+
+    capture->writer = furi_thread_alloc_ex("LoRaCaptureWriter", 2048, lora_capture_writer, capture);
+    furi_thread_set_priority(capture->writer, FuriThreadPriorityLow);
+    furi_thread_start(capture->writer);
+
+    FURI_LOG_I(TAG, "Capturing to %s", furi_string_get_cstr(capture->path));
+    return capture;
+}
+
+void lora_capture_free(LoraCapture* capture) {
+    furi_assert(capture);
+
+    // Hand over the partial buffer if the writer has room for it; the stop
+    // event makes the writer flush everything that is busy before exiting
+    if(capture->fill[capture->active] > 0) {
+        if(!lora_capture_swap(capture)) {
+            furi_thread_flags_set(furi_thread_get_id(capture->writer), CaptureEventStop);
+            furi_thread_join(capture->writer);
+            furi_thread_free(capture->writer);
+            capture->writer = NULL;
+            lora_capture_flush_buffer(capture, capture->active);
+        }
+    }
+
+    if(capture->writer) {
+        furi_thread_flags_set(furi_thread_get_id(capture->writer), CaptureEventStop);
+        furi_thread_join(capture->writer);
+        furi_thread_free(capture->writer);
+    }
+
+    FURI_LOG_I(
+        TAG,
+        "Capture closed: %lu records, %lu dropped, %lu bytes",
+        capture->records,
+        capture->dropped,
+        capture->bytes_written);
+
+    file_stream_close(capture->stream);
+    stream_free(capture->stream);
+    furi_string_free(capture->path);
+    free(capture);
+}
+
+bool lora_capture_write(LoraCapture* capture, const LoraRxPacket* packet) {
+    size_t record_size = LORA_CAPTURE_RECORD_HEADER_SIZE + packet->length;
+
+    if(capture->fill[capture->active] + record_size > LORA_CAPTURE_BUFFER_SIZE &&
+       !lora_capture_swap(capture)) {
+        __atomic_add_fetch(&capture->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    uint8_t* out = &capture->buffers[capture->active][capture->fill[capture->active]];
+    lora_capture_put_u32(&out[0], packet->start_tick);
+    lora_capture_put_u16(&out[4], packet->length);
+    out[6] = packet->rssi;
+    out[7] = packet->has_rssi ? LORA_CAPTURE_FLAG_RSSI : 0;
+    memcpy(&out[LORA_CAPTURE_RECORD_HEADER_SIZE], packet->data, packet->length);
+    capture->fill[capture->active] += record_size;
+
+    __atomic_add_fetch(&capture->records, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+void lora_capture_get_stats(LoraCapture* capture, LoraCaptureStats* stats) {
+    stats->records = __atomic_load_n(&capture->records, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&capture->dropped, __ATOMIC_RELAXED);
+    stats->bytes_written = __atomic_load_n(&capture->bytes_written, __ATOMIC_RELAXED);
+    stats->write_ms = __atomic_load_n(&capture->write_ms, __ATOMIC_RELAXED);
+    stats->elapsed_ms = furi_get_tick() - capture->start_tick;
+}
+
+const char* lora_capture_get_path(LoraCapture* capture) {
+    return furi_string_get_cstr(capture->path);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <furi.h>
+#include <storage/storage.h>
+#include "lora_rx_framer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LORA_CAPTURE_DIRECTORY "/ext/LoRa_Setting/captures"
+#define LORA_CAPTURE_EXTENSION ".bin"
+
+/** Streams received packets to a binary file on SD.
+ *
+ * File layout, all integers little-endian:
+ *   header  "ECAP", u8 version, u8 reserved, u16 reserved, u32 baud rate, u32 start tick
+ *   record  u32 start tick, u16 length, u8 rssi, u8 flags (bit 0: rssi valid), length bytes
+ *
+ * Records are packed into one of two RAM buffers while a low-priority writer
+ * thread flushes the other, so the caller never waits for the SD card. If
+ * both buffers are busy the record is dropped and counted.
+ */
+typedef struct LoraCapture LoraCapture;
+
+typedef struct {
+    uint32_t records;
+    uint32_t dropped;
+    uint32_t bytes_written;
+    uint32_t write_ms;
+    uint32_t elapsed_ms;
+} LoraCaptureStats;
+
+/** Create the capture file and start the writer thread
+ *
+ * @return     NULL if the file could not be created
+ */
+LoraCapture* lora_capture_alloc(Storage* storage, uint32_t baud_rate);
+
+/** Flush what is buffered, stop the writer and close the file */
+void lora_capture_free(LoraCapture* capture);
+
+/** Queue one packet record, never blocks
+ *
+ * @return     false if the record was dropped
+ */
+bool lora_capture_write(LoraCapture* capture, const LoraRxPacket* packet);
+
+/** Snapshot of the counters, safe from any thread */
+void lora_capture_get_stats(LoraCapture* capture, LoraCaptureStats* stats);
+
+/** Path of the capture file */
+const char* lora_capture_get_path(LoraCapture* capture);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,114 +2,254 @@
 // *However, it has not been tried yet.*
 
 #include "lora_config_binary_convert.h"
+#include "lora_hex_format.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
-static uint8_t get_uart_baud_rate_bits(uint32_t baud_rate) {
-    switch(baud_rate) {
-    case 1200:
-        return 0b000;
-    case 2400:
-        return 0b001;
-    case 4800:
-        return 0b010;
-    case 9600:
-        return 0b011;
-    case 19200:
-        return 0b100;
-    case 38400:
-        return 0b101;
-    case 57600:
-        return 0b110;
-    case 115200:
-        return 0b111;
+/* REG0 air data rate code is (sf - 5) * 4 + bw bits (125/250/500 kHz = 0/1/2) */
+const LoraAirDataRate lora_air_data_rates[] = {
+    {0x00, 125, 5, "15.6k, SF:5,125kHz"},
+    {0x04, 125, 6, "9.37k, SF:6,125kHz"},
+    {0x08, 125, 7, "5.47k, SF:7,125kHz"},
+    {0x0C, 125, 8, "3.12k, SF:8,125kHz"},
+    {0x10, 125, 9, "1.76k, SF:9,125kHz"},
+    {0x01, 250, 5, "31.25k, SF:5,250kHz"},
+    {0x05, 250, 6, "18.8k, SF:6,250kHz"},
+    {0x09, 250, 7, "11k, SF:7,250kHz"},
+    {0x0D, 250, 8, "6.25k, SF:8,250kHz"},
+    {0x11, 250, 9, "3.51k, SF:9,250kHz"},
+    {0x15, 250, 10, "1.95k, SF:10,250kHz"},
+    {0x02, 500, 5, "62.5k, SF:5,500kHz"},
+    {0x06, 500, 6, "37.5k, SF:6,500kHz"},
+    {0x0A, 500, 7, "21.9k, SF:7,500kHz"},
+    {0x0E, 500, 8, "12.5k, SF:8,500kHz"},
+    {0x12, 500, 9, "7.03k, SF:9,500kHz"},
+    {0x16, 500, 10, "3.9k, SF:10,500kHz"},
+    {0x1A, 500, 11, "2.14k, SF:11,500kHz"},
+};
+const size_t lora_air_data_rate_count =
+    sizeof(lora_air_data_rates) / sizeof(lora_air_data_rates[0]);
+
+const uint32_t lora_config_uart_rates[8] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200};
+const uint32_t lora_config_subpacket_sizes[4] = {200, 128, 64, 32};
+const uint32_t lora_config_tx_powers[4] = {22, 17, 13, 0};
+const uint32_t lora_config_wor_cycles[8] = {500, 1000, 1500, 2000, 2500, 3000, 3500, 4000};
+
+#define LORA_AIR_DATA_RATE_MASK 0x1F
+#define LORA_AIR_DATA_RATE_DEFAULT 0x08 // SF7 BW125
+
+/** How a value missing from a field's table is encoded */
+typedef enum {
+    /** The field's default code */
+    LoraConfigRoundNone,
+    /** Smallest entry at or above the value, the largest entry above all of them */
+    LoraConfigRoundUp,
+    /** Largest entry at or below the value, the smallest entry below all of them */
+    LoraConfigRoundDown,
+} LoraConfigRound;
+
+/** A bit field within one register, mapped to a LoRaConfig member */
+typedef struct {
+    uint8_t reg;
+    uint8_t shift;
+    uint8_t mask;
+    /** Value per register code, NULL when the field holds the value itself */
+    const uint32_t* values;
+    uint8_t default_code;
+    LoraConfigRound round;
+    size_t offset;
+    size_t size;
+} LoraConfigField;
+
+#define LORA_CONFIG_FIELD(reg, shift, mask, values, default_code, round, member) \
+    {reg,                                                                        \
+     shift,                                                                      \
+     mask,                                                                       \
+     values,                                                                     \
+     default_code,                                                               \
+     round,                                                                      \
+     offsetof(LoRaConfig, member),                                               \
+     sizeof(((LoRaConfig*)0)->member)}
+
+/* Rounding is the one the hex string encoder always applied, so .ini files
+ * with in-between sub-packet sizes or WOR cycles keep loading as they did */
+static const LoraConfigField lora_config_fields[] = {
+    LORA_CONFIG_FIELD(
+        LoraReg0, 5, 0x07, lora_config_uart_rates, 3, LoraConfigRoundNone, baud_rate),
+    LORA_CONFIG_FIELD(
+        LoraReg1, 6, 0x03, lora_config_subpacket_sizes, 0, LoraConfigRoundUp, subpacket_size),
+    LORA_CONFIG_FIELD(LoraReg1, 5, 0x01, NULL, 0, LoraConfigRoundNone, rssi_ambient_noise_flag),
+    LORA_CONFIG_FIELD(
+        LoraReg1, 0, 0x03, lora_config_tx_powers, 2, LoraConfigRoundNone, transmitting_power),
+    LORA_CONFIG_FIELD(LoraReg2, 0, 0xFF, NULL, 0, LoraConfigRoundNone, own_channel),
+    LORA_CONFIG_FIELD(LoraReg3, 7, 0x01, NULL, 0, LoraConfigRoundNone, rssi_byte_flag),
+    LORA_CONFIG_FIELD(LoraReg3, 6, 0x01, NULL, 0, LoraConfigRoundNone, transmission_method_type),
+    LORA_CONFIG_FIELD(
+        LoraReg3, 0, 0x07, lora_config_wor_cycles, 0, LoraConfigRoundDown, wor_cycle),
+};
+
+static uint32_t field_load(const LoRaConfig* config, const LoraConfigField* field) {
+    const uint8_t* member = (const uint8_t*)config + field->offset;
+    switch(field->size) {
+    case sizeof(uint8_t):
+        return *member;
+    case sizeof(uint16_t): {
+        uint16_t value;
+        memcpy(&value, member, sizeof(value));
+        return value;
+    }
+    default: {
+        uint32_t value;
+        memcpy(&value, member, sizeof(value));
+        return value;
+    }
+    }
+}
+
+static void member_store(LoRaConfig* config, size_t offset, size_t size, uint32_t value) {
+    uint8_t* member = (uint8_t*)config + offset;
+    switch(size) {
+    case sizeof(uint8_t):
+        *member = value;
+        break;
+    case sizeof(uint16_t): {
+        uint16_t narrow = value;
+        memcpy(member, &narrow, sizeof(narrow));
+        break;
+    }
     default:
-        return 0b011; //  9600bps
-    }
-}
-
-static uint8_t get_air_data_rate_bits(uint16_t bw, uint8_t sf) {
-    if(bw == 125) {
-        switch(sf) {
-        case 5:
-            return 0b00000;
-        case 6:
-            return 0b00100;
-        case 7:
-            return 0b01000;
-        case 8:
-            return 0b01100;
-        case 9:
-            return 0b10000;
-        default:
-            return 0b01000; //  SF7
+        memcpy(member, &value, sizeof(value));
+        break;
+    }
+}
+
+static void field_store(LoRaConfig* config, const LoraConfigField* field, uint32_t value) {
+    member_store(config, field->offset, field->size, value);
+}
+
+static uint8_t field_encode(const LoraConfigField* field, uint32_t value) {
+    if(!field->values) {
+        // Out-of-range raw values must not spill into neighbouring fields
+        return value <= field->mask ? value : field->default_code;
+    }
+    if(field->round == LoraConfigRoundNone) {
+        for(uint8_t code = 0; code <= field->mask; code++) {
+            if(field->values[code] == value) {
+                return code;
+            }
         }
-    } else if(bw == 250) {
-        switch(sf) {
-        case 5:
-            return 0b00001;
-        case 6:
-            return 0b00101;
-        case 7:
-            return 0b01001;
-        case 8:
-            return 0b01101;
-        case 9:
-            return 0b10001;
-        case 10:
-            return 0b10101;
-        default:
-            return 0b01001; //  SF7
+        return field->default_code;
+    }
+
+    // Tables aren't all in the same order, so every entry is looked at
+    bool up = field->round == LoraConfigRoundUp;
+    int best = -1;
+    int extreme = 0;
+    for(uint8_t code = 0; code <= field->mask; code++) {
+        uint32_t entry = field->values[code];
+        bool fits = up ? entry >= value : entry <= value;
+        bool closer = best < 0 || (up ? entry < field->values[best] : entry > field->values[best]);
+        if(fits && closer) {
+            best = code;
         }
-    } else if(bw == 500) {
-        switch(sf) {
-        case 5:
-            return 0b00010;
-        case 6:
-            return 0b00110;
-        case 7:
-            return 0b01010;
-        case 8:
-            return 0b01110;
-        case 9:
-            return 0b10010;
-        case 10:
-            return 0b10110;
-        case 11:
-            return 0b11010;
-        default:
-            return 0b01010; //  SF7
+        if(up ? entry > field->values[extreme] : entry < field->values[extreme]) {
+            extreme = code;
         }
     }
-    return 0b01000; //  BW125 SF7
+    return best < 0 ? extreme : best;
 }
 
-static uint8_t get_subpacket_size_bits(uint16_t subpacket_size) {
-    if(subpacket_size <= 32) return 0b11;
-    if(subpacket_size <= 64) return 0b10;
-    if(subpacket_size <= 128) return 0b01;
-    return 0b00; // 200 bytes
+#define LORA_CONFIG_FIELD_COUNT (sizeof(lora_config_fields) / sizeof(lora_config_fields[0]))
+
+int lora_air_data_rate_index(uint8_t code) {
+    for(size_t i = 0; i < lora_air_data_rate_count; i++) {
+        if(lora_air_data_rates[i].code == code) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-static uint8_t get_transmitting_power_bits(uint8_t transmitting_power) {
-    switch(transmitting_power) {
-    case 22:
-        return 0b00;
-    case 17:
-        return 0b01;
-    case 13:
-        return 0b10;
-    case 0:
-        return 0b11;
+int lora_air_data_rate_find(uint16_t bw, uint8_t sf) {
+    for(size_t i = 0; i < lora_air_data_rate_count; i++) {
+        if(lora_air_data_rates[i].bw == bw && lora_air_data_rates[i].sf == sf) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Channels are 200 kHz apart from a base that moves up with the bandwidth,
+ * the highest one is the last whose full bandwidth stays below 928.1 MHz */
+uint8_t lora_config_max_channel(uint8_t bw_bits) {
+    switch(bw_bits) {
+    case 0: // BW125kHz
+        return 37;
+    case 1: // BW250kHz
+        return 36;
+    case 2: // BW500kHz
+        return 30;
     default:
-        return 0b10; //  13dBm
+        return 0;
+    }
+}
+
+uint32_t lora_config_channel_khz(uint8_t channel, uint8_t bw_bits) {
+    if(bw_bits > 2) {
+        return 0;
+    }
+    return 920600 + bw_bits * 100 + channel * 200;
+}
+
+void lora_config_set_defaults(LoRaConfig* config) {
+    uint8_t registers[LORA_CONFIG_REG_COUNT] = {0};
+
+    registers[LoraReg0] = LORA_AIR_DATA_RATE_DEFAULT;
+    for(size_t i = 0; i < LORA_CONFIG_FIELD_COUNT; i++) {
+        const LoraConfigField* field = &lora_config_fields[i];
+        registers[field->reg] |= field->default_code << field->shift;
     }
+    lora_config_decode(registers, config);
 }
 
-static uint8_t get_wor_cycle_bits(uint16_t wor_cycle) {
-    if(wor_cycle <= 500) return 0;
-    if(wor_cycle >= 4000) return 7;
-    return ((wor_cycle - 500) / 500);
+void lora_config_decode(const uint8_t* registers, LoRaConfig* config) {
+    memset(config, 0, sizeof(LoRaConfig));
+
+    config->own_address = (registers[LoraRegAddH] << 8) | registers[LoraRegAddL];
+    config->encryption_key = (registers[LoraRegCryptH] << 8) | registers[LoraRegCryptL];
+
+    for(size_t i = 0; i < LORA_CONFIG_FIELD_COUNT; i++) {
+        const LoraConfigField* field = &lora_config_fields[i];
+        uint8_t code = (registers[field->reg] >> field->shift) & field->mask;
+        field_store(config, field, field->values ? field->values[code] : code);
+    }
+
+    // Reserved codes read back as the default rather than a made-up pair
+    int index = lora_air_data_rate_index(registers[LoraReg0] & LORA_AIR_DATA_RATE_MASK);
+    if(index < 0) {
+        index = lora_air_data_rate_index(LORA_AIR_DATA_RATE_DEFAULT);
+    }
+    config->bw = lora_air_data_rates[index].bw;
+    config->sf = lora_air_data_rates[index].sf;
+}
+
+void lora_config_encode(const LoRaConfig* config, uint8_t* registers) {
+    memset(registers, 0, LORA_CONFIG_REG_COUNT);
+
+    registers[LoraRegAddH] = config->own_address >> 8;
+    registers[LoraRegAddL] = config->own_address & 0xFF;
+    registers[LoraRegCryptH] = config->encryption_key >> 8;
+    registers[LoraRegCryptL] = config->encryption_key & 0xFF;
+
+    for(size_t i = 0; i < LORA_CONFIG_FIELD_COUNT; i++) {
+        const LoraConfigField* field = &lora_config_fields[i];
+        registers[field->reg] |= field_encode(field, field_load(config, field)) << field->shift;
+    }
+
+    int index = lora_air_data_rate_find(config->bw, config->sf);
+    registers[LoraReg0] |= index < 0 ? LORA_AIR_DATA_RATE_DEFAULT :
+                                       lora_air_data_rates[index].code;
 }
 
 bool lora_config_to_hex_string(const LoRaConfig* config, char* hex_string, size_t hex_string_size) {
@@ -117,31 +257,102 @@ bool lora_config_to_hex_string(const LoRaConfig* config, char* hex_string, size_
         return false;
     }
 
-    uint8_t uart_baud_rate_bits = get_uart_baud_rate_bits(config->baud_rate);
-    uint8_t air_data_rate_bits = get_air_data_rate_bits(config->bw, config->sf);
-    uint8_t subpacket_size_bits = get_subpacket_size_bits(config->subpacket_size);
-    uint8_t transmitting_power_bits = get_transmitting_power_bits(config->transmitting_power);
-    uint8_t wor_cycle_bits = get_wor_cycle_bits(config->wor_cycle);
-
-    uint8_t reg0 = (uart_baud_rate_bits << 5) | air_data_rate_bits;
-    uint8_t reg1 = (subpacket_size_bits << 6) | (config->rssi_ambient_noise_flag << 5) |
-                   transmitting_power_bits;
-    uint8_t reg2 = config->own_channel;
-    uint8_t reg3 = (config->rssi_byte_flag << 7) | (config->transmission_method_type << 6) |
-                   wor_cycle_bits;
-
-    snprintf(
-        hex_string,
-        hex_string_size,
-        "C0 00 08 %02X %02X %02X %02X %02X %02X %02X %02X",
-        (uint8_t)(config->own_address >> 8),
-        (uint8_t)(config->own_address & 0xFF),
-        reg0,
-        reg1,
-        reg2,
-        reg3,
-        (uint8_t)(config->encryption_key >> 8),
-        (uint8_t)(config->encryption_key & 0xFF));
+    uint8_t command[3 + LORA_CONFIG_REG_COUNT] = {0xC0, 0x00, LORA_CONFIG_REG_COUNT};
+    lora_config_encode(config, &command[3]);
+
+    // Space after every byte but the last
+    size_t written =
+        lora_hex_format(command, sizeof(command) - 1, ' ', hex_string, hex_string_size);
+    lora_hex_format(
+        &command[sizeof(command) - 1], 1, '\0', hex_string + written, hex_string_size - written);
 
     return true;
 }
+
+/* Rewriting an unchanged register costs a byte out and a byte of echo, a
+ * separate write costs a 3 byte header each way */
+#define LORA_CONFIG_MERGE_GAP 3
+
+size_t lora_config_diff(
+    const uint8_t* current,
+    const uint8_t* target,
+    LoraRegisterRange ranges[LORA_CONFIG_MAX_RANGES]) {
+    size_t count = 0;
+
+    for(uint8_t reg = 0; reg < LORA_CONFIG_REG_COUNT; reg++) {
+        if(current[reg] == target[reg]) {
+            continue;
+        }
+        LoraRegisterRange* last = count ? &ranges[count - 1] : NULL;
+        if(last && reg - (last->address + last->length) <= LORA_CONFIG_MERGE_GAP) {
+            last->length = reg - last->address + 1;
+        } else {
+            ranges[count].address = reg;
+            ranges[count].length = 1;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/** A key of the exported .ini file, mapped to a LoRaConfig member */
+typedef struct {
+    const char* key;
+    size_t offset;
+    size_t size;
+} LoraConfigIniKey;
+
+#define LORA_CONFIG_INI_KEY(member) \
+    {#member "=", offsetof(LoRaConfig, member), sizeof(((LoRaConfig*)0)->member)}
+
+static const LoraConfigIniKey lora_config_ini_keys[] = {
+    LORA_CONFIG_INI_KEY(own_address),
+    LORA_CONFIG_INI_KEY(baud_rate),
+    LORA_CONFIG_INI_KEY(bw),
+    LORA_CONFIG_INI_KEY(sf),
+    LORA_CONFIG_INI_KEY(subpacket_size),
+    LORA_CONFIG_INI_KEY(rssi_ambient_noise_flag),
+    LORA_CONFIG_INI_KEY(transmitting_power),
+    LORA_CONFIG_INI_KEY(own_channel),
+    LORA_CONFIG_INI_KEY(rssi_byte_flag),
+    LORA_CONFIG_INI_KEY(transmission_method_type),
+    LORA_CONFIG_INI_KEY(wor_cycle),
+    LORA_CONFIG_INI_KEY(encryption_key),
+};
+
+#define LORA_CONFIG_INI_KEY_COUNT (sizeof(lora_config_ini_keys) / sizeof(lora_config_ini_keys[0]))
+#define LORA_CONFIG_INI_VERSION_KEY "config_version="
+
+void lora_config_ini_init(LoraConfigIniParser* parser) {
+    lora_config_set_defaults(&parser->config);
+    // Files from before the version key count as version 1
+    parser->version = 1;
+}
+
+bool lora_config_ini_parse_line(LoraConfigIniParser* parser, const char* line) {
+    size_t length = strlen(LORA_CONFIG_INI_VERSION_KEY);
+    if(strncmp(line, LORA_CONFIG_INI_VERSION_KEY, length) == 0) {
+        parser->version = atoi(line + length);
+        return true;
+    }
+
+    for(size_t i = 0; i < LORA_CONFIG_INI_KEY_COUNT; i++) {
+        const LoraConfigIniKey* key = &lora_config_ini_keys[i];
+        length = strlen(key->key);
+        if(strncmp(line, key->key, length) == 0) {
+            member_store(&parser->config, key->offset, key->size, atoi(line + length));
+            return true;
+        }
+    }
+    return false;
+}
+
+void lora_config_ini_finish(LoraConfigIniParser* parser, LoRaConfig* config) {
+    // Older exports wrote 1 for Transparent and 2 for Fixed
+    if(parser->version < LORA_CONFIG_FILE_VERSION &&
+       parser->config.transmission_method_type > 0) {
+        parser->config.transmission_method_type--;
+    }
+    *config = parser->config;
+}
@@ -8,6 +8,24 @@
 extern "C" {
 #endif
 
+/** Written to exported .ini files. Files without it come from exports that
+ * stored transmission_method_type one too high. */
+#define LORA_CONFIG_FILE_VERSION 2
+
+/** Registers read by C1 00 08 and written by C0 00 08 */
+#define LORA_CONFIG_REG_COUNT 8
+
+typedef enum {
+    LoraRegAddH,
+    LoraRegAddL,
+    LoraReg0,
+    LoraReg1,
+    LoraReg2,
+    LoraReg3,
+    LoraRegCryptH,
+    LoraRegCryptL,
+} LoraRegister;
+
 typedef struct {
     uint16_t own_address;
     uint32_t baud_rate;
@@ -23,8 +41,88 @@ typedef struct {
     uint16_t encryption_key;
 } LoRaConfig;
 
+/** One valid REG0 air data rate setting */
+typedef struct {
+    uint8_t code;
+    uint16_t bw;
+    uint8_t sf;
+    const char* name;
+} LoraAirDataRate;
+
+/** Valid air data rates, grouped by bandwidth then spreading factor */
+extern const LoraAirDataRate lora_air_data_rates[];
+extern const size_t lora_air_data_rate_count;
+
+/** Field values indexed by their register bits */
+extern const uint32_t lora_config_uart_rates[8];
+extern const uint32_t lora_config_subpacket_sizes[4];
+extern const uint32_t lora_config_tx_powers[4];
+extern const uint32_t lora_config_wor_cycles[8];
+
+/** Values used where a setting is missing or not encodable */
+void lora_config_set_defaults(LoRaConfig* config);
+
+/** Decode REG0-REG7 as laid out from address 0x00 */
+void lora_config_decode(const uint8_t* registers, LoRaConfig* config);
+
+/** Encode config into REG0-REG7, falling back to defaults for values the module can't take */
+void lora_config_encode(const LoRaConfig* config, uint8_t* registers);
+
+/** Index into lora_air_data_rates of a REG0 air data rate code, -1 if reserved */
+int lora_air_data_rate_index(uint8_t code);
+
+/** Index into lora_air_data_rates of a bandwidth/spreading factor pair, -1 if invalid */
+int lora_air_data_rate_find(uint16_t bw, uint8_t sf);
+
+/** Bandwidth bits of a REG0 value, 0/1/2 for 125/250/500 kHz, 3 is reserved */
+#define LORA_CONFIG_BW_BITS(reg0) ((reg0) & 0x03)
+
+/** REG1 bit enabling the ambient noise RSSI register */
+#define LORA_CONFIG_REG1_RSSI_AMBIENT (1 << 5)
+
+/** Highest REG2 channel for the bandwidth bits, 0 if they are reserved */
+uint8_t lora_config_max_channel(uint8_t bw_bits);
+
+/** Centre frequency of a channel in kHz, 0 if the bandwidth bits are reserved */
+uint32_t lora_config_channel_khz(uint8_t channel, uint8_t bw_bits);
+
+/** Registers covered by one C0 <address> <length> write */
+typedef struct {
+    uint8_t address;
+    uint8_t length;
+} LoraRegisterRange;
+
+/** Most ranges lora_config_diff can produce */
+#define LORA_CONFIG_MAX_RANGES (LORA_CONFIG_REG_COUNT / 2)
+
+/** Fewest writes turning current into target, 0 when they already match
+ *
+ * Runs separated by a few unchanged registers are merged, rewriting those
+ * registers costs less than the extra command header and echo.
+ */
+size_t lora_config_diff(
+    const uint8_t* current,
+    const uint8_t* target,
+    LoraRegisterRange ranges[LORA_CONFIG_MAX_RANGES]);
+
+/** Exported .ini file being read back, fed one line at a time */
+typedef struct {
+    LoRaConfig config;
+    int version;
+} LoraConfigIniParser;
+
+/** Start a file, keys it doesn't set keep their default */
+void lora_config_ini_init(LoraConfigIniParser* parser);
+
+/** Apply one "key=value" line, false if the line sets no known key */
+bool lora_config_ini_parse_line(LoraConfigIniParser* parser, const char* line);
+
+/** End the file and get the config, migrated from older file versions */
+void lora_config_ini_finish(LoraConfigIniParser* parser, LoRaConfig* config);
+
+/** Full C0 00 08 write command as hex, "C0 00 08 ... XX" */
 bool lora_config_to_hex_string(const LoRaConfig* config, char* hex_string, size_t hex_string_size);
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Output size needed to format length bytes with a separator, including terminator */
+#define LORA_HEX_FORMAT_SIZE(length) ((length) * 3 + 1)
+
+/** Format bytes as upper-case hex pairs, each followed by separator
+ *
+ * Pass '\0' as separator for packed output. Output is always terminated;
+ * formatting stops at the last whole byte that fits.
+ *
+ * @return     number of characters written, excluding the terminator
+ */
+size_t lora_hex_format(
+    const uint8_t* data,
+    size_t length,
+    char separator,
+    char* out,
+    size_t out_size);
+
+/** Format bytes as printable ASCII, with '.' for anything else
+ *
+ * @return     number of characters written, excluding the terminator
+ */
+size_t lora_hex_format_ascii(const uint8_t* data, size_t length, char* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,288 @@
+#include "lora_hex_view.h"
+#include "lora_hex_format.h"
+#include <gui/elements.h>
+#include <string.h>
+
+#define HEX_VIEW_BYTES_PER_ROW 4
+#define HEX_VIEW_ROWS 6
+#define HEX_VIEW_ROW_HEIGHT 9
+#define HEX_VIEW_TOP 10
+#define HEX_VIEW_CHAR_WIDTH 6
+#define HEX_VIEW_HEX_X 27
+#define HEX_VIEW_ASCII_X (HEX_VIEW_HEX_X + HEX_VIEW_BYTES_PER_ROW * 3 * HEX_VIEW_CHAR_WIDTH)
+#define HEX_VIEW_HEADER_SIZE 32
+
+struct LoraHexView {
+    View* view;
+};
+
+typedef struct {
+    const LoraByteLog* log;
+    FuriMutex* mutex;
+    char header[HEX_VIEW_HEADER_SIZE];
+    char panel[LORA_HEX_VIEW_PANEL_LINES * (LORA_HEX_VIEW_PANEL_WIDTH + 1) + 1];
+    bool show_panel;
+    bool frozen;
+    uint32_t frozen_end;
+    uint32_t scroll;
+} LoraHexViewModel;
+
+/** Number of rows above the newest one that can still be shown */
+static uint32_t lora_hex_view_max_scroll(const LoraByteLog* log, uint32_t end) {
+    uint32_t begin = lora_byte_log_begin(log);
+    if(end <= begin) {
+        return 0;
+    }
+    uint32_t rows = (end - 1) / HEX_VIEW_BYTES_PER_ROW - begin / HEX_VIEW_BYTES_PER_ROW + 1;
+    return rows > HEX_VIEW_ROWS ? rows - HEX_VIEW_ROWS : 0;
+}
+
+static void lora_hex_view_draw_row(
+    Canvas* canvas,
+    const LoraByteLog* log,
+    uint32_t offset,
+    uint32_t end,
+    uint8_t y) {
+    uint8_t bytes[HEX_VIEW_BYTES_PER_ROW];
+    char text[LORA_HEX_FORMAT_SIZE(HEX_VIEW_BYTES_PER_ROW)];
+    uint8_t baseline = y + HEX_VIEW_ROW_HEIGHT - 1;
+
+    snprintf(text, sizeof(text), "%04lX", offset & 0xFFFF);
+    canvas_draw_str(canvas, 0, baseline, text);
+
+    size_t wanted = end - offset < HEX_VIEW_BYTES_PER_ROW ? end - offset : HEX_VIEW_BYTES_PER_ROW;
+    size_t count = lora_byte_log_read(log, offset, bytes, wanted);
+    if(count == 0) {
+        // Scrolled-to history has been overwritten while held
+        canvas_draw_str(canvas, HEX_VIEW_HEX_X, baseline, "--");
+        return;
+    }
+
+    lora_hex_format(bytes, count, ' ', text, sizeof(text));
+    canvas_draw_str(canvas, HEX_VIEW_HEX_X, baseline, text);
+    lora_hex_format_ascii(bytes, count, text, sizeof(text));
+    canvas_draw_str(canvas, HEX_VIEW_ASCII_X, baseline, text);
+
+    // Tick in the gutter before the first byte of each packet
+    uint32_t start = offset;
+    while(start < offset + count &&
+          lora_byte_log_find_packet(log, start, offset + count - start, &start)) {
+        uint8_t x = HEX_VIEW_HEX_X - 2 + (start - offset) * 3 * HEX_VIEW_CHAR_WIDTH;
+        canvas_draw_line(canvas, x, y + 1, x, y + HEX_VIEW_ROW_HEIGHT - 1);
+        start++;
+    }
+}
+
+static void lora_hex_view_draw_panel(Canvas* canvas, const char* text) {
+    char line[LORA_HEX_VIEW_PANEL_WIDTH + 1];
+    uint8_t y = HEX_VIEW_TOP + HEX_VIEW_ROW_HEIGHT - 1;
+
+    for(uint8_t row = 0; row < LORA_HEX_VIEW_PANEL_LINES && *text; row++) {
+        size_t length = strcspn(text, "\n");
+        size_t copy = length < LORA_HEX_VIEW_PANEL_WIDTH ? length : LORA_HEX_VIEW_PANEL_WIDTH;
+        memcpy(line, text, copy);
+        line[copy] = '\0';
+        canvas_draw_str(canvas, 0, y, line);
+        y += HEX_VIEW_ROW_HEIGHT;
+        text += length;
+        if(*text == '\n') {
+            text++;
+        }
+    }
+}
+
+static void lora_hex_view_draw_callback(Canvas* canvas, void* _model) {
+    LoraHexViewModel* model = _model;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+    canvas_draw_str(canvas, 0, 7, model->header);
+    if(model->frozen) {
+        canvas_draw_str_aligned(canvas, 127, 0, AlignRight, AlignTop, "HOLD");
+    }
+    canvas_draw_line(canvas, 0, HEX_VIEW_TOP - 1, 127, HEX_VIEW_TOP - 1);
+
+    if(!model->log) {
+        return;
+    }
+
+    canvas_set_font(canvas, FontKeyboard);
+    if(model->show_panel) {
+        lora_hex_view_draw_panel(canvas, model->panel);
+        return;
+    }
+
+    furi_mutex_acquire(model->mutex, FuriWaitForever);
+
+    const LoraByteLog* log = model->log;
+    uint32_t end = model->frozen ? model->frozen_end : lora_byte_log_end(log);
+    if(end > 0) {
+        uint32_t max_scroll = lora_hex_view_max_scroll(log, end);
+        uint32_t scroll = model->scroll < max_scroll ? model->scroll : max_scroll;
+        uint32_t last_row = (end - 1) / HEX_VIEW_BYTES_PER_ROW - scroll;
+        uint32_t first_row = last_row >= HEX_VIEW_ROWS - 1 ? last_row - (HEX_VIEW_ROWS - 1) : 0;
+        uint32_t first_held = lora_byte_log_begin(log) / HEX_VIEW_BYTES_PER_ROW;
+        if(first_row < first_held) {
+            first_row = first_held;
+        }
+
+        for(uint32_t row = first_row; row <= last_row; row++) {
+            lora_hex_view_draw_row(
+                canvas,
+                log,
+                row * HEX_VIEW_BYTES_PER_ROW,
+                end,
+                HEX_VIEW_TOP + (row - first_row) * HEX_VIEW_ROW_HEIGHT);
+        }
+    }
+
+    furi_mutex_release(model->mutex);
+}
+
+static bool lora_hex_view_input_callback(InputEvent* event, void* context) {
+    LoraHexView* hex_view = context;
+    bool consumed = false;
+
+    if(event->type == InputTypeLong && event->key == InputKeyOk) {
+        with_view_model(
+            hex_view->view,
+            LoraHexViewModel * model,
+            { model->show_panel = !model->show_panel; },
+            true);
+        return true;
+    }
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+
+    with_view_model(
+        hex_view->view,
+        LoraHexViewModel * model,
+        {
+            if(model->show_panel) {
+                // Keys other than Back do nothing over the panel
+                consumed = event->key != InputKeyBack;
+            } else if(model->log) {
+                switch(event->key) {
+                case InputKeyUp:
+                case InputKeyLeft: {
+                    // Scrolling away from the tail holds it so rows don't slide underneath
+                    if(!model->frozen) {
+                        furi_mutex_acquire(model->mutex, FuriWaitForever);
+                        model->frozen_end = lora_byte_log_end(model->log);
+                        furi_mutex_release(model->mutex);
+                        model->frozen = true;
+                    }
+                    uint32_t step = event->key == InputKeyLeft ? HEX_VIEW_ROWS : 1;
+                    model->scroll += step;
+                    consumed = true;
+                    break;
+                }
+                case InputKeyDown:
+                case InputKeyRight: {
+                    uint32_t step = event->key == InputKeyRight ? HEX_VIEW_ROWS : 1;
+                    model->scroll = model->scroll > step ? model->scroll - step : 0;
+                    consumed = true;
+                    break;
+                }
+                case InputKeyOk:
+                    if(event->type == InputTypeShort) {
+                        if(model->frozen) {
+                            model->frozen = false;
+                            model->scroll = 0;
+                        } else {
+                            furi_mutex_acquire(model->mutex, FuriWaitForever);
+                            model->frozen_end = lora_byte_log_end(model->log);
+                            furi_mutex_release(model->mutex);
+                            model->frozen = true;
+                        }
+                    }
+                    consumed = true;
+                    break;
+                default:
+                    break;
+                }
+
+                // Keep scroll within what the log still holds
+                if(consumed && model->frozen) {
+                    furi_mutex_acquire(model->mutex, FuriWaitForever);
+                    uint32_t max_scroll = lora_hex_view_max_scroll(model->log, model->frozen_end);
+                    furi_mutex_release(model->mutex);
+                    if(model->scroll > max_scroll) {
+                        model->scroll = max_scroll;
+                    }
+                }
+            }
+        },
+        consumed);
+
+    return consumed;
+}
+
+LoraHexView* lora_hex_view_alloc(void) {
+    LoraHexView* hex_view = malloc(sizeof(LoraHexView));
+    hex_view->view = view_alloc();
+    view_set_context(hex_view->view, hex_view);
+    view_allocate_model(hex_view->view, ViewModelTypeLocking, sizeof(LoraHexViewModel));
+    view_set_draw_callback(hex_view->view, lora_hex_view_draw_callback);
+    view_set_input_callback(hex_view->view, lora_hex_view_input_callback);
+
+    lora_hex_view_set_source(hex_view, NULL, NULL);
+
+    return hex_view;
+}
+
+void lora_hex_view_free(LoraHexView* hex_view) {
+    furi_assert(hex_view);
+    view_free(hex_view->view);
+    free(hex_view);
+}
+
+View* lora_hex_view_get_view(LoraHexView* hex_view) {
+    furi_assert(hex_view);
+    return hex_view->view;
+}
+
+void lora_hex_view_set_source(LoraHexView* hex_view, const LoraByteLog* log, FuriMutex* mutex) {
+    furi_assert(hex_view);
+    furi_assert(!log || mutex);
+    with_view_model(
+        hex_view->view,
+        LoraHexViewModel * model,
+        {
+            model->log = log;
+            model->mutex = mutex;
+            model->header[0] = '\0';
+            model->panel[0] = '\0';
+            model->show_panel = false;
+            model->frozen = false;
+            model->frozen_end = 0;
+            model->scroll = 0;
+        },
+        true);
+}
+
+void lora_hex_view_set_header(LoraHexView* hex_view, const char* text) {
+    furi_assert(hex_view);
+    with_view_model(
+        hex_view->view,
+        LoraHexViewModel * model,
+        { snprintf(model->header, sizeof(model->header), "%s", text); },
+        true);
+}
+
+void lora_hex_view_set_panel(LoraHexView* hex_view, const char* text) {
+    furi_assert(hex_view);
+    with_view_model(
+        hex_view->view,
+        LoraHexViewModel * model,
+        { snprintf(model->panel, sizeof(model->panel), "%s", text); },
+        model->show_panel);
+}
+
+void lora_hex_view_update(LoraHexView* hex_view) {
+    furi_assert(hex_view);
+    with_view_model(hex_view->view, LoraHexViewModel * model, { UNUSED(model); }, true);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <gui/view.h>
+#include <furi.h>
+#include "lora_byte_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LORA_HEX_VIEW_PANEL_LINES 6
+#define LORA_HEX_VIEW_PANEL_WIDTH 21
+
+/** Hex dump view anonymous structure */
+typedef struct LoraHexView LoraHexView;
+
+/** Allocate and initialize hex dump view
+ *
+ * Rows are read straight from a LoraByteLog at draw time, so only the
+ * visible rows are ever formatted. Up/Down scroll, OK holds or resumes
+ * the live tail, long OK swaps the rows for the text panel.
+ *
+ * @return     LoraHexView instance
+ */
+LoraHexView* lora_hex_view_alloc(void);
+
+/** Deinitialize and free hex dump view
+ *
+ * @param      hex_view  LoraHexView instance
+ */
+void lora_hex_view_free(LoraHexView* hex_view);
+
+/** Get hex dump view
+ *
+ * @param      hex_view  LoraHexView instance
+ *
+ * @return     View instance that can be used for embedding
+ */
+View* lora_hex_view_get_view(LoraHexView* hex_view);
+
+/** Set the byte log to display, resets scroll and hold
+ *
+ * The log must outlive the view or be detached with NULL first.
+ *
+ * @param      hex_view  LoraHexView instance
+ * @param      log       byte log, or NULL to detach
+ * @param      mutex     mutex guarding writes to the log
+ */
+void lora_hex_view_set_source(LoraHexView* hex_view, const LoraByteLog* log, FuriMutex* mutex);
+
+/** Set the status line and redraw
+ *
+ * @param      hex_view  LoraHexView instance
+ * @param      text      status text, copied
+ */
+void lora_hex_view_set_header(LoraHexView* hex_view, const char* text);
+
+/** Set the text shown instead of the rows while the panel is toggled on
+ *
+ * @param      hex_view  LoraHexView instance
+ * @param      text      up to LORA_HEX_VIEW_PANEL_LINES lines of
+ *                       LORA_HEX_VIEW_PANEL_WIDTH characters, copied
+ */
+void lora_hex_view_set_panel(LoraHexView* hex_view, const char* text);
+
+/** Redraw with whatever the log holds now
+ *
+ * @param      hex_view  LoraHexView instance
+ */
+void lora_hex_view_update(LoraHexView* hex_view);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,233 @@
+#include "lora_module.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <inttypes.h>
+#include <string.h>
+
+#define TAG "LoRaTester"
+#define LORA_MODULE_CMD_READ 0xC1
+#define LORA_MODULE_CMD_WRITE 0xC0
+#define LORA_MODULE_CMD_WRITE_TEMPORARY 0xC2
+
+struct LoraModule {
+    LoraTesterUart* uart;
+    bool open;
+    FuriSemaphore* response_ready;
+    uint8_t response[LORA_MODULE_MAX_RESPONSE];
+    /** Bytes wanted by the pending command, 0 when nothing is pending */
+    volatile size_t expected;
+    volatile size_t received;
+    volatile uint32_t last_byte_cycles;
+    uint32_t last_latency_us;
+};
+
+static void lora_module_rx_cb(const uint8_t* data, size_t length, bool idle, void* context) {
+    LoraModule* module = context;
+    UNUSED(idle);
+
+    for(size_t i = 0; i < length; i++) {
+        // Bytes nobody asked for are dropped
+        if(module->received < module->expected) {
+            module->response[module->received++] = data[i];
+            if(module->received == module->expected) {
+                module->last_byte_cycles = DWT->CYCCNT;
+                furi_semaphore_release(module->response_ready);
+            }
+        }
+    }
+}
+
+LoraModule* lora_module_alloc(LoraTesterUart* uart) {
+    furi_assert(uart);
+    LoraModule* module = malloc(sizeof(LoraModule));
+    memset(module, 0, sizeof(LoraModule));
+    module->uart = uart;
+    module->response_ready = furi_semaphore_alloc(1, 0);
+    return module;
+}
+
+void lora_module_free(LoraModule* module) {
+    furi_assert(module);
+    lora_module_close(module);
+    furi_semaphore_free(module->response_ready);
+    free(module);
+}
+
+bool lora_module_open(LoraModule* module, uint32_t baud_rate) {
+    furi_assert(module);
+    if(module->open) {
+        return true;
+    }
+
+    module->expected = 0;
+    module->open = lora_tester_uart_claim(
+        module->uart, baud_rate, lora_module_rx_cb, module, LORA_TESTER_UART_CLAIM_TIMEOUT_MS);
+    return module->open;
+}
+
+void lora_module_close(LoraModule* module) {
+    furi_assert(module);
+    if(module->open) {
+        lora_tester_uart_release(module->uart);
+        module->open = false;
+    }
+}
+
+bool lora_module_is_open(LoraModule* module) {
+    furi_assert(module);
+    return module->open;
+}
+
+void lora_module_set_baud_rate(LoraModule* module, uint32_t baud_rate) {
+    furi_assert(module);
+    furi_assert(module->open);
+    lora_tester_uart_set_baud_rate(module->uart, baud_rate);
+}
+
+LoraModuleStatus lora_module_transact(
+    LoraModule* module,
+    const uint8_t* command,
+    size_t command_length,
+    uint8_t* response,
+    size_t response_length,
+    uint32_t timeout_ms) {
+    furi_assert(module);
+    furi_assert(response_length <= LORA_MODULE_MAX_RESPONSE);
+
+    if(!module->open) {
+        return LoraModuleStatusBusy;
+    }
+
+    // Anything left over from a previous command or unsolicited output is discarded
+    module->expected = 0;
+    module->received = 0;
+    furi_semaphore_acquire(module->response_ready, 0);
+    module->expected = response_length;
+
+    lora_tester_uart_tx(module->uart, command, command_length);
+    uint32_t sent_cycles = DWT->CYCCNT;
+
+    FuriStatus wait =
+        furi_semaphore_acquire(module->response_ready, furi_ms_to_ticks(timeout_ms));
+    // Stop the ISR writing before the caller reuses anything
+    module->expected = 0;
+
+    if(wait != FuriStatusOk) {
+        FURI_LOG_W(
+            TAG,
+            "Command %02X timed out after %" PRIu32 "ms, %u/%u bytes",
+            command[0],
+            timeout_ms,
+            (unsigned)module->received,
+            (unsigned)response_length);
+        return LoraModuleStatusTimeout;
+    }
+
+    module->last_latency_us =
+        (module->last_byte_cycles - sent_cycles) / furi_hal_cortex_instructions_per_microsecond();
+    FURI_LOG_I(TAG, "Command %02X answered in %" PRIu32 "us", command[0], module->last_latency_us);
+
+    if(response) {
+        memcpy(response, module->response, response_length);
+    }
+    return LoraModuleStatusOk;
+}
+
+static LoraModuleStatus lora_module_register_command(
+    LoraModule* module,
+    uint8_t opcode,
+    uint8_t address,
+    const uint8_t* write,
+    uint8_t* read,
+    uint8_t length,
+    uint32_t timeout_ms) {
+    uint8_t command[LORA_MODULE_MAX_RESPONSE] = {opcode, address, length};
+    uint8_t response[LORA_MODULE_MAX_RESPONSE];
+    size_t command_length = 3;
+
+    furi_assert(address + length <= LORA_CONFIG_REG_COUNT);
+    if(write) {
+        memcpy(&command[3], write, length);
+        command_length += length;
+    }
+
+    LoraModuleStatus status =
+        lora_module_transact(module, command, command_length, response, 3 + length, timeout_ms);
+    if(status != LoraModuleStatusOk) {
+        return status;
+    }
+
+    // Reads and both kinds of write are answered with C1 <address> <length> <registers>
+    if(response[0] != LORA_MODULE_CMD_READ || response[1] != address || response[2] != length) {
+        FURI_LOG_W(
+            TAG, "Unexpected response %02X %02X %02X", response[0], response[1], response[2]);
+        return LoraModuleStatusBadResponse;
+    }
+    if(read) {
+        memcpy(read, &response[3], length);
+    }
+    // The echo only confirms a write if it carries the bytes written, the key is write-only
+    if(write) {
+        for(uint8_t i = 0; i < length; i++) {
+            uint8_t reg = address + i;
+            if(reg != LoraRegCryptH && reg != LoraRegCryptL && response[3 + i] != write[i]) {
+                FURI_LOG_W(
+                    TAG, "Register %02X echoed %02X, wrote %02X", reg, response[3 + i], write[i]);
+                return LoraModuleStatusBadResponse;
+            }
+        }
+    }
+    return LoraModuleStatusOk;
+}
+
+LoraModuleStatus lora_module_read_registers(
+    LoraModule* module,
+    uint8_t address,
+    uint8_t* registers,
+    uint8_t length,
+    uint32_t timeout_ms) {
+    return lora_module_register_command(
+        module, LORA_MODULE_CMD_READ, address, NULL, registers, length, timeout_ms);
+}
+
+LoraModuleStatus lora_module_write_registers(
+    LoraModule* module,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length,
+    uint32_t timeout_ms) {
+    return lora_module_register_command(
+        module, LORA_MODULE_CMD_WRITE, address, registers, NULL, length, timeout_ms);
+}
+
+LoraModuleStatus lora_module_write_registers_temporary(
+    LoraModule* module,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length,
+    uint32_t timeout_ms) {
+    return lora_module_register_command(
+        module, LORA_MODULE_CMD_WRITE_TEMPORARY, address, registers, NULL, length, timeout_ms);
+}
+
+uint32_t lora_module_get_last_latency_us(LoraModule* module) {
+    furi_assert(module);
+    return module->last_latency_us;
+}
+
+const char* lora_module_status_name(LoraModuleStatus status) {
+    switch(status) {
+    case LoraModuleStatusOk:
+        return "OK";
+    case LoraModuleStatusBusy:
+        return "Serial port busy";
+    case LoraModuleStatusTimeout:
+        return "No response";
+    case LoraModuleStatusBadResponse:
+        return "Bad response";
+    case LoraModuleStatusCancelled:
+        return "Cancelled";
+    default:
+        return "Unknown";
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "lora_config_binary_convert.h"
+#include "lora_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest response the module sends: C1 <addr> <len> plus every register */
+#define LORA_MODULE_MAX_RESPONSE (3 + LORA_CONFIG_REG_COUNT)
+
+/** Default wait for a register command answer */
+#define LORA_MODULE_TIMEOUT_MS 1000
+
+typedef enum {
+    LoraModuleStatusOk,
+    LoraModuleStatusBusy,
+    LoraModuleStatusTimeout,
+    LoraModuleStatusBadResponse,
+    /** Stopped by the caller before the module answered */
+    LoraModuleStatusCancelled,
+} LoraModuleStatus;
+
+/** E220 command channel on the shared USART.
+ *
+ * Commands are written and the caller blocks until the RX interrupt has
+ * collected the expected number of response bytes and released a semaphore,
+ * so a reply is picked up as soon as its last byte lands instead of on the
+ * next poll.
+ */
+typedef struct LoraModule LoraModule;
+
+LoraModule* lora_module_alloc(LoraTesterUart* uart);
+
+void lora_module_free(LoraModule* module);
+
+/** Claim the USART at baud_rate for a run of commands */
+bool lora_module_open(LoraModule* module, uint32_t baud_rate);
+
+/** End the claim, safe to call when not open */
+void lora_module_close(LoraModule* module);
+
+bool lora_module_is_open(LoraModule* module);
+
+/** Change the rate of an open USART */
+void lora_module_set_baud_rate(LoraModule* module, uint32_t baud_rate);
+
+/** Send command and wait up to timeout_ms for response_length bytes
+ *
+ * @param      response  receives the response, may be NULL to only wait for it
+ */
+LoraModuleStatus lora_module_transact(
+    LoraModule* module,
+    const uint8_t* command,
+    size_t command_length,
+    uint8_t* response,
+    size_t response_length,
+    uint32_t timeout_ms);
+
+/** Read length registers from address with C1, checking the echoed header */
+LoraModuleStatus lora_module_read_registers(
+    LoraModule* module,
+    uint8_t address,
+    uint8_t* registers,
+    uint8_t length,
+    uint32_t timeout_ms);
+
+/** Write registers from address with C0 and wait for the module to echo them
+ *
+ * @return     LoraModuleStatusBadResponse if the echo differs from what was written
+ */
+LoraModuleStatus lora_module_write_registers(
+    LoraModule* module,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length,
+    uint32_t timeout_ms);
+
+/** Write registers from address with C2, lost when the module powers down */
+LoraModuleStatus lora_module_write_registers_temporary(
+    LoraModule* module,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length,
+    uint32_t timeout_ms);
+
+/** Microseconds from the end of the last command to its last response byte */
+uint32_t lora_module_get_last_latency_us(LoraModule* module);
+
+const char* lora_module_status_name(LoraModuleStatus status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+#include "lora_refresh_limiter.h"
+
+void lora_refresh_limiter_init(LoraRefreshLimiter* limiter, uint32_t fps) {
+    limiter->min_interval_ms = fps ? 1000 / fps : 0;
+    limiter->last_draw = 0;
+    limiter->requests = 0;
+    limiter->draws = 0;
+    limiter->merged = 0;
+    __atomic_store_n(&limiter->dirty, false, __ATOMIC_RELAXED);
+    __atomic_store_n(&limiter->pending, false, __ATOMIC_RELAXED);
+}
+
+bool lora_refresh_limiter_request(LoraRefreshLimiter* limiter, uint32_t now_ms) {
+    limiter->requests++;
+    __atomic_store_n(&limiter->dirty, true, __ATOMIC_RELEASE);
+
+    uint32_t last_draw = __atomic_load_n(&limiter->last_draw, __ATOMIC_ACQUIRE);
+    if(now_ms - last_draw >= limiter->min_interval_ms &&
+       !__atomic_exchange_n(&limiter->pending, true, __ATOMIC_ACQ_REL)) {
+        return true;
+    }
+
+    limiter->merged++;
+    return false;
+}
+
+bool lora_refresh_limiter_due(const LoraRefreshLimiter* limiter, uint32_t now_ms) {
+    if(!__atomic_load_n(&limiter->dirty, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    uint32_t last_draw = __atomic_load_n(&limiter->last_draw, __ATOMIC_ACQUIRE);
+    return now_ms - last_draw >= limiter->min_interval_ms;
+}
+
+void lora_refresh_limiter_begin_draw(LoraRefreshLimiter* limiter, uint32_t now_ms) {
+    limiter->draws++;
+    __atomic_store_n(&limiter->dirty, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&limiter->last_draw, now_ms, __ATOMIC_RELEASE);
+    __atomic_store_n(&limiter->pending, false, __ATOMIC_RELEASE);
+}
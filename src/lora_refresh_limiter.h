@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Coalesces redraw requests from a producer thread into at most fps redraws per second.
+ *
+ * The producer calls lora_refresh_limiter_request() whenever it has new data
+ * and posts a refresh event only when told to. The GUI thread redraws on that
+ * event or, for deferred requests, from its tick when
+ * lora_refresh_limiter_due() says so, and reports every redraw with
+ * lora_refresh_limiter_begin_draw() before reading the data it shows.
+ */
+typedef struct {
+    uint32_t min_interval_ms;
+    uint32_t last_draw;
+    bool dirty;
+    bool pending;
+    uint32_t requests;
+    uint32_t draws;
+    uint32_t merged;
+} LoraRefreshLimiter;
+
+/** Reset counters and set the frame rate cap */
+void lora_refresh_limiter_init(LoraRefreshLimiter* limiter, uint32_t fps);
+
+/** Mark the view dirty, producer side
+ *
+ * @return     true if the caller should post a refresh event now, false if
+ *             the request was merged into one already pending or deferred
+ *             to the next tick
+ */
+bool lora_refresh_limiter_request(LoraRefreshLimiter* limiter, uint32_t now_ms);
+
+/** Whether a redraw is due at now_ms, GUI side */
+bool lora_refresh_limiter_due(const LoraRefreshLimiter* limiter, uint32_t now_ms);
+
+/** Record a redraw, GUI side
+ *
+ * Call before rendering so a request that races with the redraw leaves the
+ * view dirty for the next tick instead of being lost.
+ */
+void lora_refresh_limiter_begin_draw(LoraRefreshLimiter* limiter, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,103 @@
+#include "lora_rssi.h"
+#include <string.h>
+
+static const uint8_t lora_rssi_reply_header[] = {0xC1, 0x00, 0x02};
+
+/* Round to nearest, readings are negative */
+static int16_t lora_rssi_mean(int32_t sum, uint32_t count) {
+    return (sum - (int32_t)count / 2) / (int32_t)count;
+}
+
+void lora_rssi_history_reset(LoraRssiHistory* history) {
+    memset(history, 0, sizeof(LoraRssiHistory));
+}
+
+void lora_rssi_history_push(LoraRssiHistory* history, int16_t dbm) {
+    history->samples[history->head] = dbm;
+    history->head = (history->head + 1) % LORA_RSSI_HISTORY_SIZE;
+    if(history->count < LORA_RSSI_HISTORY_SIZE) {
+        history->count++;
+    }
+}
+
+int16_t lora_rssi_history_get(const LoraRssiHistory* history, size_t age) {
+    size_t index = (history->head + LORA_RSSI_HISTORY_SIZE - 1 - age) % LORA_RSSI_HISTORY_SIZE;
+    return history->samples[index];
+}
+
+bool lora_rssi_history_summary(const LoraRssiHistory* history, LoraRssiSummary* summary) {
+    if(history->count == 0) {
+        return false;
+    }
+
+    int32_t sum = 0;
+    summary->min = INT16_MAX;
+    summary->max = INT16_MIN;
+    for(size_t age = 0; age < history->count; age++) {
+        int16_t sample = lora_rssi_history_get(history, age);
+        sum += sample;
+        if(sample < summary->min) {
+            summary->min = sample;
+        }
+        if(sample > summary->max) {
+            summary->max = sample;
+        }
+    }
+    summary->avg = lora_rssi_mean(sum, history->count);
+    return true;
+}
+
+void lora_survey_reset(LoraSurvey* survey, uint8_t channels) {
+    if(channels > LORA_SURVEY_MAX_CHANNELS) {
+        channels = LORA_SURVEY_MAX_CHANNELS;
+    }
+    for(size_t i = 0; i < LORA_SURVEY_MAX_CHANNELS; i++) {
+        survey->noise[i] = LORA_SURVEY_NO_DATA;
+    }
+    survey->channels = channels;
+    survey->current = channels;
+}
+
+void lora_survey_set(LoraSurvey* survey, uint8_t channel, int32_t sum, uint32_t samples) {
+    if(channel >= survey->channels) {
+        return;
+    }
+    survey->noise[channel] = samples ? lora_rssi_mean(sum, samples) : LORA_SURVEY_NO_DATA;
+}
+
+int lora_survey_quietest(const LoraSurvey* survey) {
+    int quietest = -1;
+    for(size_t i = 0; i < survey->channels; i++) {
+        if(survey->noise[i] == LORA_SURVEY_NO_DATA) {
+            continue;
+        }
+        if(quietest < 0 || survey->noise[i] < survey->noise[quietest]) {
+            quietest = i;
+        }
+    }
+    return quietest;
+}
+
+void lora_rssi_parser_reset(LoraRssiParser* parser) {
+    parser->state = 0;
+}
+
+LoraRssiParserResult lora_rssi_parser_feed(LoraRssiParser* parser, uint8_t byte) {
+    if(parser->state < sizeof(lora_rssi_reply_header)) {
+        if(byte == lora_rssi_reply_header[parser->state]) {
+            parser->state++;
+            return LoraRssiParserPending;
+        }
+        // A broken off header may be the start of the real one
+        parser->state = byte == lora_rssi_reply_header[0] ? 1 : 0;
+        return parser->state ? LoraRssiParserPending : LoraRssiParserData;
+    }
+
+    parser->values[parser->state - sizeof(lora_rssi_reply_header)] = byte;
+    parser->state++;
+    if(parser->state == sizeof(lora_rssi_reply_header) + sizeof(parser->values)) {
+        parser->state = 0;
+        return LoraRssiParserReply;
+    }
+    return LoraRssiParserPending;
+}
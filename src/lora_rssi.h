@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Samples kept, one per pixel column of the sparkline */
+#define LORA_RSSI_HISTORY_SIZE 128
+
+/** Read 2 registers from RSSI address 0x00, answered with C1 00 02 <ambient> <last packet> */
+#define LORA_RSSI_COMMAND {0xC0, 0xC1, 0xC2, 0xC3, 0x00, 0x02}
+#define LORA_RSSI_COMMAND_SIZE 6
+
+/** Ring of ambient noise readings in dBm */
+typedef struct {
+    int16_t samples[LORA_RSSI_HISTORY_SIZE];
+    uint16_t head;
+    uint16_t count;
+} LoraRssiHistory;
+
+typedef struct {
+    int16_t min;
+    int16_t max;
+    int16_t avg;
+} LoraRssiSummary;
+
+/** Most channels any bandwidth has, see lora_config_max_channel */
+#define LORA_SURVEY_MAX_CHANNELS 38
+
+/** Noise value of a channel that has no readings */
+#define LORA_SURVEY_NO_DATA INT16_MIN
+
+/** Mean ambient noise in dBm of every channel in a band */
+typedef struct {
+    int16_t noise[LORA_SURVEY_MAX_CHANNELS];
+    uint8_t channels;
+    /** Channel being measured, channels when none is */
+    uint8_t current;
+} LoraSurvey;
+
+/** Picks RSSI replies out of a stream that can also carry received packets */
+typedef struct {
+    uint8_t state;
+    uint8_t values[2];
+} LoraRssiParser;
+
+typedef enum {
+    /** Byte belongs to received data */
+    LoraRssiParserData,
+    /** Byte is part of a reply that isn't complete yet */
+    LoraRssiParserPending,
+    /** Byte completed a reply, values holds ambient and last packet RSSI */
+    LoraRssiParserReply,
+} LoraRssiParserResult;
+
+/** dBm for an RSSI register value */
+static inline int16_t lora_rssi_dbm(uint8_t raw) {
+    return -(256 - (int16_t)raw);
+}
+
+void lora_rssi_history_reset(LoraRssiHistory* history);
+
+void lora_rssi_history_push(LoraRssiHistory* history, int16_t dbm);
+
+/** Sample age steps back from the newest, age < count */
+int16_t lora_rssi_history_get(const LoraRssiHistory* history, size_t age);
+
+/** @return     false if there are no samples yet */
+bool lora_rssi_history_summary(const LoraRssiHistory* history, LoraRssiSummary* summary);
+
+/** Clear the table for a band of channels, at most LORA_SURVEY_MAX_CHANNELS */
+void lora_survey_reset(LoraSurvey* survey, uint8_t channels);
+
+/** Store the mean of samples readings adding up to sum, no data if samples is 0 */
+void lora_survey_set(LoraSurvey* survey, uint8_t channel, int32_t sum, uint32_t samples);
+
+/** Channel with the lowest noise, the lowest numbered on a tie, -1 if none has data */
+int lora_survey_quietest(const LoraSurvey* survey);
+
+void lora_rssi_parser_reset(LoraRssiParser* parser);
+
+/** Feed one received byte
+ *
+ * A reply header that breaks off part way is reported as data from the
+ * mismatching byte on, the bytes before it were already counted as pending.
+ */
+LoraRssiParserResult lora_rssi_parser_feed(LoraRssiParser* parser, uint8_t byte);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,157 @@
+#include "lora_rssi_view.h"
+#include <gui/elements.h>
+#include <string.h>
+
+#define RSSI_VIEW_HEADER_SIZE 32
+#define RSSI_VIEW_GRAPH_TOP 20
+#define RSSI_VIEW_GRAPH_BOTTOM 63
+/** Smallest span the graph is scaled to, so a flat noise floor doesn't fill it */
+#define RSSI_VIEW_MIN_SPAN_DBM 10
+
+struct LoraRssiView {
+    View* view;
+    LoraRssiViewStepCallback callback;
+    void* context;
+};
+
+typedef struct {
+    const LoraRssiHistory* history;
+    FuriMutex* mutex;
+    char header[RSSI_VIEW_HEADER_SIZE];
+} LoraRssiViewModel;
+
+static uint8_t lora_rssi_view_y(int16_t dbm, int16_t low, int16_t span) {
+    int32_t height = RSSI_VIEW_GRAPH_BOTTOM - RSSI_VIEW_GRAPH_TOP;
+    return RSSI_VIEW_GRAPH_BOTTOM - (int32_t)(dbm - low) * height / span;
+}
+
+static void lora_rssi_view_draw_callback(Canvas* canvas, void* _model) {
+    LoraRssiViewModel* model = _model;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+    canvas_draw_str(canvas, 0, 7, model->header);
+    canvas_draw_line(canvas, 0, 9, 127, 9);
+
+    if(!model->history) {
+        return;
+    }
+
+    furi_mutex_acquire(model->mutex, FuriWaitForever);
+
+    const LoraRssiHistory* history = model->history;
+    LoraRssiSummary summary;
+    if(!lora_rssi_history_summary(history, &summary)) {
+        furi_mutex_release(model->mutex);
+        canvas_draw_str(canvas, 0, 18, "Waiting for module...");
+        return;
+    }
+
+    char text[RSSI_VIEW_HEADER_SIZE];
+    snprintf(text, sizeof(text), "Min %d Avg %d Max %d", summary.min, summary.avg, summary.max);
+    canvas_draw_str(canvas, 0, 17, text);
+
+    int16_t span = summary.max - summary.min;
+    int16_t low = summary.min;
+    if(span < RSSI_VIEW_MIN_SPAN_DBM) {
+        low -= (RSSI_VIEW_MIN_SPAN_DBM - span) / 2;
+        span = RSSI_VIEW_MIN_SPAN_DBM;
+    }
+
+    // Newest sample on the right edge, one pixel column per sample
+    uint8_t previous_y = 0;
+    for(size_t age = 0; age < history->count; age++) {
+        uint8_t x = 127 - age;
+        uint8_t y = lora_rssi_view_y(lora_rssi_history_get(history, age), low, span);
+        if(age == 0) {
+            canvas_draw_dot(canvas, x, y);
+        } else {
+            canvas_draw_line(canvas, x, y, x + 1, previous_y);
+        }
+        previous_y = y;
+    }
+
+    furi_mutex_release(model->mutex);
+}
+
+static bool lora_rssi_view_input_callback(InputEvent* event, void* context) {
+    LoraRssiView* rssi_view = context;
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+    if(event->key != InputKeyLeft && event->key != InputKeyRight) {
+        return false;
+    }
+    if(rssi_view->callback) {
+        rssi_view->callback(event->key == InputKeyRight ? 1 : -1, rssi_view->context);
+    }
+    return true;
+}
+
+LoraRssiView* lora_rssi_view_alloc(void) {
+    LoraRssiView* rssi_view = malloc(sizeof(LoraRssiView));
+    rssi_view->view = view_alloc();
+    rssi_view->callback = NULL;
+    rssi_view->context = NULL;
+    view_set_context(rssi_view->view, rssi_view);
+    view_allocate_model(rssi_view->view, ViewModelTypeLocking, sizeof(LoraRssiViewModel));
+    view_set_draw_callback(rssi_view->view, lora_rssi_view_draw_callback);
+    view_set_input_callback(rssi_view->view, lora_rssi_view_input_callback);
+
+    lora_rssi_view_set_source(rssi_view, NULL, NULL);
+
+    return rssi_view;
+}
+
+void lora_rssi_view_free(LoraRssiView* rssi_view) {
+    furi_assert(rssi_view);
+    view_free(rssi_view->view);
+    free(rssi_view);
+}
+
+View* lora_rssi_view_get_view(LoraRssiView* rssi_view) {
+    furi_assert(rssi_view);
+    return rssi_view->view;
+}
+
+void lora_rssi_view_set_source(
+    LoraRssiView* rssi_view,
+    const LoraRssiHistory* history,
+    FuriMutex* mutex) {
+    furi_assert(rssi_view);
+    furi_assert(!history || mutex);
+    with_view_model(
+        rssi_view->view,
+        LoraRssiViewModel * model,
+        {
+            model->history = history;
+            model->mutex = mutex;
+            model->header[0] = '\0';
+        },
+        true);
+}
+
+void lora_rssi_view_set_step_callback(
+    LoraRssiView* rssi_view,
+    LoraRssiViewStepCallback callback,
+    void* context) {
+    furi_assert(rssi_view);
+    rssi_view->callback = callback;
+    rssi_view->context = context;
+}
+
+void lora_rssi_view_set_header(LoraRssiView* rssi_view, const char* text) {
+    furi_assert(rssi_view);
+    with_view_model(
+        rssi_view->view,
+        LoraRssiViewModel * model,
+        { snprintf(model->header, sizeof(model->header), "%s", text); },
+        true);
+}
+
+void lora_rssi_view_update(LoraRssiView* rssi_view) {
+    furi_assert(rssi_view);
+    with_view_model(rssi_view->view, LoraRssiViewModel * model, { UNUSED(model); }, true);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <gui/view.h>
+#include <furi.h>
+#include "lora_rssi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** RSSI meter view anonymous structure */
+typedef struct LoraRssiView LoraRssiView;
+
+/** Called from the GUI thread when Left (-1) or Right (+1) is pressed */
+typedef void (*LoraRssiViewStepCallback)(int8_t step, void* context);
+
+/** Allocate and initialize RSSI meter view
+ *
+ * Draws min/avg/max and a sparkline of a LoraRssiHistory, newest sample at
+ * the right edge, scaled to the range of the samples held.
+ *
+ * @return     LoraRssiView instance
+ */
+LoraRssiView* lora_rssi_view_alloc(void);
+
+/** Deinitialize and free RSSI meter view
+ *
+ * @param      rssi_view  LoraRssiView instance
+ */
+void lora_rssi_view_free(LoraRssiView* rssi_view);
+
+/** Get RSSI meter view
+ *
+ * @param      rssi_view  LoraRssiView instance
+ *
+ * @return     View instance that can be used for embedding
+ */
+View* lora_rssi_view_get_view(LoraRssiView* rssi_view);
+
+/** Set the history to display
+ *
+ * The history must outlive the view or be detached with NULL first.
+ *
+ * @param      rssi_view  LoraRssiView instance
+ * @param      history    RSSI history, or NULL to detach
+ * @param      mutex      mutex guarding writes to the history
+ */
+void lora_rssi_view_set_source(
+    LoraRssiView* rssi_view,
+    const LoraRssiHistory* history,
+    FuriMutex* mutex);
+
+/** Set the Left/Right callback
+ *
+ * @param      rssi_view  LoraRssiView instance
+ * @param      callback   step callback, or NULL
+ * @param      context    callback context
+ */
+void lora_rssi_view_set_step_callback(
+    LoraRssiView* rssi_view,
+    LoraRssiViewStepCallback callback,
+    void* context);
+
+/** Set the status line and redraw
+ *
+ * @param      rssi_view  LoraRssiView instance
+ * @param      text       status text, copied
+ */
+void lora_rssi_view_set_header(LoraRssiView* rssi_view, const char* text);
+
+/** Redraw with whatever the history holds now
+ *
+ * @param      rssi_view  LoraRssiView instance
+ */
+void lora_rssi_view_update(LoraRssiView* rssi_view);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,429 @@
+#include "lora_rx_bench.h"
+#include "lora_byte_log.h"
+#include "lora_hex_format.h"
+#include "lora_refresh_limiter.h"
+#include "lora_rx_path.h"
+#include "lora_rx_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Same constants as the receive scene and the view it refreshes */
+#define LORA_RX_BENCH_FLUSH_MS 20
+#define LORA_RX_BENCH_REFRESH_FPS 8
+#define LORA_RX_BENCH_TICK_MS 100
+#define LORA_RX_BENCH_ROWS 6
+#define LORA_RX_BENCH_BYTES_PER_ROW 4
+
+/** Character times of silence between back to back packets, enough for the idle line */
+#define LORA_RX_BENCH_GAP_CHARS 4
+/** Idle line interrupts whose packet hasn't been taken by the worker yet */
+#define LORA_RX_BENCH_ENDS 32
+
+#define LORA_RX_BENCH_MIN_RATE 1200
+#define LORA_RX_BENCH_MAX_RATE 100000000
+#define LORA_RX_BENCH_SEARCH_STEPS 24
+/** Replays of a rate before it counts as lossy */
+#define LORA_RX_BENCH_ATTEMPTS 3
+
+#define LORA_RX_BENCH_NONE UINT64_MAX
+
+/** Everything the receive scene owns, plus the emulated single core timeline in ns */
+typedef struct {
+    const LoraRxBench* bench;
+    LoraRxPath rx;
+    LoraByteLog history;
+    LoraRxStats stats;
+    LoraRefreshLimiter refresh;
+    uint32_t last_length;
+
+    uint64_t now;
+    uint64_t char_ns;
+    /** The worker or a refresh holds the core until then */
+    uint64_t busy_until;
+    /** The last ISR returns then, a byte waiting longer than a character is overrun */
+    uint64_t isr_free;
+    uint64_t worker_at;
+    uint64_t flush_at;
+    uint64_t refresh_at;
+    uint64_t tick_at;
+    uint32_t overhead;
+
+    uint64_t ends[LORA_RX_BENCH_ENDS];
+    uint32_t end_head;
+    uint32_t end_tail;
+    bool unshown;
+    uint64_t unshown_since;
+    uint64_t latency_sum;
+    uint32_t latency_count;
+
+    LoraRxBenchResult* result;
+} LoraRxBenchState;
+
+static uint64_t lora_rx_bench_ns(const LoraRxBenchState* state, uint32_t cycles) {
+    return (uint64_t)cycles * 1000 / state->bench->cycles_per_us;
+}
+
+static uint32_t lora_rx_bench_tick(const LoraRxBenchState* state) {
+    return state->now / 1000000;
+}
+
+/** Cycles since start, less what reading the clock itself costs */
+static uint32_t lora_rx_bench_elapsed(const LoraRxBenchState* state, uint32_t start) {
+    uint32_t cycles = state->bench->clock() - start;
+    return cycles > state->overhead ? cycles - state->overhead : 0;
+}
+
+static uint32_t lora_rx_bench_clock_overhead(LoraRxBenchClock clock) {
+    uint32_t overhead = UINT32_MAX;
+    for(int i = 0; i < 64; i++) {
+        uint32_t start = clock();
+        uint32_t cycles = clock() - start;
+        if(cycles < overhead) {
+            overhead = cycles;
+        }
+    }
+    return overhead;
+}
+
+static void lora_rx_bench_packet_cb(const LoraRxPacket* packet, void* context) {
+    LoraRxBenchState* state = context;
+
+    // Same work as the scene's packet_received_cb, minus the mutex and the capture
+    lora_byte_log_mark_packet(&state->history);
+    lora_byte_log_append(&state->history, packet->data, packet->length);
+    lora_rx_stats_add(&state->stats, packet->length, packet->start_tick);
+    state->last_length = packet->length;
+
+    if(state->end_tail != state->end_head) {
+        uint64_t end = state->ends[state->end_tail++ % LORA_RX_BENCH_ENDS];
+        if(!state->unshown) {
+            state->unshown = true;
+            state->unshown_since = end;
+        }
+    }
+}
+
+/** Charge cycles to the core: an ISR delays whatever it preempts */
+static void lora_rx_bench_preempt(LoraRxBenchState* state, uint32_t cycles) {
+    if(state->busy_until > state->now) {
+        state->busy_until += lora_rx_bench_ns(state, cycles);
+    }
+}
+
+static void lora_rx_bench_isr(
+    LoraRxBenchState* state,
+    const uint8_t* data,
+    size_t length,
+    bool idle) {
+    uint64_t entry = state->now > state->isr_free ? state->now : state->isr_free;
+    if(!idle && entry - state->now >= state->char_ns) {
+        // The next byte landed in the data register before this one was read
+        state->result->overruns++;
+        return;
+    }
+
+    uint32_t start = state->bench->clock();
+    uint32_t wake = lora_rx_path_isr(&state->rx, data, length, idle, lora_rx_bench_tick(state));
+    uint32_t cycles = lora_rx_bench_elapsed(state, start);
+
+    state->result->isr_cycles += cycles;
+    state->isr_free = entry + lora_rx_bench_ns(state, cycles);
+    lora_rx_bench_preempt(state, cycles);
+    if(idle && state->end_head - state->end_tail < LORA_RX_BENCH_ENDS) {
+        state->ends[state->end_head++ % LORA_RX_BENCH_ENDS] = state->now;
+    }
+    if(wake && state->worker_at == LORA_RX_BENCH_NONE) {
+        state->worker_at = state->now;
+    }
+}
+
+static void lora_rx_bench_worker(LoraRxBenchState* state) {
+    uint32_t start = state->bench->clock();
+    uint32_t now = lora_rx_bench_tick(state);
+    uint32_t packets = lora_rx_path_drain(&state->rx, now, false);
+    bool post = packets && lora_refresh_limiter_request(&state->refresh, now);
+    uint32_t cycles = lora_rx_bench_elapsed(state, start);
+
+    state->result->worker_cycles += cycles;
+    state->busy_until = state->now + lora_rx_bench_ns(state, cycles);
+    if(post && state->refresh_at == LORA_RX_BENCH_NONE) {
+        state->refresh_at = state->busy_until;
+    }
+    state->flush_at = lora_rx_path_pending(&state->rx) ?
+                          state->busy_until + LORA_RX_BENCH_FLUSH_MS * 1000000ULL :
+                          LORA_RX_BENCH_NONE;
+}
+
+/** What refresh_view and the hex view's draw callback compute, without the canvas */
+static void lora_rx_bench_refresh(LoraRxBenchState* state) {
+    uint32_t start = state->bench->clock();
+    uint32_t now = lora_rx_bench_tick(state);
+    LoraRxBenchResult* result = state->result;
+    LoraRxStatsSummary summary[LoraRxStatsWindowCount];
+    char panel[LORA_RX_STATS_PANEL_SIZE];
+    char header[32];
+    uint8_t bytes[LORA_RX_BENCH_BYTES_PER_ROW];
+    char text[LORA_HEX_FORMAT_SIZE(LORA_RX_BENCH_BYTES_PER_ROW)];
+
+    lora_refresh_limiter_begin_draw(&state->refresh, now);
+    snprintf(
+        header,
+        sizeof(header),
+        "#%lu %luB",
+        (unsigned long)state->rx.framer.packets,
+        (unsigned long)state->last_length);
+    for(size_t window = 0; window < LoraRxStatsWindowCount; window++) {
+        lora_rx_stats_get(&state->stats, window, now, &summary[window]);
+    }
+    lora_rx_stats_format_panel(summary, panel, sizeof(panel));
+
+    uint32_t end = lora_byte_log_end(&state->history);
+    uint32_t first = end > LORA_RX_BENCH_ROWS * LORA_RX_BENCH_BYTES_PER_ROW ?
+                         end - LORA_RX_BENCH_ROWS * LORA_RX_BENCH_BYTES_PER_ROW :
+                         0;
+    for(uint32_t offset = first; offset < end; offset += LORA_RX_BENCH_BYTES_PER_ROW) {
+        size_t count = lora_byte_log_read(&state->history, offset, bytes, sizeof(bytes));
+        lora_hex_format(bytes, count, ' ', text, sizeof(text));
+        lora_hex_format_ascii(bytes, count, text, sizeof(text));
+        uint32_t packet;
+        lora_byte_log_find_packet(&state->history, offset, count, &packet);
+    }
+    uint32_t cycles = lora_rx_bench_elapsed(state, start);
+
+    result->refresh_cycles += cycles;
+    result->refreshes++;
+    state->busy_until = state->now + lora_rx_bench_ns(state, cycles);
+
+    if(state->unshown) {
+        uint64_t latency = state->busy_until - state->unshown_since;
+        state->latency_sum += latency;
+        state->latency_count++;
+        if(latency / 1000 > result->latency_max_us) {
+            result->latency_max_us = latency / 1000;
+        }
+        state->unshown = false;
+    }
+}
+
+/** Run the worker, view and tick events due by time, in order, each once the core is free */
+static void lora_rx_bench_advance(LoraRxBenchState* state, uint64_t time) {
+    while(true) {
+        uint64_t* next = &state->worker_at;
+        if(state->flush_at < *next) next = &state->flush_at;
+        if(state->refresh_at < *next) next = &state->refresh_at;
+        if(state->tick_at < *next) next = &state->tick_at;
+
+        uint64_t at = *next > state->busy_until ? *next : state->busy_until;
+        if(*next == LORA_RX_BENCH_NONE || at > time) {
+            break;
+        }
+        state->now = at;
+
+        if(next == &state->tick_at) {
+            state->tick_at += LORA_RX_BENCH_TICK_MS * 1000000ULL;
+            if(lora_refresh_limiter_due(&state->refresh, lora_rx_bench_tick(state)) &&
+               state->refresh_at == LORA_RX_BENCH_NONE) {
+                state->refresh_at = state->now;
+            }
+        } else if(next == &state->refresh_at) {
+            state->refresh_at = LORA_RX_BENCH_NONE;
+            lora_rx_bench_refresh(state);
+        } else {
+            // A wake flag and the flush timeout both run one pass of the worker loop
+            state->worker_at = LORA_RX_BENCH_NONE;
+            state->flush_at = LORA_RX_BENCH_NONE;
+            lora_rx_bench_worker(state);
+        }
+    }
+    state->now = time;
+}
+
+static bool lora_rx_bench_replay(
+    const LoraRxBench* bench,
+    uint32_t baud_rate,
+    bool timed,
+    LoraRxBenchResult* result) {
+    LoraRxBenchState* state = malloc(sizeof(LoraRxBenchState));
+    if(!state) {
+        return false;
+    }
+
+    memset(state, 0, sizeof(LoraRxBenchState));
+    memset(result, 0, sizeof(LoraRxBenchResult));
+    state->bench = bench;
+    state->result = result;
+    state->worker_at = LORA_RX_BENCH_NONE;
+    state->flush_at = LORA_RX_BENCH_NONE;
+    state->refresh_at = LORA_RX_BENCH_NONE;
+    state->tick_at = LORA_RX_BENCH_TICK_MS * 1000000ULL;
+    state->overhead = lora_rx_bench_clock_overhead(bench->clock);
+    lora_rx_path_init(
+        &state->rx,
+        lora_rx_framer_gap_ms(baud_rate),
+        bench->rssi_byte,
+        lora_rx_bench_packet_cb,
+        state);
+    lora_byte_log_reset(&state->history);
+    lora_rx_stats_reset(&state->stats, 0);
+    lora_refresh_limiter_init(&state->refresh, LORA_RX_BENCH_REFRESH_FPS);
+    result->baud_rate = baud_rate;
+
+    // 8N1, one interrupt per byte as the USART raises them
+    uint64_t char_ns = 10000000000ULL / baud_rate;
+    state->char_ns = char_ns;
+    uint64_t line_free = 0;
+    for(size_t p = 0; p < bench->count; p++) {
+        const LoraRxBenchPacket* packet = &bench->packets[p];
+        uint64_t start = line_free;
+        if(timed && packet->start_ms * 1000000ULL > start) {
+            start = packet->start_ms * 1000000ULL;
+        }
+
+        size_t length = packet->length + (bench->rssi_byte ? 1 : 0);
+        for(size_t i = 0; i < length; i++) {
+            uint64_t arrival = start + (i + 1) * char_ns;
+            lora_rx_bench_advance(state, arrival);
+            const uint8_t* byte = i < packet->length ? &packet->data[i] : &packet->rssi;
+            lora_rx_bench_isr(state, byte, 1, false);
+        }
+        uint64_t idle = start + (length + 1) * char_ns;
+        lora_rx_bench_advance(state, idle);
+        lora_rx_bench_isr(state, NULL, 0, true);
+        line_free = start + (length + LORA_RX_BENCH_GAP_CHARS) * char_ns;
+    }
+
+    // Long enough for the flush timer and a deferred refresh to catch up
+    lora_rx_bench_advance(state, line_free + 1000000000ULL);
+
+    result->bytes = state->rx.bytes;
+    result->packets = state->rx.framer.packets;
+    result->dropped = state->rx.ring.dropped;
+    result->duration_ms = line_free / 1000000;
+    result->latency_mean_us =
+        state->latency_count ? state->latency_sum / state->latency_count / 1000 : 0;
+    free(state);
+    return true;
+}
+
+bool lora_rx_bench_run(const LoraRxBench* bench, uint32_t baud_rate, LoraRxBenchResult* result) {
+    return lora_rx_bench_replay(bench, baud_rate, bench->timed, result);
+}
+
+/** Replay back to back until one attempt loses nothing
+ *
+ * A cost measured across an unrelated interrupt, or a host OS preemption, can fake
+ * an overrun once. Real saturation loses bytes on every attempt.
+ */
+static bool lora_rx_bench_sustains(const LoraRxBench* bench, uint32_t baud_rate) {
+    LoraRxBenchResult result;
+    for(int attempt = 0; attempt < LORA_RX_BENCH_ATTEMPTS; attempt++) {
+        if(!lora_rx_bench_replay(bench, baud_rate, false, &result)) {
+            return false;
+        }
+        if(!result.dropped && !result.overruns) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t lora_rx_bench_max_rate(const LoraRxBench* bench) {
+    uint32_t low = LORA_RX_BENCH_MIN_RATE;
+    uint32_t high = LORA_RX_BENCH_MAX_RATE;
+
+    if(!lora_rx_bench_sustains(bench, low)) {
+        return 0;
+    }
+    if(lora_rx_bench_sustains(bench, high)) {
+        return high;
+    }
+
+    // Step up fourfold while the bracket spans decades, then bisect to within 1%
+    for(int step = 0; step < LORA_RX_BENCH_SEARCH_STEPS && high - low > low / 100; step++) {
+        if(bench->stop && *bench->stop) {
+            break;
+        }
+        uint32_t middle = high / low > 4 ? low * 4 : low + (high - low) / 2;
+        if(lora_rx_bench_sustains(bench, middle)) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t lora_rx_bench_synthetic(
+    LoraRxBenchPacket* packets,
+    size_t max_packets,
+    uint8_t* buffer,
+    size_t size) {
+    // Full subpackets of every size the module can be set to, plus short telemetry frames
+    static const uint16_t lengths[] = {200, 12, 128, 1, 64, 32, 200, 24};
+    size_t count = 0;
+    size_t used = 0;
+
+    while(count < max_packets) {
+        uint16_t length = lengths[count % (sizeof(lengths) / sizeof(lengths[0]))];
+        if(used + length > size) {
+            break;
+        }
+        for(size_t i = 0; i < length; i++) {
+            buffer[used + i] = (uint8_t)((used + i) * 31 + count);
+        }
+        packets[count].data = &buffer[used];
+        packets[count].length = length;
+        packets[count].rssi = 0xA0 + count % 32;
+        packets[count].start_ms = 0;
+        used += length;
+        count++;
+    }
+    return count;
+}
+
+static uint32_t lora_rx_bench_get_u32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+size_t lora_rx_bench_parse_capture(
+    const uint8_t* image,
+    size_t size,
+    LoraRxBenchPacket* packets,
+    size_t max_packets,
+    uint32_t* baud_rate,
+    bool* rssi_byte) {
+    // Header and record layout written by lora_capture.c
+    const size_t header_size = 16;
+    const size_t record_header_size = 8;
+    size_t count = 0;
+    uint32_t first_tick = 0;
+
+    if(size < header_size || memcmp(image, "ECAP", 4) != 0 || image[4] != 1) {
+        return 0;
+    }
+    *baud_rate = lora_rx_bench_get_u32(&image[8]);
+    *rssi_byte = false;
+
+    size_t offset = header_size;
+    while(count < max_packets && offset + record_header_size <= size) {
+        const uint8_t* record = &image[offset];
+        uint32_t tick = lora_rx_bench_get_u32(record);
+        uint16_t length = record[4] | (record[5] << 8);
+        if(offset + record_header_size + length > size) {
+            break;
+        }
+        if(count == 0) {
+            first_tick = tick;
+        }
+
+        packets[count].data = &record[record_header_size];
+        packets[count].length = length;
+        packets[count].rssi = record[6];
+        packets[count].start_ms = tick - first_tick;
+        *rssi_byte |= record[7] & 1;
+        offset += record_header_size + length;
+        count++;
+    }
+    return count;
+}
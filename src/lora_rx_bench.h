@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Recorded stream replayed by the on-device benchmark when present, a renamed capture */
+#define LORA_RX_BENCH_CAPTURE_PATH "/ext/LoRa_Setting/captures/bench.bin"
+
+/** Largest capture image the benchmark loads */
+#define LORA_RX_BENCH_CAPTURE_MAX 16384
+
+/** Cycle counter the stage costs are read from, DWT->CYCCNT on the device */
+typedef uint32_t (*LoraRxBenchClock)(void);
+
+/** One packet of the stream fed to the receive path */
+typedef struct {
+    const uint8_t* data;
+    uint16_t length;
+    /** Sent after the data when the stream has RSSI bytes */
+    uint8_t rssi;
+    /** Milliseconds after the first packet it started, kept when replaying timed */
+    uint32_t start_ms;
+} LoraRxBenchPacket;
+
+typedef struct {
+    const LoraRxBenchPacket* packets;
+    size_t count;
+    /** Keep the recorded spacing, otherwise send packets back to back */
+    bool timed;
+    /** The module appends an RSSI byte to every packet */
+    bool rssi_byte;
+    LoraRxBenchClock clock;
+    uint32_t cycles_per_us;
+    /** Optional, checked between the replays of a max rate search */
+    const volatile bool* stop;
+} LoraRxBench;
+
+/** Replay of a stream at one rate
+ *
+ * Cycle counts are totals, divide by bytes or refreshes for the cost of one.
+ */
+typedef struct {
+    uint32_t baud_rate;
+    uint32_t bytes;
+    uint32_t packets;
+    /** Ring full, the worker fell behind */
+    uint32_t dropped;
+    /** USART overrun, the ISR itself couldn't keep up */
+    uint32_t overruns;
+    uint32_t refreshes;
+    uint64_t isr_cycles;
+    uint64_t worker_cycles;
+    uint64_t refresh_cycles;
+    /** Line idle at the end of a packet to the end of the refresh showing it */
+    uint32_t latency_mean_us;
+    uint32_t latency_max_us;
+    /** Emulated time on the wire */
+    uint32_t duration_ms;
+} LoraRxBenchResult;
+
+/** Push a stream through the receive scene's ISR, worker and refresh code
+ *
+ * Bytes arrive one per interrupt at baud_rate on an emulated timeline. Each
+ * stage really runs and its measured cost is charged to that timeline as on
+ * a single core: the ISR preempts, the worker and the view refresh take
+ * turns. Drops happen when the worker falls behind, as they would on the
+ * device.
+ *
+ * @return     false if the working state couldn't be allocated
+ */
+bool lora_rx_bench_run(const LoraRxBench* bench, uint32_t baud_rate, LoraRxBenchResult* result);
+
+/** Highest rate the stream replays at without a drop or overrun, sent back to back
+ *
+ * Searched between 1200 baud and 100 Mbaud, far beyond what the USART does, so the
+ * answer is the headroom of the code rather than of the hardware.
+ *
+ * @return     rate in baud, 0 if bytes are lost even at the lowest rate, the best
+ *             found so far when stopped
+ */
+uint32_t lora_rx_bench_max_rate(const LoraRxBench* bench);
+
+/** Fill buffer with a mix of packet sizes up to a full subpacket
+ *
+ * @return     number of packets written to packets
+ */
+size_t lora_rx_bench_synthetic(
+    LoraRxBenchPacket* packets,
+    size_t max_packets,
+    uint8_t* buffer,
+    size_t size);
+
+/** Packets of a capture file image, pointing into it, see lora_capture.h for the layout
+ *
+ * A record cut short by the end of the image is left out.
+ *
+ * @param      baud_rate  receives the rate the capture was taken at
+ * @param      rssi_byte  set if the records carry RSSI values
+ *
+ * @return     number of packets, 0 if the image isn't a capture
+ */
+size_t lora_rx_bench_parse_capture(
+    const uint8_t* image,
+    size_t size,
+    LoraRxBenchPacket* packets,
+    size_t max_packets,
+    uint32_t* baud_rate,
+    bool* rssi_byte);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,94 @@
+#include "lora_rx_framer.h"
+#include <string.h>
+
+uint32_t lora_rx_framer_gap_ms(uint32_t baud_rate) {
+    if(baud_rate == 0) {
+        return 2;
+    }
+    // 10 bits per character, 3.5 characters, rounded up
+    uint32_t gap_ms = (35 * 1000 + baud_rate - 1) / baud_rate;
+    return gap_ms < 2 ? 2 : gap_ms;
+}
+
+void lora_rx_framer_init(
+    LoraRxFramer* framer,
+    uint32_t gap_ms,
+    bool rssi_byte,
+    LoraRxFramerCallback callback,
+    void* context) {
+    framer->length = 0;
+    framer->start_tick = 0;
+    framer->last_tick = 0;
+    framer->gap_ms = gap_ms;
+    framer->rssi_byte = rssi_byte;
+    framer->callback = callback;
+    framer->context = context;
+    framer->packets = 0;
+    framer->splits = 0;
+}
+
+static void lora_rx_framer_emit(LoraRxFramer* framer) {
+    LoraRxPacket packet = {
+        .start_tick = framer->start_tick,
+        .length = framer->length,
+        .has_rssi = false,
+        .rssi = 0,
+        .data = framer->buffer,
+    };
+
+    if(framer->rssi_byte && packet.length > 1) {
+        packet.has_rssi = true;
+        packet.length--;
+        packet.rssi = framer->buffer[packet.length];
+    }
+
+    framer->packets++;
+    framer->length = 0;
+    if(framer->callback) {
+        framer->callback(&packet, framer->context);
+    }
+}
+
+void lora_rx_framer_push(LoraRxFramer* framer, const uint8_t* data, size_t length, uint32_t tick) {
+    while(length > 0) {
+        if(framer->length == 0) {
+            framer->start_tick = tick;
+        }
+
+        size_t space = LORA_RX_FRAMER_MAX_PACKET - framer->length;
+        size_t chunk = length < space ? length : space;
+        memcpy(&framer->buffer[framer->length], data, chunk);
+        framer->length += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if(framer->length == LORA_RX_FRAMER_MAX_PACKET) {
+            // No boundary seen for a whole buffer, e.g. a continuous stream
+            framer->splits++;
+            lora_rx_framer_emit(framer);
+        }
+    }
+    framer->last_tick = tick;
+}
+
+void lora_rx_framer_set_start_tick(LoraRxFramer* framer, uint32_t tick) {
+    if(framer->length > 0) {
+        framer->start_tick = tick;
+    }
+}
+
+void lora_rx_framer_end(LoraRxFramer* framer) {
+    if(framer->length > 0) {
+        lora_rx_framer_emit(framer);
+    }
+}
+
+void lora_rx_framer_poll(LoraRxFramer* framer, uint32_t tick) {
+    if(framer->length > 0 && tick - framer->last_tick >= framer->gap_ms) {
+        lora_rx_framer_emit(framer);
+    }
+}
+
+bool lora_rx_framer_pending(const LoraRxFramer* framer) {
+    return framer->length > 0;
+}
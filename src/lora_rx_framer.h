@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest packet kept in one record; longer runs are split. Sub-packets are at most 200 bytes. */
+#define LORA_RX_FRAMER_MAX_PACKET 256
+
+/** One received packet */
+typedef struct {
+    uint32_t start_tick;
+    uint16_t length;
+    bool has_rssi;
+    uint8_t rssi;
+    const uint8_t* data;
+} LoraRxPacket;
+
+/** Called for every completed packet; data is only valid during the call */
+typedef void (*LoraRxFramerCallback)(const LoraRxPacket* packet, void* context);
+
+/** Splits a received byte stream into packets.
+ *
+ * Boundaries come from the caller (UART idle line, AUX rising edge) through
+ * lora_rx_framer_end(), with an inter-byte gap timeout as fallback.
+ */
+typedef struct {
+    uint8_t buffer[LORA_RX_FRAMER_MAX_PACKET];
+    size_t length;
+    uint32_t start_tick;
+    uint32_t last_tick;
+    uint32_t gap_ms;
+    bool rssi_byte;
+    LoraRxFramerCallback callback;
+    void* context;
+    uint32_t packets;
+    uint32_t splits;
+} LoraRxFramer;
+
+/** Inter-byte gap that ends a packet at the given UART rate: 3.5 characters, at least 2 ms */
+uint32_t lora_rx_framer_gap_ms(uint32_t baud_rate);
+
+/** Initialize framer
+ *
+ * @param      rssi_byte  the module appends an RSSI byte to every packet
+ */
+void lora_rx_framer_init(
+    LoraRxFramer* framer,
+    uint32_t gap_ms,
+    bool rssi_byte,
+    LoraRxFramerCallback callback,
+    void* context);
+
+/** Feed received bytes, tick is when they were taken from the UART */
+void lora_rx_framer_push(LoraRxFramer* framer, const uint8_t* data, size_t length, uint32_t tick);
+
+/** Override the start tick of the packet being assembled */
+void lora_rx_framer_set_start_tick(LoraRxFramer* framer, uint32_t tick);
+
+/** Complete the packet being assembled, if any */
+void lora_rx_framer_end(LoraRxFramer* framer);
+
+/** Complete the packet being assembled if no byte arrived for gap_ms */
+void lora_rx_framer_poll(LoraRxFramer* framer, uint32_t tick);
+
+/** Whether a packet is being assembled */
+bool lora_rx_framer_pending(const LoraRxFramer* framer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+#include "lora_rx_path.h"
+
+void lora_rx_path_init(
+    LoraRxPath* path,
+    uint32_t gap_ms,
+    bool rssi_byte,
+    LoraRxFramerCallback callback,
+    void* context) {
+    lora_rx_ring_reset(&path->ring);
+    lora_rx_framer_init(&path->framer, gap_ms, rssi_byte, callback, context);
+    path->frame_open = false;
+    path->frame_start = 0;
+    path->bytes = 0;
+    path->wakeups = 0;
+}
+
+uint32_t lora_rx_path_isr(
+    LoraRxPath* path,
+    const uint8_t* data,
+    size_t length,
+    bool idle,
+    uint32_t tick) {
+    uint32_t wake = 0;
+
+    if(length) {
+        if(!path->frame_open) {
+            path->frame_open = true;
+            path->frame_start = tick;
+        }
+        size_t before = lora_rx_ring_count(&path->ring);
+        for(size_t i = 0; i < length; i++) {
+            lora_rx_ring_push(&path->ring, data[i]);
+        }
+        // Wake the worker once per crossing, not once per byte
+        if(before < LORA_RX_PATH_HIGH_WATER_MARK &&
+           lora_rx_ring_count(&path->ring) >= LORA_RX_PATH_HIGH_WATER_MARK) {
+            wake |= LoraRxPathWakeData;
+        }
+    }
+
+    if(idle) {
+        // The line went quiet for a character time: the packet ends here
+        if(path->frame_open) {
+            lora_rx_ring_mark(&path->ring, path->frame_start);
+            path->frame_open = false;
+        }
+        wake |= LoraRxPathWakeIdle;
+    }
+
+    return wake;
+}
+
+uint32_t lora_rx_path_drain(LoraRxPath* path, uint32_t now, bool aux_end) {
+    LoraRxFramer* framer = &path->framer;
+    uint32_t packets = framer->packets;
+    uint8_t data[LORA_RX_PATH_CHUNK];
+    bool end_of_frame;
+    LoraRxRingMark mark;
+
+    path->wakeups++;
+    while(true) {
+        size_t length =
+            lora_rx_ring_pop_frame(&path->ring, data, sizeof(data), &end_of_frame, &mark);
+        if(length == 0 && !end_of_frame) {
+            break;
+        }
+        path->bytes += length;
+        lora_rx_framer_push(framer, data, length, now);
+        if(end_of_frame) {
+            lora_rx_framer_set_start_tick(framer, mark.start_tick);
+            lora_rx_framer_end(framer);
+        }
+    }
+
+    if(aux_end) {
+        lora_rx_framer_end(framer);
+    } else {
+        // Fallback for a missed idle/AUX edge
+        lora_rx_framer_poll(framer, now);
+    }
+
+    return framer->packets - packets;
+}
+
+bool lora_rx_path_pending(const LoraRxPath* path) {
+    return lora_rx_ring_count(&path->ring) || lora_rx_framer_pending(&path->framer);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "lora_rx_ring.h"
+#include "lora_rx_framer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Queued bytes at which the ISR wakes the worker without waiting for a boundary */
+#define LORA_RX_PATH_HIGH_WATER_MARK (LORA_RX_RING_SIZE / 2)
+
+/** Bytes the worker moves from the ring to the framer per copy */
+#define LORA_RX_PATH_CHUNK 256
+
+typedef enum {
+    /** The ring crossed the high water mark */
+    LoraRxPathWakeData = (1 << 0),
+    /** The line went idle, a frame may have ended */
+    LoraRxPathWakeIdle = (1 << 1),
+} LoraRxPathWake;
+
+/** Receive path from the UART interrupt to completed packets.
+ *
+ * lora_rx_path_isr runs in the UART callback and only touches the ring, so
+ * it stays lock free. lora_rx_path_drain runs on the receive worker and
+ * feeds the framer, whose callback gets each packet.
+ */
+typedef struct {
+    LoraRxRing ring;
+    LoraRxFramer framer;
+    bool frame_open;
+    uint32_t frame_start;
+    uint32_t bytes;
+    uint32_t wakeups;
+} LoraRxPath;
+
+void lora_rx_path_init(
+    LoraRxPath* path,
+    uint32_t gap_ms,
+    bool rssi_byte,
+    LoraRxFramerCallback callback,
+    void* context);
+
+/** Queue bytes from the UART callback, an idle line ends the frame
+ *
+ * @param      tick  when the bytes arrived
+ *
+ * @return     LoraRxPathWake flags the worker should be woken with, 0 for none
+ */
+uint32_t lora_rx_path_isr(
+    LoraRxPath* path,
+    const uint8_t* data,
+    size_t length,
+    bool idle,
+    uint32_t tick);
+
+/** Move queued bytes into the framer, worker side
+ *
+ * @param      aux_end  AUX rose, the module has finished writing a packet
+ *
+ * @return     packets completed by this call
+ */
+uint32_t lora_rx_path_drain(LoraRxPath* path, uint32_t now, bool aux_end);
+
+/** Bytes are waiting in the ring or the framer, keep the flush timer armed */
+bool lora_rx_path_pending(const LoraRxPath* path);
+
+#ifdef __cplusplus
+}
+#endif
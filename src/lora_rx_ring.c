@@ -0,0 +1,115 @@
+#include "lora_rx_ring.h"
+#include <string.h>
+
+#define LORA_RX_RING_MASK (LORA_RX_RING_SIZE - 1)
+#define LORA_RX_RING_MARK_MASK (LORA_RX_RING_MARKS - 1)
+
+_Static_assert(
+    (LORA_RX_RING_SIZE & LORA_RX_RING_MASK) == 0,
+    "LORA_RX_RING_SIZE must be a power of two");
+_Static_assert(
+    (LORA_RX_RING_MARKS & LORA_RX_RING_MARK_MASK) == 0,
+    "LORA_RX_RING_MARKS must be a power of two");
+
+void lora_rx_ring_reset(LoraRxRing* ring) {
+    __atomic_store_n(&ring->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tail, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->mark_head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->mark_tail, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->marks_dropped, 0, __ATOMIC_RELAXED);
+}
+
+bool lora_rx_ring_push(LoraRxRing* ring, uint8_t data) {
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if(head - tail >= LORA_RX_RING_SIZE) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    ring->buffer[head & LORA_RX_RING_MASK] = data;
+    // Publish the byte before the new head becomes visible to the consumer
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool lora_rx_ring_mark(LoraRxRing* ring, uint32_t start_tick) {
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t mark_head = __atomic_load_n(&ring->mark_head, __ATOMIC_RELAXED);
+    uint32_t mark_tail = __atomic_load_n(&ring->mark_tail, __ATOMIC_ACQUIRE);
+
+    // The slot of the newest mark is only reused after it was consumed and a
+    // new mark was queued, so it still holds the last position even if empty
+    if(mark_head != 0 && ring->marks[(mark_head - 1) & LORA_RX_RING_MARK_MASK].position == head) {
+        return true;
+    }
+    if(mark_head - mark_tail >= LORA_RX_RING_MARKS) {
+        __atomic_store_n(&ring->marks_dropped, ring->marks_dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    LoraRxRingMark* mark = &ring->marks[mark_head & LORA_RX_RING_MARK_MASK];
+    mark->position = head;
+    mark->start_tick = start_tick;
+    __atomic_store_n(&ring->mark_head, mark_head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t lora_rx_ring_count(const LoraRxRing* ring) {
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+size_t lora_rx_ring_pop(LoraRxRing* ring, uint8_t* buffer, size_t max_len) {
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+
+    size_t available = head - tail;
+    size_t length = available < max_len ? available : max_len;
+    if(length == 0) {
+        return 0;
+    }
+
+    // Copy in at most two runs: up to the end of storage, then from the start
+    size_t offset = tail & LORA_RX_RING_MASK;
+    size_t first = LORA_RX_RING_SIZE - offset;
+    if(first > length) {
+        first = length;
+    }
+    memcpy(buffer, &ring->buffer[offset], first);
+    memcpy(buffer + first, ring->buffer, length - first);
+
+    __atomic_store_n(&ring->tail, tail + length, __ATOMIC_RELEASE);
+    return length;
+}
+
+size_t lora_rx_ring_pop_frame(
+    LoraRxRing* ring,
+    uint8_t* buffer,
+    size_t max_len,
+    bool* end_of_frame,
+    LoraRxRingMark* mark) {
+    *end_of_frame = false;
+
+    uint32_t mark_head = __atomic_load_n(&ring->mark_head, __ATOMIC_ACQUIRE);
+    uint32_t mark_tail = __atomic_load_n(&ring->mark_tail, __ATOMIC_RELAXED);
+    if(mark_head == mark_tail) {
+        return lora_rx_ring_pop(ring, buffer, max_len);
+    }
+
+    const LoraRxRingMark* next = &ring->marks[mark_tail & LORA_RX_RING_MARK_MASK];
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    size_t to_mark = next->position - tail;
+
+    size_t length = lora_rx_ring_pop(ring, buffer, to_mark < max_len ? to_mark : max_len);
+    if(length == to_mark) {
+        *end_of_frame = true;
+        *mark = *next;
+        __atomic_store_n(&ring->mark_tail, mark_tail + 1, __ATOMIC_RELEASE);
+    }
+
+    return length;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Ring capacity in bytes, must be a power of two */
+#define LORA_RX_RING_SIZE 1024
+/** Number of frame boundaries that can be queued, must be a power of two */
+#define LORA_RX_RING_MARKS 16
+
+/** Frame boundary recorded by the producer */
+typedef struct {
+    uint32_t position;
+    uint32_t start_tick;
+} LoraRxRingMark;
+
+/** Single-producer/single-consumer byte ring.
+ *
+ * The UART ISR is the only producer and the receive worker is the only
+ * consumer, so head and tail are each written by one side only and no lock
+ * is needed. The producer can also queue frame boundaries (marks), which the
+ * consumer gets back in order with lora_rx_ring_pop_frame().
+ */
+typedef struct {
+    uint8_t buffer[LORA_RX_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    LoraRxRingMark marks[LORA_RX_RING_MARKS];
+    uint32_t mark_head;
+    uint32_t mark_tail;
+    uint32_t marks_dropped;
+} LoraRxRing;
+
+/** Empty the ring and clear the drop counters. Not ISR safe. */
+void lora_rx_ring_reset(LoraRxRing* ring);
+
+/** Append one byte, producer side (ISR)
+ *
+ * @return     false if the ring was full and the byte was dropped
+ */
+bool lora_rx_ring_push(LoraRxRing* ring, uint8_t data);
+
+/** End the current frame at the current write position, producer side (ISR)
+ *
+ * Does nothing if no byte was pushed since the previous mark.
+ *
+ * @param      start_tick  tick of the first byte of the frame
+ *
+ * @return     false if the mark queue was full and the mark was dropped
+ */
+bool lora_rx_ring_mark(LoraRxRing* ring, uint32_t start_tick);
+
+/** Number of bytes waiting in the ring, safe from either side */
+size_t lora_rx_ring_count(const LoraRxRing* ring);
+
+/** Move up to max_len bytes into buffer, consumer side
+ *
+ * @return     number of bytes copied
+ */
+size_t lora_rx_ring_pop(LoraRxRing* ring, uint8_t* buffer, size_t max_len);
+
+/** Like lora_rx_ring_pop(), but never reads past the next frame boundary
+ *
+ * @param      end_of_frame  set to true if the bytes returned end a frame;
+ *                           the boundary is consumed and may come with zero
+ *                           bytes
+ * @param      mark          receives the boundary when end_of_frame is set
+ *
+ * @return     number of bytes copied
+ */
+size_t lora_rx_ring_pop_frame(
+    LoraRxRing* ring,
+    uint8_t* buffer,
+    size_t max_len,
+    bool* end_of_frame,
+    LoraRxRingMark* mark);
+
+#ifdef __cplusplus
+}
+#endif
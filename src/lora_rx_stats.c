@@ -0,0 +1,185 @@
+#include "lora_rx_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t window_seconds[LoraRxStatsWindowCount] = {1, 10, 60};
+
+static void bucket_add(LoraRxStatsBucket* total, const LoraRxStatsBucket* bucket) {
+    total->bytes += bucket->bytes;
+    total->packets += bucket->packets;
+    total->gaps += bucket->gaps;
+    total->gap_sum += bucket->gap_sum;
+    total->gap_square_sum += bucket->gap_square_sum;
+}
+
+static void bucket_subtract(LoraRxStatsBucket* total, const LoraRxStatsBucket* bucket) {
+    total->bytes -= bucket->bytes;
+    total->packets -= bucket->packets;
+    total->gaps -= bucket->gaps;
+    total->gap_sum -= bucket->gap_sum;
+    total->gap_square_sum -= bucket->gap_square_sum;
+}
+
+static uint32_t isqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while(bit > value) {
+        bit >>= 2;
+    }
+    while(bit) {
+        if(value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/** Move the current bucket forward to now, dropping expired buckets from each window */
+static void lora_rx_stats_advance(LoraRxStats* stats, uint32_t now_ms) {
+    uint32_t second = (now_ms - stats->start_tick) / 1000;
+    uint32_t steps = second - stats->second;
+    // After a full lap every bucket has been cleared, the rest would be no-ops
+    if(steps > LORA_RX_STATS_BUCKETS) {
+        steps = LORA_RX_STATS_BUCKETS;
+    }
+
+    for(uint32_t step = 0; step < steps; step++) {
+        stats->second++;
+        for(size_t window = 0; window < LoraRxStatsWindowCount; window++) {
+            if(stats->second > window_seconds[window]) {
+                uint32_t expired = stats->second - window_seconds[window] - 1;
+                bucket_subtract(
+                    &stats->totals[window], &stats->buckets[expired % LORA_RX_STATS_BUCKETS]);
+            }
+        }
+        memset(
+            &stats->buckets[stats->second % LORA_RX_STATS_BUCKETS], 0, sizeof(LoraRxStatsBucket));
+    }
+    stats->second = second;
+}
+
+void lora_rx_stats_reset(LoraRxStats* stats, uint32_t now_ms) {
+    memset(stats, 0, sizeof(LoraRxStats));
+    stats->start_tick = now_ms;
+}
+
+void lora_rx_stats_add(LoraRxStats* stats, uint32_t size, uint32_t tick) {
+    lora_rx_stats_advance(stats, tick);
+
+    LoraRxStatsBucket sample = {.bytes = size, .packets = 1};
+    if(stats->has_arrival) {
+        uint64_t gap = tick - stats->last_arrival;
+        sample.gaps = 1;
+        sample.gap_sum = gap;
+        sample.gap_square_sum = gap * gap;
+    }
+    stats->last_arrival = tick;
+    stats->has_arrival = true;
+
+    LoraRxStatsBucket* bucket = &stats->buckets[stats->second % LORA_RX_STATS_BUCKETS];
+    bucket_add(bucket, &sample);
+    if(size > bucket->max_size) {
+        bucket->max_size = size;
+    }
+    for(size_t window = 0; window < LoraRxStatsWindowCount; window++) {
+        bucket_add(&stats->totals[window], &sample);
+    }
+}
+
+void lora_rx_stats_get(
+    LoraRxStats* stats,
+    LoraRxStatsWindow window,
+    uint32_t now_ms,
+    LoraRxStatsSummary* summary) {
+    lora_rx_stats_advance(stats, now_ms);
+
+    const LoraRxStatsBucket* total = &stats->totals[window];
+    uint32_t seconds = window_seconds[window];
+
+    // The window is its finished seconds plus the part of the current one so
+    // far, so it doesn't drop to nothing as each second rolls over
+    uint32_t elapsed = now_ms - stats->start_tick;
+    uint32_t span = seconds * 1000 + elapsed % 1000;
+    if(span > elapsed) {
+        span = elapsed;
+    }
+    if(span == 0) {
+        span = 1;
+    }
+
+    summary->bytes_per_s = (uint64_t)total->bytes * 1000 / span;
+    summary->packets_per_10s = (uint64_t)total->packets * 10000 / span;
+    summary->mean_size = total->packets ? total->bytes / total->packets : 0;
+
+    summary->max_size = 0;
+    for(uint32_t back = 0; back <= seconds && back <= stats->second; back++) {
+        const LoraRxStatsBucket* bucket =
+            &stats->buckets[(stats->second - back) % LORA_RX_STATS_BUCKETS];
+        if(bucket->max_size > summary->max_size) {
+            summary->max_size = bucket->max_size;
+        }
+    }
+
+    summary->jitter_ms = 0;
+    if(total->gaps > 1) {
+        uint64_t mean = total->gap_sum / total->gaps;
+        uint64_t mean_square = total->gap_square_sum / total->gaps;
+        summary->jitter_ms = mean_square > mean * mean ? isqrt(mean_square - mean * mean) : 0;
+    }
+}
+
+void lora_rx_stats_format_panel(
+    const LoraRxStatsSummary summary[LoraRxStatsWindowCount],
+    char* panel,
+    size_t size) {
+    char cells[LoraRxStatsWindowCount][5][12];
+
+    // Cast for hosts where uint32_t isn't unsigned long, the panel also runs in the benchmark
+    for(size_t window = 0; window < LoraRxStatsWindowCount; window++) {
+        const LoraRxStatsSummary* s = &summary[window];
+        snprintf(cells[window][0], 12, "%lu", (unsigned long)s->bytes_per_s);
+        snprintf(
+            cells[window][1],
+            12,
+            "%lu.%lu",
+            (unsigned long)s->packets_per_10s / 10,
+            (unsigned long)s->packets_per_10s % 10);
+        snprintf(cells[window][2], 12, "%lu", (unsigned long)s->mean_size);
+        snprintf(cells[window][3], 12, "%lu", (unsigned long)s->max_size);
+        snprintf(cells[window][4], 12, "%lu", (unsigned long)s->jitter_ms);
+    }
+
+    // Fixed-width columns for the monospace panel font
+    snprintf(
+        panel,
+        size,
+        "%-3s%6s%6s%6s\n"
+        "B/s%6s%6s%6s\n"
+        "P/s%6s%6s%6s\n"
+        "Avg%6s%6s%6s\n"
+        "Max%6s%6s%6s\n"
+        "Jms%6s%6s%6s",
+        "",
+        "1s",
+        "10s",
+        "60s",
+        cells[0][0],
+        cells[1][0],
+        cells[2][0],
+        cells[0][1],
+        cells[1][1],
+        cells[2][1],
+        cells[0][2],
+        cells[1][2],
+        cells[2][2],
+        cells[0][3],
+        cells[1][3],
+        cells[2][3],
+        cells[0][4],
+        cells[1][4],
+        cells[2][4]);
+}
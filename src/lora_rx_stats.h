@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One-second buckets kept, the longest window plus the current second */
+#define LORA_RX_STATS_BUCKETS 64
+
+typedef enum {
+    LoraRxStatsWindow1s,
+    LoraRxStatsWindow10s,
+    LoraRxStatsWindow60s,
+    LoraRxStatsWindowCount,
+} LoraRxStatsWindow;
+
+typedef struct {
+    uint32_t bytes;
+    uint32_t packets;
+    uint32_t max_size;
+    uint32_t gaps;
+    uint64_t gap_sum;
+    uint64_t gap_square_sum;
+} LoraRxStatsBucket;
+
+/** Rolling receive statistics over 1 s, 10 s and 60 s windows.
+ *
+ * Packets land in per-second buckets and each window keeps running sums that
+ * are adjusted as buckets enter and leave it, so recording a packet or moving
+ * to the next second is O(1). Only the maximum size is rescanned, on query.
+ */
+typedef struct {
+    LoraRxStatsBucket buckets[LORA_RX_STATS_BUCKETS];
+    LoraRxStatsBucket totals[LoraRxStatsWindowCount];
+    uint32_t start_tick;
+    uint32_t second;
+    uint32_t last_arrival;
+    bool has_arrival;
+} LoraRxStats;
+
+typedef struct {
+    uint32_t bytes_per_s;
+    /** Packets per second, in tenths */
+    uint32_t packets_per_10s;
+    uint32_t mean_size;
+    uint32_t max_size;
+    /** Standard deviation of packet inter-arrival time */
+    uint32_t jitter_ms;
+} LoraRxStatsSummary;
+
+void lora_rx_stats_reset(LoraRxStats* stats, uint32_t now_ms);
+
+/** Record a packet of size bytes that started arriving at tick */
+void lora_rx_stats_add(LoraRxStats* stats, uint32_t size, uint32_t tick);
+
+/** Summarize one window as of now_ms */
+void lora_rx_stats_get(
+    LoraRxStats* stats,
+    LoraRxStatsWindow window,
+    uint32_t now_ms,
+    LoraRxStatsSummary* summary);
+
+/** Text of lora_rx_stats_format_panel: six lines of 21 characters */
+#define LORA_RX_STATS_PANEL_SIZE (6 * (21 + 1) + 1)
+
+/** Table of every window's summary in fixed-width columns for a monospace font */
+void lora_rx_stats_format_panel(
+    const LoraRxStatsSummary summary[LoraRxStatsWindowCount],
+    char* panel,
+    size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+#include "lora_survey_view.h"
+#include <gui/elements.h>
+#include <string.h>
+
+#define SURVEY_VIEW_HEADER_SIZE 32
+#define SURVEY_VIEW_GRAPH_TOP 15
+#define SURVEY_VIEW_GRAPH_BOTTOM 52
+/** Row under the bars where the channel being measured is underlined */
+#define SURVEY_VIEW_CURSOR_Y 54
+/** Smallest span the bars are scaled to, so a flat noise floor doesn't look like a spread */
+#define SURVEY_VIEW_MIN_SPAN_DBM 10
+
+struct LoraSurveyView {
+    View* view;
+    LoraSurveyViewStepCallback callback;
+    void* context;
+};
+
+typedef struct {
+    const LoraSurvey* survey;
+    FuriMutex* mutex;
+    char header[SURVEY_VIEW_HEADER_SIZE];
+} LoraSurveyViewModel;
+
+static void lora_survey_view_draw_marker(Canvas* canvas, uint8_t x, uint8_t y) {
+    // Downward arrow head with its tip at x, y
+    canvas_draw_line(canvas, x - 2, y - 2, x + 2, y - 2);
+    canvas_draw_line(canvas, x - 1, y - 1, x + 1, y - 1);
+    canvas_draw_dot(canvas, x, y);
+}
+
+static void lora_survey_view_draw_callback(Canvas* canvas, void* _model) {
+    LoraSurveyViewModel* model = _model;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+    canvas_draw_str(canvas, 0, 7, model->header);
+    canvas_draw_line(canvas, 0, 9, 127, 9);
+
+    if(!model->survey) {
+        return;
+    }
+
+    furi_mutex_acquire(model->mutex, FuriWaitForever);
+
+    const LoraSurvey* survey = model->survey;
+    if(survey->channels == 0) {
+        furi_mutex_release(model->mutex);
+        return;
+    }
+
+    int quietest = lora_survey_quietest(survey);
+    int16_t low = 0;
+    int16_t span = SURVEY_VIEW_MIN_SPAN_DBM;
+    if(quietest >= 0) {
+        int16_t high = survey->noise[quietest];
+        for(size_t i = 0; i < survey->channels; i++) {
+            if(survey->noise[i] != LORA_SURVEY_NO_DATA && survey->noise[i] > high) {
+                high = survey->noise[i];
+            }
+        }
+        low = survey->noise[quietest];
+        if(high - low > span) {
+            span = high - low;
+        }
+    }
+
+    uint8_t width = 128 / survey->channels;
+    uint8_t left = (128 - width * survey->channels) / 2;
+    int32_t height = SURVEY_VIEW_GRAPH_BOTTOM - SURVEY_VIEW_GRAPH_TOP;
+    for(size_t i = 0; i < survey->channels; i++) {
+        uint8_t x = left + i * width;
+        if(survey->noise[i] == LORA_SURVEY_NO_DATA) {
+            canvas_draw_dot(canvas, x + width / 2, SURVEY_VIEW_GRAPH_BOTTOM);
+        } else {
+            // The quietest channel keeps a one pixel bar so it reads as measured
+            uint8_t bar = 1 + (int32_t)(survey->noise[i] - low) * (height - 1) / span;
+            canvas_draw_box(canvas, x, SURVEY_VIEW_GRAPH_BOTTOM + 1 - bar, width - 1, bar);
+            if((int)i == quietest) {
+                lora_survey_view_draw_marker(
+                    canvas, x + (width - 1) / 2, SURVEY_VIEW_GRAPH_BOTTOM - bar - 1);
+            }
+        }
+        if(i == survey->current) {
+            canvas_draw_line(canvas, x, SURVEY_VIEW_CURSOR_Y, x + width - 2, SURVEY_VIEW_CURSOR_Y);
+        }
+    }
+
+    char text[SURVEY_VIEW_HEADER_SIZE];
+    if(quietest >= 0) {
+        snprintf(
+            text, sizeof(text), "Quietest: ch %d, %ddBm", quietest, survey->noise[quietest]);
+    } else {
+        snprintf(text, sizeof(text), "Measuring...");
+    }
+    furi_mutex_release(model->mutex);
+
+    canvas_draw_str(canvas, 0, 63, text);
+}
+
+static bool lora_survey_view_input_callback(InputEvent* event, void* context) {
+    LoraSurveyView* survey_view = context;
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+    if(event->key != InputKeyLeft && event->key != InputKeyRight) {
+        return false;
+    }
+    if(survey_view->callback) {
+        survey_view->callback(event->key == InputKeyRight ? 1 : -1, survey_view->context);
+    }
+    return true;
+}
+
+LoraSurveyView* lora_survey_view_alloc(void) {
+    LoraSurveyView* survey_view = malloc(sizeof(LoraSurveyView));
+    survey_view->view = view_alloc();
+    survey_view->callback = NULL;
+    survey_view->context = NULL;
+    view_set_context(survey_view->view, survey_view);
+    view_allocate_model(survey_view->view, ViewModelTypeLocking, sizeof(LoraSurveyViewModel));
+    view_set_draw_callback(survey_view->view, lora_survey_view_draw_callback);
+    view_set_input_callback(survey_view->view, lora_survey_view_input_callback);
+
+    lora_survey_view_set_source(survey_view, NULL, NULL);
+
+    return survey_view;
+}
+
+void lora_survey_view_free(LoraSurveyView* survey_view) {
+    furi_assert(survey_view);
+    view_free(survey_view->view);
+    free(survey_view);
+}
+
+View* lora_survey_view_get_view(LoraSurveyView* survey_view) {
+    furi_assert(survey_view);
+    return survey_view->view;
+}
+
+void lora_survey_view_set_source(
+    LoraSurveyView* survey_view,
+    const LoraSurvey* survey,
+    FuriMutex* mutex) {
+    furi_assert(survey_view);
+    furi_assert(!survey || mutex);
+    with_view_model(
+        survey_view->view,
+        LoraSurveyViewModel * model,
+        {
+            model->survey = survey;
+            model->mutex = mutex;
+            model->header[0] = '\0';
+        },
+        true);
+}
+
+void lora_survey_view_set_step_callback(
+    LoraSurveyView* survey_view,
+    LoraSurveyViewStepCallback callback,
+    void* context) {
+    furi_assert(survey_view);
+    survey_view->callback = callback;
+    survey_view->context = context;
+}
+
+void lora_survey_view_set_header(LoraSurveyView* survey_view, const char* text) {
+    furi_assert(survey_view);
+    with_view_model(
+        survey_view->view,
+        LoraSurveyViewModel * model,
+        { snprintf(model->header, sizeof(model->header), "%s", text); },
+        true);
+}
+
+void lora_survey_view_update(LoraSurveyView* survey_view) {
+    furi_assert(survey_view);
+    with_view_model(survey_view->view, LoraSurveyViewModel * model, { UNUSED(model); }, true);
+}
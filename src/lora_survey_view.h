@@ -0,0 +1,79 @@
+#pragma once
+
+#include <gui/view.h>
+#include <furi.h>
+#include "lora_rssi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Channel survey view anonymous structure */
+typedef struct LoraSurveyView LoraSurveyView;
+
+/** Called from the GUI thread when Left (-1) or Right (+1) is pressed */
+typedef void (*LoraSurveyViewStepCallback)(int8_t step, void* context);
+
+/** Allocate and initialize channel survey view
+ *
+ * Draws one bar per channel of a LoraSurvey, taller for more noise, with
+ * the quietest channel marked and the channel being measured underlined.
+ *
+ * @return     LoraSurveyView instance
+ */
+LoraSurveyView* lora_survey_view_alloc(void);
+
+/** Deinitialize and free channel survey view
+ *
+ * @param      survey_view  LoraSurveyView instance
+ */
+void lora_survey_view_free(LoraSurveyView* survey_view);
+
+/** Get channel survey view
+ *
+ * @param      survey_view  LoraSurveyView instance
+ *
+ * @return     View instance that can be used for embedding
+ */
+View* lora_survey_view_get_view(LoraSurveyView* survey_view);
+
+/** Set the survey to display
+ *
+ * The survey must outlive the view or be detached with NULL first.
+ *
+ * @param      survey_view  LoraSurveyView instance
+ * @param      survey       survey table, or NULL to detach
+ * @param      mutex        mutex guarding writes to the survey
+ */
+void lora_survey_view_set_source(
+    LoraSurveyView* survey_view,
+    const LoraSurvey* survey,
+    FuriMutex* mutex);
+
+/** Set the Left/Right callback
+ *
+ * @param      survey_view  LoraSurveyView instance
+ * @param      callback     step callback, or NULL
+ * @param      context      callback context
+ */
+void lora_survey_view_set_step_callback(
+    LoraSurveyView* survey_view,
+    LoraSurveyViewStepCallback callback,
+    void* context);
+
+/** Set the status line and redraw
+ *
+ * @param      survey_view  LoraSurveyView instance
+ * @param      text         status text, copied
+ */
+void lora_survey_view_set_header(LoraSurveyView* survey_view, const char* text);
+
+/** Redraw with whatever the survey holds now
+ *
+ * @param      survey_view  LoraSurveyView instance
+ */
+void lora_survey_view_update(LoraSurveyView* survey_view);
+
+#ifdef __cplusplus
+}
+#endif
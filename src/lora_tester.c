@@ -2,7 +2,6 @@
 
 #include <furi.h>
 #include <furi_hal.h>
-#include <furi_hal_serial.h>
 #define TAG "LoRaTester"
 
 const char* lora_mode_names[] = {"Normal", "WOR Tx", "WOR Rx", "Config"};
@@ -14,12 +13,20 @@ void lora_tester_app_free(LoraTesterApp* app);
 static bool lora_tester_app_custom_event_callback(void* context, uint32_t event) {
     furi_assert(context);
     LoraTesterApp* app = context;
+    if(event < LoraTesterCustomEventOpProgress) {
+        // Menu items post their index, so an Ok press is handled here
+        lora_tester_op_input_handled(app);
+    } else if(event == LoraTesterCustomEventOpDone && lora_tester_op_start_queued(app)) {
+        // Done event of a cancelled op or a restore, the scene waits for the one queued after
+        return true;
+    }
     return scene_manager_handle_custom_event(app->scene_manager, event);
 }
 
 static bool lora_tester_app_back_event_callback(void* context) {
     furi_assert(context);
     LoraTesterApp* app = context;
+    lora_tester_op_input_handled(app);
     return scene_manager_handle_back_event(app->scene_manager);
 }
 
@@ -29,9 +36,14 @@ static void lora_tester_app_tick_event_callback(void* context) {
     scene_manager_handle_tick_event(app->scene_manager);
 }
 
-void lora_tester_set_mode(LoraTesterApp* app, LoRaMode mode) {
+bool lora_tester_set_mode(LoraTesterApp* app, LoRaMode mode) {
+    LoRaMode previous_mode = app->current_mode;
     app->current_mode = mode;
 
+    // AUX drops on the pin change and rises once the new mode is in effect
+    lora_aux_arm(app->aux);
+    uint32_t start = DWT->CYCCNT;
+
     // Set GPIO pins A6 (M0) and A7 (M1)
     switch(mode) {
     case LoRaMode_Normal:
@@ -53,11 +65,317 @@ void lora_tester_set_mode(LoraTesterApp* app, LoRaMode mode) {
     }
 
     FURI_LOG_I(
-        "LoRaTester",
+        TAG,
         "Mode set to: %s, A6 (M0): %s, A7 (M1): %s",
         lora_mode_names[mode],
         furi_hal_gpio_read(&gpio_ext_pa6) ? "HIGH" : "LOW",
         furi_hal_gpio_read(&gpio_ext_pa7) ? "HIGH" : "LOW");
+
+    if(mode == previous_mode) {
+        return true;
+    }
+
+    LoraModeTransition* transition = &app->mode_transitions[previous_mode][mode];
+    bool ready = lora_aux_wait_high(app->aux, LORA_MODE_READY_TIMEOUT_MS);
+    uint32_t elapsed_us = (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+
+    if(!ready) {
+        transition->timeouts++;
+        FURI_LOG_W(
+            TAG,
+            "AUX not ready %lums after %s -> %s",
+            (uint32_t)LORA_MODE_READY_TIMEOUT_MS,
+            lora_mode_names[previous_mode],
+            lora_mode_names[mode]);
+        return false;
+    }
+
+    // The datasheet asks for 2 ms after AUX rises before the mode is usable
+    furi_delay_us(2000);
+
+    transition->last_us = elapsed_us;
+    if(elapsed_us > transition->max_us) {
+        transition->max_us = elapsed_us;
+    }
+    transition->count++;
+    FURI_LOG_I(
+        TAG,
+        "%s -> %s ready in %luus",
+        lora_mode_names[previous_mode],
+        lora_mode_names[mode],
+        elapsed_us);
+    return true;
+}
+
+void lora_tester_aux_worker_cb(bool level, void* context) {
+    furi_thread_flags_set((FuriThreadId)context, level ? WorkerEventAux : WorkerEventAuxLow);
+}
+
+LoraTesterTxWait lora_tester_wait_tx(LoraTesterApp* app, uint32_t timeout_ms) {
+    bool low_seen = false;
+
+    while(true) {
+        uint32_t timeout = low_seen ? timeout_ms : LORA_TESTER_TX_GRACE_MS;
+        uint32_t events = furi_thread_flags_wait(
+            WorkerEventStop | WorkerEventAux | WorkerEventAuxLow, FuriFlagWaitAny, timeout);
+
+        if(events == (uint32_t)FuriFlagErrorTimeout) {
+            if(lora_aux_read(app->aux)) {
+                // Never dropped, or the rising edge came before we started waiting
+                return LoraTesterTxSent;
+            }
+            if(low_seen) {
+                return LoraTesterTxTimeout;
+            }
+            low_seen = true;
+            continue;
+        } else if(events & FuriFlagError) {
+            return LoraTesterTxStopped;
+        }
+
+        if(events & WorkerEventStop) {
+            return LoraTesterTxStopped;
+        }
+        if((events & WorkerEventAux) && lora_aux_read(app->aux)) {
+            return LoraTesterTxSent;
+        }
+        low_seen = true;
+    }
+}
+
+bool lora_tester_shadow_current(LoraTesterApp* app) {
+    return app->shadow.valid && app->shadow.baud_rate == app->baud_rate;
+}
+
+bool lora_tester_current_config(LoraTesterApp* app, LoRaConfig* config) {
+    if(!lora_tester_shadow_current(app)) {
+        return false;
+    }
+    lora_config_decode(app->shadow.registers, config);
+    return true;
+}
+
+void lora_tester_invalidate_registers(LoraTesterApp* app) {
+    app->shadow.valid = false;
+}
+
+LoraModuleStatus lora_tester_read_registers(LoraTesterApp* app, uint8_t* registers, bool refresh) {
+    LoraRegisterShadow* shadow = &app->shadow;
+
+    if(!refresh && lora_tester_shadow_current(app)) {
+        memcpy(registers, shadow->registers, LORA_CONFIG_REG_COUNT);
+        return LoraModuleStatusOk;
+    }
+
+    uint32_t order[COUNT_OF(baud_rates)];
+    size_t count = lora_baud_detect_order(
+        baud_rates, baud_rate_count, app->baud_rate, app->last_baud_rate, order);
+    uint32_t start = furi_get_tick();
+    uint32_t baud_rate = app->baud_rate;
+
+    LoRaMode original_mode = app->current_mode;
+    lora_tester_op_progress(app, LoraTesterOpStepConfigMode);
+    lora_tester_set_mode(app, LoRaMode_Config);
+
+    LoraModuleStatus status = LoraModuleStatusBusy;
+    app->baud_probes = 0;
+    if(lora_module_open(app->module, order[0])) {
+        for(size_t i = 0; i < count; i++) {
+            if(lora_tester_op_cancelled(app)) {
+                status = LoraModuleStatusCancelled;
+                break;
+            }
+            lora_tester_op_progress_probe(app, order[i], i + 1, count);
+            lora_module_set_baud_rate(app->module, order[i]);
+            app->baud_probes++;
+            status = lora_module_read_registers(
+                app->module,
+                0,
+                shadow->registers,
+                LORA_CONFIG_REG_COUNT,
+                lora_baud_detect_timeout_ms(order[i]));
+            if(status == LoraModuleStatusOk) {
+                baud_rate = order[i];
+                break;
+            }
+        }
+        lora_module_close(app->module);
+    }
+    lora_tester_op_progress(app, LoraTesterOpStepRestoreMode);
+    lora_tester_set_mode(app, original_mode);
+    app->baud_detect_ms = furi_get_tick() - start;
+
+    shadow->valid = status == LoraModuleStatusOk;
+    if(shadow->valid) {
+        if(baud_rate != app->baud_rate) {
+            FURI_LOG_I(
+                TAG,
+                "Module found at %lu baud after %u probes in %lums",
+                baud_rate,
+                app->baud_probes,
+                app->baud_detect_ms);
+            app->baud_rate = baud_rate;
+        }
+        if(baud_rate != app->last_baud_rate && lora_baud_detect_save(app->storage, baud_rate)) {
+            app->last_baud_rate = baud_rate;
+        }
+        shadow->tick = furi_get_tick();
+        shadow->baud_rate = baud_rate;
+        memcpy(registers, shadow->registers, LORA_CONFIG_REG_COUNT);
+        FURI_LOG_I(
+            TAG,
+            "Read registers at %lu baud in %luus",
+            baud_rate,
+            lora_module_get_last_latency_us(app->module));
+    } else {
+        FURI_LOG_E(
+            TAG,
+            "No answer at any baud rate after %lums: %s",
+            app->baud_detect_ms,
+            lora_module_status_name(status));
+    }
+    return status;
+}
+
+/* Ranges of image are written in one config mode session. The echo of each
+ * write is checked against the bytes written, so a current shadow is patched
+ * rather than dropped, and a write of every register makes it current. */
+static LoraModuleStatus lora_tester_write_ranges(
+    LoraTesterApp* app,
+    const uint8_t* image,
+    const LoraRegisterRange* ranges,
+    size_t count,
+    bool temporary) {
+    bool whole = count == 1 && ranges[0].address == 0 &&
+                 ranges[0].length == LORA_CONFIG_REG_COUNT;
+    bool write_through = whole || lora_tester_shadow_current(app);
+    lora_tester_invalidate_registers(app);
+    // UART rate in a REG0 the module took, 0 if REG0 wasn't written
+    uint32_t uart_rate = 0;
+
+    LoRaMode original_mode = app->current_mode;
+    lora_tester_op_progress(app, LoraTesterOpStepConfigMode);
+    lora_tester_set_mode(app, LoRaMode_Config);
+
+    LoraModuleStatus status = LoraModuleStatusBusy;
+    if(lora_module_open(app->module, app->baud_rate)) {
+        // Once writing starts every range goes out, a cancel would leave a mix of old and new
+        lora_tester_op_progress(app, LoraTesterOpStepTransfer);
+        for(size_t i = 0; i < count; i++) {
+            const uint8_t* data = &image[ranges[i].address];
+            if(temporary) {
+                status = lora_module_write_registers_temporary(
+                    app->module,
+                    ranges[i].address,
+                    data,
+                    ranges[i].length,
+                    LORA_MODULE_TIMEOUT_MS);
+            } else {
+                status = lora_module_write_registers(
+                    app->module,
+                    ranges[i].address,
+                    data,
+                    ranges[i].length,
+                    LORA_MODULE_TIMEOUT_MS);
+            }
+            if(status != LoraModuleStatusOk) {
+                break;
+            }
+            FURI_LOG_I(
+                TAG,
+                "%s %u registers at %02X in %luus",
+                temporary ? "Set" : "Wrote",
+                ranges[i].length,
+                ranges[i].address,
+                lora_module_get_last_latency_us(app->module));
+            if(write_through) {
+                memcpy(&app->shadow.registers[ranges[i].address], data, ranges[i].length);
+            }
+            if(ranges[i].address <= LoraReg0 &&
+               ranges[i].address + ranges[i].length > LoraReg0) {
+                uart_rate = lora_config_uart_rates[image[LoraReg0] >> 5];
+            }
+        }
+        lora_module_close(app->module);
+    }
+    lora_tester_op_progress(app, LoraTesterOpStepRestoreMode);
+    lora_tester_set_mode(app, original_mode);
+
+    // The module talks at the new UART rate from here on, even if a later range failed
+    if(uart_rate && uart_rate != app->baud_rate) {
+        FURI_LOG_I(TAG, "UART rate changed from %lu to %lu baud", app->baud_rate, uart_rate);
+        app->baud_rate = uart_rate;
+        app->shadow.baud_rate = uart_rate;
+        if(!temporary && lora_baud_detect_save(app->storage, uart_rate)) {
+            app->last_baud_rate = uart_rate;
+        }
+    }
+
+    if(status == LoraModuleStatusOk) {
+        app->shadow.valid = write_through;
+        if(write_through) {
+            app->shadow.baud_rate = app->baud_rate;
+            app->shadow.tick = furi_get_tick();
+        }
+    } else {
+        FURI_LOG_E(TAG, "Register write failed: %s", lora_module_status_name(status));
+    }
+    return status;
+}
+
+LoraModuleStatus lora_tester_write_registers(
+    LoraTesterApp* app,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length) {
+    furi_assert(address + length <= LORA_CONFIG_REG_COUNT);
+
+    uint8_t image[LORA_CONFIG_REG_COUNT];
+    memcpy(&image[address], registers, length);
+    LoraRegisterRange range = {.address = address, .length = length};
+    return lora_tester_write_ranges(app, image, &range, 1, false);
+}
+
+static LoraModuleStatus lora_tester_apply_ranges(
+    LoraTesterApp* app,
+    const uint8_t* registers,
+    size_t* writes,
+    bool temporary) {
+    LoraRegisterRange ranges[LORA_CONFIG_MAX_RANGES];
+    size_t count;
+
+    // After a trial the shadow holds what runs, not what is saved, so a save rewrites it all
+    if(lora_tester_shadow_current(app) && (temporary || !app->shadow.trial)) {
+        count = lora_config_diff(app->shadow.registers, registers, ranges);
+    } else {
+        ranges[0].address = 0;
+        ranges[0].length = LORA_CONFIG_REG_COUNT;
+        count = 1;
+    }
+
+    if(writes) {
+        *writes = count;
+    }
+    if(count == 0) {
+        FURI_LOG_I(TAG, "Registers unchanged, nothing to write");
+        return LoraModuleStatusOk;
+    }
+
+    LoraModuleStatus status = lora_tester_write_ranges(app, registers, ranges, count, temporary);
+    if(status == LoraModuleStatusOk) {
+        app->shadow.trial = temporary;
+    }
+    return status;
+}
+
+LoraModuleStatus
+    lora_tester_apply_registers(LoraTesterApp* app, const uint8_t* registers, size_t* writes) {
+    return lora_tester_apply_ranges(app, registers, writes, false);
+}
+
+LoraModuleStatus
+    lora_tester_try_registers(LoraTesterApp* app, const uint8_t* registers, size_t* writes) {
+    return lora_tester_apply_ranges(app, registers, writes, true);
 }
 
 static void lora_tester_mode_changed(VariableItem* item) {
@@ -65,6 +383,7 @@ static void lora_tester_mode_changed(VariableItem* item) {
     uint8_t index = variable_item_get_current_value_index(item);
 
     lora_tester_set_mode(app, (LoRaMode)index);
+    lora_tester_invalidate_registers(app);
 
     const char* mode_names[] = {"Normal", "WOR Tx", "WOR Rx", "Config"};
     variable_item_set_current_value_text(item, mode_names[index]);
@@ -90,6 +409,7 @@ LoraTesterApp* lora_tester_app_alloc() {
 
     // Initialize all pointers to NULL
     memset(app, 0, sizeof(LoraTesterApp));
+    lora_tester_op_init(app);
 
     app->gui = furi_record_open(RECORD_GUI);
     app->dialogs = furi_record_open(RECORD_DIALOGS);
@@ -164,6 +484,20 @@ LoraTesterApp* lora_tester_app_alloc() {
     view_dispatcher_add_view(
         app->view_dispatcher, LoraTesterAppViewByteInput, byte_input_get_view(app->byte_input));
 
+    app->hex_view = lora_hex_view_alloc();
+    view_dispatcher_add_view(
+        app->view_dispatcher, LoraTesterAppViewHexView, lora_hex_view_get_view(app->hex_view));
+
+    app->rssi_view = lora_rssi_view_alloc();
+    view_dispatcher_add_view(
+        app->view_dispatcher, LoraTesterAppViewRssiView, lora_rssi_view_get_view(app->rssi_view));
+
+    app->survey_view = lora_survey_view_alloc();
+    view_dispatcher_add_view(
+        app->view_dispatcher,
+        LoraTesterAppViewSurveyView,
+        lora_survey_view_get_view(app->survey_view));
+
     app->file_path = furi_string_alloc();
     app->receive_context = NULL;
     app->worker_thread = NULL;
@@ -171,8 +505,12 @@ LoraTesterApp* lora_tester_app_alloc() {
     // Initialize GPIO pins and serial
     furi_hal_gpio_init_simple(&gpio_ext_pa6, GpioModeOutputPushPull);
     furi_hal_gpio_init_simple(&gpio_ext_pa7, GpioModeOutputPushPull);
+    app->aux = lora_aux_alloc();
+    app->uart = lora_tester_uart_alloc();
+    app->module = lora_module_alloc(app->uart);
     lora_tester_set_mode(app, LoRaMode_Normal);
     app->baud_rate = 9600;
+    app->last_baud_rate = lora_baud_detect_load(app->storage);
 
     VariableItem* mode_item =
         variable_item_list_add(app->var_item_list, "LoRa Mode", 4, lora_tester_mode_changed, app);
@@ -206,6 +544,9 @@ LoraTesterApp* lora_tester_app_alloc() {
 void lora_tester_app_free(LoraTesterApp* app) {
     furi_assert(app);
 
+    // The op worker posts to the view dispatcher and drives the module
+    lora_tester_op_deinit(app);
+
     view_dispatcher_remove_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
     view_dispatcher_remove_view(app->view_dispatcher, LoraTesterAppViewTextBox);
 
@@ -222,10 +563,20 @@ void lora_tester_app_free(LoraTesterApp* app) {
     furi_string_free(app->file_path);
     view_dispatcher_remove_view(app->view_dispatcher, LoraTesterAppViewByteInput);
     byte_input_free(app->byte_input);
+    view_dispatcher_remove_view(app->view_dispatcher, LoraTesterAppViewHexView);
+    lora_hex_view_free(app->hex_view);
+    view_dispatcher_remove_view(app->view_dispatcher, LoraTesterAppViewRssiView);
+    lora_rssi_view_free(app->rssi_view);
+    view_dispatcher_remove_view(app->view_dispatcher, LoraTesterAppViewSurveyView);
+    lora_survey_view_free(app->survey_view);
 
     view_dispatcher_free(app->view_dispatcher);
     scene_manager_free(app->scene_manager);
 
+    lora_module_free(app->module);
+    lora_tester_uart_free(app->uart);
+    lora_aux_free(app->aux);
+
     furi_record_close(RECORD_GUI);
     furi_record_close(RECORD_STORAGE);
     furi_record_close(RECORD_DIALOGS);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "lora_tester_app.h"
 #include <gui/gui.h>
 #include <gui/view_dispatcher.h>
 #include <gui/scene_manager.h>
@@ -15,6 +16,21 @@
 #include <furi_hal.h>
 #include <gui/modules/popup.h>
 #include <gui/modules/byte_input.h>
+#include "lora_rx_path.h"
+#include "lora_byte_log.h"
+#include "lora_hex_view.h"
+#include "lora_rssi_view.h"
+#include "lora_survey_view.h"
+#include "lora_refresh_limiter.h"
+#include "lora_rx_framer.h"
+#include "lora_rx_stats.h"
+#include "lora_aux.h"
+#include "lora_capture.h"
+#include "lora_address_book.h"
+#include "lora_uart.h"
+#include "lora_module.h"
+#include "lora_baud_detect.h"
+#include "lora_rx_bench.h"
 
 #define TEXT_INPUT_STORE_SIZE 128
 #define LORA_TESTER_TEXT_BOX_STORE_SIZE 4096
@@ -24,8 +40,6 @@
 #endif
 
 extern const char* lora_mode_names[];
-typedef struct LoraTesterUart LoraTesterUart;
-typedef void (*LoraTesterUartRxCallback)(uint8_t* buf, size_t len, void* context);
 
 extern const uint32_t baud_rates[];
 extern const uint8_t baud_rate_count;
@@ -37,6 +51,29 @@ typedef enum {
     LoRaMode_Config
 } LoRaMode;
 
+#define LORA_MODE_COUNT 4
+
+/** Longest the E220 takes to raise AUX after M0/M1 change */
+#define LORA_MODE_READY_TIMEOUT_MS 1000
+
+/** Measured M0/M1 change to AUX high time for one from/to mode pair */
+typedef struct {
+    uint32_t last_us;
+    uint32_t max_us;
+    uint16_t count;
+    uint16_t timeouts;
+} LoraModeTransition;
+
+/** Last registers read from the module and the UART rate they were read at */
+typedef struct {
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    uint32_t tick;
+    uint32_t baud_rate;
+    bool valid;
+    /** Module runs C2 values that differ from what is saved, kept across invalidation */
+    bool trial;
+} LoraRegisterShadow;
+
 typedef enum {
     ConfigureItemAddress,
     ConfigureItemUARTRate,
@@ -50,6 +87,7 @@ typedef enum {
     ConfigureItemWORCycle,
     ConfigureItemEncryptionKey,
     ConfigureItemSave,
+    ConfigureItemTry,
     ConfigureItemCount
 } ConfigureItem;
 
@@ -57,17 +95,229 @@ typedef struct {
     VariableItem* items[ConfigureItemCount];
 } ConfigureItemsList;
 
+typedef enum {
+    LoraTesterReceiveModeView,
+    LoraTesterReceiveModeCapture,
+} LoraTesterReceiveMode;
+
 typedef struct {
-    FuriStreamBuffer* rx_stream;
+    LoraRxPath rx;
+    LoraByteLog history;
+    LoraRefreshLimiter refresh;
+    LoraRxStats stats;
+    LoraCapture* capture;
     FuriMutex* mutex;
+    bool uart_claimed;
+    uint32_t capture_start;
+    uint32_t last_length;
+    int16_t last_rssi;
 } ReceiveContext;
 
-struct LoraTesterUart {
-    FuriHalSerialHandle* handle;
+typedef enum {
+    LoraTesterSendModeTransparent,
+    LoraTesterSendModeFixed,
+} LoraTesterSendMode;
+
+typedef enum {
+    LoraTesterStatModeCached,
+    LoraTesterStatModeRefresh,
+} LoraTesterStatMode;
+
+#define SEND_MAX_TARGETS (LORA_ADDRESS_BOOK_MAX_ENTRIES + 1)
+
+typedef struct {
+    LoraAddressEntry entries[SEND_MAX_TARGETS];
+    size_t count;
+} SendTargets;
+
+/** Payload with room in front for the fixed-transmission header, so
+ * addressing a message never moves it */
+typedef struct {
+    uint8_t frame[LORA_FIXED_HEADER_SIZE + TEXT_INPUT_STORE_SIZE];
+    size_t length;
+    uint32_t keypress_tick;
+} SendMessage;
+
+#define SEND_MESSAGE_PAYLOAD(message) (&(message)->frame[LORA_FIXED_HEADER_SIZE])
+
+typedef struct {
+    bool uart_claimed;
+    FuriMessageQueue* queue;
+    FuriThread* thread;
+    bool fixed;
+    SendTargets targets;
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t rejected;
+    bool last_rejected;
+    /** Messages whose frame AUX never confirmed as sent */
+    uint32_t failed;
+    bool last_failed;
+    uint32_t last_latency_ms;
+    uint32_t last_wire_ms;
+    uint32_t max_latency_ms;
+    /** Set once the scene exits, messages still queued go out without a SendDone */
+    volatile bool stopping;
+    char status[32];
+} SendContext;
+
+typedef struct {
+    bool uart_claimed;
+    FuriThread* thread;
+    FuriString* path;
+    uint16_t chunk_size;
+    uint32_t file_size;
+    uint32_t bytes_sent;
+    uint32_t chunks;
+    uint32_t elapsed_ms;
+    uint32_t stall_ms;
+    uint32_t aux_timeouts;
+    bool done;
+    bool failed;
+} FileSendContext;
+
+typedef struct {
+    bool uart_claimed;
+    FuriThread* thread;
     FuriMutex* mutex;
-};
+    LoraRssiHistory history;
+    LoraRssiParser parser;
+    /** Set by the worker before a query goes out, cleared by the RX callback on the reply */
+    volatile bool reply_pending;
+    uint8_t reply[2];
+    uint8_t period_index;
+    LoRaMode original_mode;
+    /** The op switching to normal mode hasn't finished, the worker starts after it */
+    bool switching;
+    /** AUX didn't confirm the switch to normal mode, queries are unlikely to be answered */
+    bool mode_failed;
+    int16_t last_packet_dbm;
+    bool ambient_disabled;
+    uint32_t polls;
+    uint32_t timeouts;
+    uint32_t data_bytes;
+} RssiContext;
+
+typedef struct {
+    LoraTesterApp* app;
+    FuriThread* thread;
+    FuriMutex* mutex;
+    LoraSurvey survey;
+    uint8_t dwell_index;
+    /** REG1 and REG2 as they were before the sweep, put back with C2 when it ends */
+    uint8_t original_registers[2];
+    LoRaMode original_mode;
+    /** Last failed module command, Ok if none has failed */
+    LoraModuleStatus status;
+    uint32_t sweeps;
+    uint32_t sweep_ms;
+    uint32_t samples;
+    uint32_t errors;
+} SurveyContext;
+
+typedef enum {
+    LoraTesterOpRead,
+    LoraTesterOpWrite,
+    LoraTesterOpApply,
+    LoraTesterOpApplyFile,
+    LoraTesterOpBench,
+    LoraTesterOpMode,
+} LoraTesterOpType;
+
+typedef enum {
+    LoraTesterOpStepStarting,
+    LoraTesterOpStepLoadFile,
+    LoraTesterOpStepConfigMode,
+    LoraTesterOpStepProbe,
+    LoraTesterOpStepTransfer,
+    LoraTesterOpStepRestoreMode,
+    LoraTesterOpStepBenchRate,
+    LoraTesterOpStepBenchMax,
+    LoraTesterOpStepSwitchMode,
+    LoraTesterOpStepDone,
+} LoraTesterOpStep;
+
+#define LORA_TESTER_OP_TEXT_SIZE 40
+/** At least baud_rate_count */
+#define LORA_TESTER_BENCH_RATES 8
+/** A scene's request plus the restores left behind by the scenes before it */
+#define LORA_TESTER_OP_QUEUE_SIZE 4
+
+/** Run by a LoraTesterOpMode op once the thread it waits for has stopped */
+typedef void (*LoraTesterOpRelease)(void* context);
+
+/** Inputs of an op that waits for the running one, see lora_tester_op_start_read */
+typedef struct {
+    LoraTesterOpType type;
+    bool refresh;
+    bool temporary;
+    bool detached;
+    uint8_t address;
+    uint8_t length;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    LoRaMode mode;
+    FuriThread* join;
+    LoraTesterOpRelease release;
+    void* release_context;
+    /** Owned by the queue slot */
+    FuriString* path;
+} LoraTesterOpRequest;
 
+/** Module operation run off the GUI thread, see lora_tester_op_start_read */
 typedef struct {
+    FuriThread* thread;
+    LoraTesterOpType type;
+    /** Inputs, set before the worker starts */
+    bool refresh;
+    bool temporary;
+    uint8_t address;
+    uint8_t length;
+    FuriString* path;
+    /** Registers to write, or the registers read once a read finishes */
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    /** Mode to switch to, after joining join and calling release if they are set */
+    LoRaMode mode;
+    FuriThread* join;
+    LoraTesterOpRelease release;
+    void* release_context;
+    /** Left behind by a scene on exit, nobody takes the result and a cancel doesn't drop it */
+    bool detached;
+    /** Started in order as each op before them finishes */
+    LoraTesterOpRequest queue[LORA_TESTER_OP_QUEUE_SIZE];
+    uint8_t queued;
+    /** Progress, written by the worker and formatted on the GUI thread */
+    volatile LoraTesterOpStep step;
+    /** Rate being probed or replayed */
+    volatile uint32_t probe_baud_rate;
+    volatile uint8_t probe_index;
+    volatile uint8_t probe_count;
+    volatile bool cancel;
+    volatile bool finished;
+    bool delivered;
+    /** Results */
+    LoraModuleStatus status;
+    bool file_failed;
+    size_t writes;
+    /** Benchmark of the receive path, one result per rate in baud_rates */
+    LoraRxBenchResult bench[LORA_TESTER_BENCH_RATES];
+    uint8_t bench_count;
+    uint32_t bench_max_rate;
+    size_t bench_packets;
+    /** Replayed LORA_RX_BENCH_CAPTURE_PATH rather than the synthetic stream */
+    bool bench_recorded;
+    uint32_t start_tick;
+    uint32_t elapsed_ms;
+    /** Time from a Back or Ok press to the GUI thread handling it */
+    FuriPubSub* input_events;
+    FuriPubSubSubscription* input_subscription;
+    volatile bool input_pending;
+    volatile uint32_t input_cycles;
+    uint32_t input_last_us;
+    uint32_t input_max_us;
+    char text[LORA_TESTER_OP_TEXT_SIZE];
+} LoraTesterOp;
+
+struct LoraTesterApp {
     Gui* gui;
     ViewDispatcher* view_dispatcher;
     SceneManager* scene_manager;
@@ -76,6 +326,9 @@ typedef struct {
     TextBox* text_box;
     FuriString* text_box_store;
     LoRaMode current_mode;
+    /** A scene timed out restoring the mode on exit, the start menu reports it */
+    bool mode_timeout;
+    LoraModeTransition mode_transitions[LORA_MODE_COUNT][LORA_MODE_COUNT];
     UART_TextInput* text_input;
     char text_input_store[TEXT_INPUT_STORE_SIZE];
     uint8_t rx_buffer[256];
@@ -88,12 +341,32 @@ typedef struct {
     Popup* popup;
     LoraTesterUart* uart;
     ReceiveContext* receive_context;
+    SendContext* send_context;
+    FileSendContext* file_send_context;
+    RssiContext* rssi_context;
+    SurveyContext* survey_context;
     FuriThread* worker_thread;
     uint32_t baud_rate;
     uint16_t address;
     ByteInput* byte_input;
     uint16_t encryption_key;
-} LoraTesterApp;
+    LoraHexView* hex_view;
+    LoraRssiView* rssi_view;
+    LoraSurveyView* survey_view;
+    LoraAux* aux;
+    LoraModule* module;
+    LoraRegisterShadow shadow;
+    LoraTesterOp op;
+    /** Rate stored on SD as the last one the module answered at, 0 if none */
+    uint32_t last_baud_rate;
+    /** Rates tried and time taken by the last register read from the module */
+    uint8_t baud_probes;
+    uint32_t baud_detect_ms;
+    LoraAddressBook address_book;
+    uint32_t send_selection;
+    uint8_t broadcast_channel;
+    SendTargets send_targets;
+};
 
 typedef enum {
     LoraTesterAppViewVarItemList,
@@ -103,8 +376,10 @@ typedef enum {
     LoraTesterAppViewFileBrowser,
     LoraTesterAppViewDialogEx,
     LoraTesterAppViewPopup,
-    LoraTesterCustomEventRefreshView,
     LoraTesterAppViewByteInput,
+    LoraTesterAppViewHexView,
+    LoraTesterAppViewRssiView,
+    LoraTesterAppViewSurveyView,
 } LoraTesterAppView;
 
 typedef enum {
@@ -112,13 +387,189 @@ typedef enum {
     LoraTesterCustomEventFileSelected,
     LoraTesterCustomEventOk,
     LoraTesterCustomEventByteInputDone,
+    /** Kept clear of the menu indexes scenes use as events, an op can finish after its scene */
+    LoraTesterCustomEventOpProgress = 0x100,
+    LoraTesterCustomEventOpDone,
+    LoraTesterCustomEventPopupDone,
+    LoraTesterCustomEventSendDone,
+    LoraTesterCustomEventFileSendUpdate,
+    LoraTesterCustomEventRssiUpdate,
+    LoraTesterCustomEventSurveyUpdate,
+    LoraTesterCustomEventRefreshView,
 } LoraTesterCustomEvent;
 
-void lora_tester_set_mode(LoraTesterApp* app, LoRaMode mode);
+/** Drive M0/M1 and wait for the module to report ready on AUX
+ *
+ * @return     false if AUX did not come back within LORA_MODE_READY_TIMEOUT_MS
+ */
+bool lora_tester_set_mode(LoraTesterApp* app, LoRaMode mode);
+
+/** Get all registers, from the shadow unless it is stale or refresh is set
+ *
+ * A module read enters config mode and restores the current mode afterwards.
+ * If the module doesn't answer at app->baud_rate the other rates are probed
+ * and app->baud_rate is updated to the one that works.
+ */
+LoraModuleStatus lora_tester_read_registers(LoraTesterApp* app, uint8_t* registers, bool refresh);
+
+/** Write registers from address in config mode, updating a current shadow */
+LoraModuleStatus lora_tester_write_registers(
+    LoraTesterApp* app,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length);
+
+/** Bring all registers to the given values, writing only what differs from
+ * the shadow, or everything when the shadow isn't current
+ *
+ * @param      writes  receives the number of C0 commands sent, may be NULL
+ */
+LoraModuleStatus
+    lora_tester_apply_registers(LoraTesterApp* app, const uint8_t* registers, size_t* writes);
+
+/** As lora_tester_apply_registers but with C2, the module reverts on power down */
+LoraModuleStatus
+    lora_tester_try_registers(LoraTesterApp* app, const uint8_t* registers, size_t* writes);
+
+/** Whether the shadow holds the registers of the module at app->baud_rate */
+bool lora_tester_shadow_current(LoraTesterApp* app);
+
+/** Decode the shadow into config
+ *
+ * @return     false if the shadow isn't current, config is left untouched
+ */
+bool lora_tester_current_config(LoraTesterApp* app, LoRaConfig* config);
+
+void lora_tester_invalidate_registers(LoraTesterApp* app);
+
+/** Read registers in the background, as lora_tester_read_registers
+ *
+ * Progress is posted as LoraTesterCustomEventOpProgress and the end as
+ * LoraTesterCustomEventOpDone. An op started while another one is still
+ * winding down is queued and starts on that one's done event, the GUI thread
+ * never waits for it.
+ */
+void lora_tester_op_start_read(LoraTesterApp* app, bool refresh);
+
+/** Write registers in the background, as lora_tester_write_registers */
+void lora_tester_op_start_write(
+    LoraTesterApp* app,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length);
+
+/** Apply registers in the background, as lora_tester_apply_registers or with
+ * temporary set lora_tester_try_registers */
+void lora_tester_op_start_apply(LoraTesterApp* app, const uint8_t* registers, bool temporary);
+
+/** Parse an exported .ini file and apply it in the background */
+void lora_tester_op_start_apply_file(LoraTesterApp* app, const char* path);
+
+/** Replay a stream through the receive path at every rate in the background
+ *
+ * Uses LORA_RX_BENCH_CAPTURE_PATH when present, a synthetic stream otherwise.
+ * Doesn't touch the module. A cancel stops it between rates.
+ */
+void lora_tester_op_start_bench(LoraTesterApp* app);
+
+/** Switch the module to mode, the op fails with Timeout if AUX doesn't confirm it */
+void lora_tester_op_start_mode(LoraTesterApp* app, LoRaMode mode);
+
+/** Put the module back in mode for a scene on its way out
+ *
+ * If thread is set it is joined and freed first, then release is called with
+ * context. Nobody waits for the result, a timeout sets mode_timeout.
+ */
+void lora_tester_op_start_restore(
+    LoraTesterApp* app,
+    LoRaMode mode,
+    FuriThread* thread,
+    LoraTesterOpRelease release,
+    void* context);
+
+/** Ask the running op to stop at its next step and drop queued ones, doesn't wait
+ *
+ * Restores are left to finish.
+ */
+void lora_tester_op_cancel(LoraTesterApp* app);
+
+/** True once per finished op of the given type, for LoraTesterCustomEventOpDone
+ *
+ * Done events of ops that were cancelled or replaced are not taken.
+ */
+bool lora_tester_op_take_result(LoraTesterApp* app, LoraTesterOpType type);
+
+/** Current step as text, or the outcome once finished */
+const char* lora_tester_op_get_text(LoraTesterApp* app);
+
+/** Show the popup with header and the progress text */
+void lora_tester_op_show_progress(LoraTesterApp* app, const char* header);
+
+/** Refresh the popup text, for LoraTesterCustomEventOpProgress */
+void lora_tester_op_update_progress(LoraTesterApp* app);
+
+/** Report the step the calling op is at, ignored outside the op worker */
+void lora_tester_op_progress(LoraTesterApp* app, LoraTesterOpStep step);
+
+/** Report a baud rate probe, index counted from 1 */
+void lora_tester_op_progress_probe(
+    LoraTesterApp* app,
+    uint32_t baud_rate,
+    uint8_t index,
+    uint8_t count);
+
+/** True when called from an op worker whose op was cancelled */
+bool lora_tester_op_cancelled(LoraTesterApp* app);
+
+/** True while an op runs or waits to, the module may be mid-change */
+bool lora_tester_op_busy(LoraTesterApp* app);
+
+/** Start the next queued op once the running one has finished
+ *
+ * @return     true if one started, the done event that let it start is stale
+ */
+bool lora_tester_op_start_queued(LoraTesterApp* app);
+
+/** Record the latency of the last Back or Ok press, called as the GUI thread handles it */
+void lora_tester_op_input_handled(LoraTesterApp* app);
+
+void lora_tester_op_init(LoraTesterApp* app);
+
+/** Cancel and wait for any running op, queued restores still run */
+void lora_tester_op_deinit(LoraTesterApp* app);
 
 typedef enum {
     WorkerEventStop = (1 << 0),
     WorkerEventRx = (1 << 1),
+    WorkerEventRxIdle = (1 << 2),
+    WorkerEventAux = (1 << 3),
+    WorkerEventAuxLow = (1 << 4),
 } WorkerEventFlags;
 
-#define WORKER_ALL_EVENTS (WorkerEventStop | WorkerEventRx)
+#define WORKER_ALL_EVENTS (WorkerEventStop | WorkerEventRx | WorkerEventRxIdle | WorkerEventAux)
+
+/** How long AUX may take to drop after a frame is written before it counts as already sent */
+#define LORA_TESTER_TX_GRACE_MS 20
+
+typedef enum {
+    LoraTesterTxSent,
+    LoraTesterTxStopped,
+    LoraTesterTxTimeout,
+} LoraTesterTxWait;
+
+/** AUX callback passing edges to a worker as WorkerEventAux and WorkerEventAuxLow
+ *
+ * The context is the worker's FuriThreadId.
+ */
+void lora_tester_aux_worker_cb(bool level, void* context);
+
+/** Wait until the module has sent the frame just written and its buffer is free
+ *
+ * Runs on a worker that gets AUX edges through lora_tester_aux_worker_cb and
+ * cleared WorkerEventAux and WorkerEventAuxLow before writing. The falling
+ * edge is looked for first, then the rising one. WorkerEventStop ends the
+ * wait early.
+ *
+ * @param      timeout_ms  how long AUX may stay low
+ */
+LoraTesterTxWait lora_tester_wait_tx(LoraTesterApp* app, uint32_t timeout_ms);
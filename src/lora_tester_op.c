@@ -0,0 +1,547 @@
+#include "lora_tester_app_i.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <input/input.h>
+#include <toolbox/stream/file_stream.h>
+
+#define TAG "LoRaTester"
+#define LORA_TESTER_OP_STACK_SIZE 2048
+/** Packets the benchmark replays at most, a capture is cut there */
+#define LORA_TESTER_BENCH_PACKETS 512
+
+/* The GUI thread only starts ops and formats their progress. Everything
+ * that waits on the module, a mode change, a baud rate probe or a register
+ * echo, runs on the op worker, one op at a time. */
+
+static bool lora_tester_op_on_worker(LoraTesterApp* app) {
+    return app->op.thread && furi_thread_get_current_id() == furi_thread_get_id(app->op.thread);
+}
+
+static void lora_tester_op_post(LoraTesterApp* app, uint32_t event) {
+    view_dispatcher_send_custom_event(app->view_dispatcher, event);
+}
+
+static void lora_tester_op_progress_rate(
+    LoraTesterApp* app,
+    LoraTesterOpStep step,
+    uint32_t baud_rate,
+    uint8_t index,
+    uint8_t count);
+
+static void parse_config_file(Stream* stream, LoRaConfig* config) {
+    FuriString* line = furi_string_alloc();
+    LoraConfigIniParser parser;
+
+    lora_config_ini_init(&parser);
+    while(stream_read_line(stream, line)) {
+        lora_config_ini_parse_line(&parser, furi_string_get_cstr(line));
+    }
+    lora_config_ini_finish(&parser, config);
+
+    furi_string_free(line);
+}
+
+static bool lora_tester_op_load_file(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    Stream* stream = file_stream_alloc(app->storage);
+    bool success = false;
+    LoRaConfig config;
+
+    FURI_LOG_D(TAG, "Opening file: %s", furi_string_get_cstr(op->path));
+    if(file_stream_open(stream, furi_string_get_cstr(op->path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+        parse_config_file(stream, &config);
+        lora_config_encode(&config, op->registers);
+
+        char hex_string[33];
+        lora_config_to_hex_string(&config, hex_string, sizeof(hex_string));
+        FURI_LOG_D(TAG, "Config converted to hex: %s", hex_string);
+        success = true;
+    } else {
+        FURI_LOG_E(TAG, "Failed to open file for reading");
+    }
+
+    stream_free(stream);
+    return success;
+}
+
+static uint32_t lora_tester_op_bench_clock(void) {
+    return DWT->CYCCNT;
+}
+
+/** Load the capture to replay into image, or fill it with the synthetic stream */
+static void lora_tester_op_bench_stream(
+    LoraTesterApp* app,
+    LoraRxBench* bench,
+    LoraRxBenchPacket* packets,
+    uint8_t* image) {
+    LoraTesterOp* op = &app->op;
+    File* file = storage_file_alloc(app->storage);
+    size_t size = 0;
+    uint32_t recorded_baud_rate = 0;
+
+    if(storage_file_open(file, LORA_RX_BENCH_CAPTURE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        size = storage_file_read(file, image, LORA_RX_BENCH_CAPTURE_MAX);
+        storage_file_close(file);
+    }
+    storage_file_free(file);
+
+    bench->count = lora_rx_bench_parse_capture(
+        image, size, packets, LORA_TESTER_BENCH_PACKETS, &recorded_baud_rate, &bench->rssi_byte);
+    op->bench_recorded = bench->count > 0;
+    if(op->bench_recorded) {
+        // Keep the spacing the packets arrived with, it decides how often the view refreshes
+        bench->timed = true;
+        FURI_LOG_I(
+            TAG,
+            "Bench replays %u packets recorded at %lu baud",
+            bench->count,
+            recorded_baud_rate);
+    } else {
+        bench->count = lora_rx_bench_synthetic(
+            packets, LORA_TESTER_BENCH_PACKETS, image, LORA_RX_BENCH_CAPTURE_MAX);
+    }
+    op->bench_packets = bench->count;
+}
+
+static void lora_tester_op_bench(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    uint8_t* image = malloc(LORA_RX_BENCH_CAPTURE_MAX);
+    LoraRxBenchPacket* packets = malloc(sizeof(LoraRxBenchPacket) * LORA_TESTER_BENCH_PACKETS);
+    LoraRxBench bench = {
+        .packets = packets,
+        .clock = lora_tester_op_bench_clock,
+        .cycles_per_us = furi_hal_cortex_instructions_per_microsecond(),
+        .stop = &op->cancel,
+    };
+    furi_assert(baud_rate_count <= LORA_TESTER_BENCH_RATES);
+
+    lora_tester_op_progress(app, LoraTesterOpStepLoadFile);
+    lora_tester_op_bench_stream(app, &bench, packets, image);
+
+    for(uint8_t i = 0; i < baud_rate_count && !op->cancel; i++) {
+        LoraRxBenchResult* result = &op->bench[i];
+        lora_tester_op_progress_rate(
+            app, LoraTesterOpStepBenchRate, baud_rates[i], i + 1, baud_rate_count);
+        if(!lora_rx_bench_run(&bench, baud_rates[i], result)) {
+            break;
+        }
+        op->bench_count = i + 1;
+        FURI_LOG_I(
+            TAG,
+            "Bench %lu baud: isr %lu worker %lu cyc/B, view %lu cyc, %lu dropped, %lu overrun",
+            result->baud_rate,
+            result->bytes ? (uint32_t)(result->isr_cycles / result->bytes) : 0,
+            result->bytes ? (uint32_t)(result->worker_cycles / result->bytes) : 0,
+            result->refreshes ? (uint32_t)(result->refresh_cycles / result->refreshes) : 0,
+            result->dropped,
+            result->overruns);
+    }
+
+    if(op->bench_count == baud_rate_count && !op->cancel) {
+        lora_tester_op_progress(app, LoraTesterOpStepBenchMax);
+        op->bench_max_rate = lora_rx_bench_max_rate(&bench);
+    }
+    op->status = op->cancel ? LoraModuleStatusCancelled : LoraModuleStatusOk;
+
+    free(packets);
+    free(image);
+}
+
+static int32_t lora_tester_op_worker(void* context) {
+    LoraTesterApp* app = context;
+    LoraTesterOp* op = &app->op;
+
+    switch(op->type) {
+    case LoraTesterOpRead:
+        op->status = lora_tester_read_registers(app, op->registers, op->refresh);
+        break;
+    case LoraTesterOpWrite:
+        op->status = lora_tester_write_registers(app, op->address, op->registers, op->length);
+        break;
+    case LoraTesterOpApplyFile:
+        lora_tester_op_progress(app, LoraTesterOpStepLoadFile);
+        if(!lora_tester_op_load_file(app)) {
+            op->file_failed = true;
+            break;
+        }
+        /* fall through */
+    case LoraTesterOpApply:
+        // A half applied config is worse than none, so a cancel only counts before the first write
+        if(op->cancel) {
+            op->status = LoraModuleStatusCancelled;
+        } else if(op->temporary) {
+            op->status = lora_tester_try_registers(app, op->registers, &op->writes);
+        } else {
+            op->status = lora_tester_apply_registers(app, op->registers, &op->writes);
+        }
+        break;
+    case LoraTesterOpBench:
+        lora_tester_op_bench(app);
+        break;
+    case LoraTesterOpMode:
+        if(op->join) {
+            // A scene worker told to stop, it may still be putting the module back
+            furi_thread_join(op->join);
+            furi_thread_free(op->join);
+        }
+        if(op->release) {
+            op->release(op->release_context);
+        }
+        lora_tester_op_progress(app, LoraTesterOpStepSwitchMode);
+        op->status = lora_tester_set_mode(app, op->mode) ? LoraModuleStatusOk :
+                                                            LoraModuleStatusTimeout;
+        if(op->status != LoraModuleStatusOk && op->detached) {
+            // Nobody waits for a restore, the start menu reports it
+            app->mode_timeout = true;
+        }
+        break;
+    }
+
+    op->elapsed_ms = furi_get_tick() - op->start_tick;
+    FURI_LOG_I(
+        TAG,
+        "Op %d done in %lums: %s",
+        op->type,
+        op->elapsed_ms,
+        op->file_failed ? "file failed" : lora_module_status_name(op->status));
+    op->step = LoraTesterOpStepDone;
+    op->finished = true;
+    lora_tester_op_post(app, LoraTesterCustomEventOpDone);
+    return 0;
+}
+
+/** Start request on a new worker, the previous op has finished */
+static void lora_tester_op_begin(
+    LoraTesterApp* app,
+    const LoraTesterOpRequest* request,
+    const char* path) {
+    LoraTesterOp* op = &app->op;
+
+    if(op->thread) {
+        // Finished, so this returns at once
+        furi_thread_join(op->thread);
+        furi_thread_free(op->thread);
+        op->thread = NULL;
+    }
+
+    op->type = request->type;
+    op->refresh = request->refresh;
+    op->temporary = request->temporary;
+    op->detached = request->detached;
+    op->address = request->address;
+    op->length = request->length;
+    memcpy(op->registers, request->registers, LORA_CONFIG_REG_COUNT);
+    op->mode = request->mode;
+    op->join = request->join;
+    op->release = request->release;
+    op->release_context = request->release_context;
+    furi_string_set_str(op->path, path ? path : "");
+
+    op->step = LoraTesterOpStepStarting;
+    op->cancel = false;
+    op->finished = false;
+    op->delivered = false;
+    op->status = LoraModuleStatusOk;
+    op->file_failed = false;
+    op->writes = 0;
+    op->bench_count = 0;
+    op->bench_max_rate = 0;
+
+    op->start_tick = furi_get_tick();
+    op->thread = furi_thread_alloc_ex(
+        "LoRaOpWorker", LORA_TESTER_OP_STACK_SIZE, lora_tester_op_worker, app);
+    furi_thread_start(op->thread);
+}
+
+/** Start request now, or queue it behind the running op rather than wait for it */
+static void lora_tester_op_submit(
+    LoraTesterApp* app,
+    const LoraTesterOpRequest* request,
+    const char* path) {
+    LoraTesterOp* op = &app->op;
+
+    if(!lora_tester_op_busy(app)) {
+        lora_tester_op_begin(app, request, path);
+        return;
+    }
+
+    // A cancelled op or a restore, neither takes longer than a few module commands
+    furi_check(op->queued < LORA_TESTER_OP_QUEUE_SIZE);
+    LoraTesterOpRequest* slot = &op->queue[op->queued++];
+    FuriString* slot_path = slot->path;
+    *slot = *request;
+    slot->path = slot_path;
+    furi_string_set_str(slot->path, path ? path : "");
+}
+
+bool lora_tester_op_busy(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    return (op->thread && !op->finished) || op->queued;
+}
+
+bool lora_tester_op_start_queued(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    if(!op->queued || !op->finished) {
+        return false;
+    }
+
+    // The slot's path goes to the back with it, begin copies it out first
+    LoraTesterOpRequest request = op->queue[0];
+    memmove(&op->queue[0], &op->queue[1], sizeof(LoraTesterOpRequest) * (op->queued - 1));
+    op->queued--;
+    op->queue[op->queued].path = request.path;
+
+    lora_tester_op_begin(app, &request, furi_string_get_cstr(request.path));
+    return true;
+}
+
+void lora_tester_op_start_read(LoraTesterApp* app, bool refresh) {
+    LoraTesterOpRequest request = {.type = LoraTesterOpRead, .refresh = refresh};
+    lora_tester_op_submit(app, &request, NULL);
+}
+
+void lora_tester_op_start_write(
+    LoraTesterApp* app,
+    uint8_t address,
+    const uint8_t* registers,
+    uint8_t length) {
+    furi_assert(address + length <= LORA_CONFIG_REG_COUNT);
+    LoraTesterOpRequest request = {
+        .type = LoraTesterOpWrite,
+        .address = address,
+        .length = length,
+    };
+    memcpy(request.registers, registers, length);
+    lora_tester_op_submit(app, &request, NULL);
+}
+
+void lora_tester_op_start_apply(LoraTesterApp* app, const uint8_t* registers, bool temporary) {
+    LoraTesterOpRequest request = {.type = LoraTesterOpApply, .temporary = temporary};
+    memcpy(request.registers, registers, LORA_CONFIG_REG_COUNT);
+    lora_tester_op_submit(app, &request, NULL);
+}
+
+void lora_tester_op_start_apply_file(LoraTesterApp* app, const char* path) {
+    LoraTesterOpRequest request = {.type = LoraTesterOpApplyFile};
+    lora_tester_op_submit(app, &request, path);
+}
+
+void lora_tester_op_start_bench(LoraTesterApp* app) {
+    LoraTesterOpRequest request = {.type = LoraTesterOpBench};
+    lora_tester_op_submit(app, &request, NULL);
+}
+
+void lora_tester_op_start_mode(LoraTesterApp* app, LoRaMode mode) {
+    LoraTesterOpRequest request = {.type = LoraTesterOpMode, .mode = mode};
+    lora_tester_op_submit(app, &request, NULL);
+}
+
+void lora_tester_op_start_restore(
+    LoraTesterApp* app,
+    LoRaMode mode,
+    FuriThread* thread,
+    LoraTesterOpRelease release,
+    void* context) {
+    LoraTesterOpRequest request = {
+        .type = LoraTesterOpMode,
+        .detached = true,
+        .mode = mode,
+        .join = thread,
+        .release = release,
+        .release_context = context,
+    };
+    lora_tester_op_submit(app, &request, NULL);
+}
+
+void lora_tester_op_cancel(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    if(!op->detached) {
+        op->cancel = true;
+    }
+
+    // Restores left by earlier scenes still have to run, only requests that wait for a result go
+    uint8_t kept = 0;
+    for(uint8_t i = 0; i < op->queued; i++) {
+        if(op->queue[i].detached) {
+            LoraTesterOpRequest request = op->queue[kept];
+            op->queue[kept++] = op->queue[i];
+            op->queue[i] = request;
+        }
+    }
+    op->queued = kept;
+}
+
+bool lora_tester_op_take_result(LoraTesterApp* app, LoraTesterOpType type) {
+    LoraTesterOp* op = &app->op;
+    if(!op->finished || op->delivered || op->cancel || op->detached || op->type != type) {
+        return false;
+    }
+    op->delivered = true;
+    return true;
+}
+
+const char* lora_tester_op_get_text(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    bool writing = op->type != LoraTesterOpRead;
+
+    if(op->queued) {
+        snprintf(op->text, sizeof(op->text), "Waiting for last op...");
+        return op->text;
+    }
+
+    switch(op->step) {
+    case LoraTesterOpStepStarting:
+        snprintf(op->text, sizeof(op->text), "Starting...");
+        break;
+    case LoraTesterOpStepLoadFile:
+        snprintf(op->text, sizeof(op->text), "Reading file...");
+        break;
+    case LoraTesterOpStepConfigMode:
+        snprintf(op->text, sizeof(op->text), "Entering config mode...");
+        break;
+    case LoraTesterOpStepProbe:
+        snprintf(
+            op->text,
+            sizeof(op->text),
+            "Trying %lu baud (%u/%u)",
+            op->probe_baud_rate,
+            op->probe_index,
+            op->probe_count);
+        break;
+    case LoraTesterOpStepTransfer:
+        snprintf(op->text, sizeof(op->text), writing ? "Writing..." : "Reading...");
+        break;
+    case LoraTesterOpStepRestoreMode:
+        snprintf(op->text, sizeof(op->text), "Restoring mode...");
+        break;
+    case LoraTesterOpStepBenchRate:
+        snprintf(
+            op->text,
+            sizeof(op->text),
+            "Replaying at %lu baud (%u/%u)",
+            op->probe_baud_rate,
+            op->probe_index,
+            op->probe_count);
+        break;
+    case LoraTesterOpStepBenchMax:
+        snprintf(op->text, sizeof(op->text), "Finding max rate...");
+        break;
+    case LoraTesterOpStepSwitchMode:
+        snprintf(op->text, sizeof(op->text), "Switching mode...");
+        break;
+    case LoraTesterOpStepDone:
+        snprintf(
+            op->text,
+            sizeof(op->text),
+            "%s",
+            op->file_failed ? "Failed to read file" : lora_module_status_name(op->status));
+        break;
+    }
+    return op->text;
+}
+
+void lora_tester_op_show_progress(LoraTesterApp* app, const char* header) {
+    popup_reset(app->popup);
+    popup_set_header(app->popup, header, 64, 10, AlignCenter, AlignTop);
+    lora_tester_op_update_progress(app);
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewPopup);
+}
+
+void lora_tester_op_update_progress(LoraTesterApp* app) {
+    popup_set_text(app->popup, lora_tester_op_get_text(app), 64, 36, AlignCenter, AlignCenter);
+}
+
+void lora_tester_op_progress(LoraTesterApp* app, LoraTesterOpStep step) {
+    if(!lora_tester_op_on_worker(app)) {
+        return;
+    }
+    app->op.step = step;
+    lora_tester_op_post(app, LoraTesterCustomEventOpProgress);
+}
+
+static void lora_tester_op_progress_rate(
+    LoraTesterApp* app,
+    LoraTesterOpStep step,
+    uint32_t baud_rate,
+    uint8_t index,
+    uint8_t count) {
+    if(!lora_tester_op_on_worker(app)) {
+        return;
+    }
+    app->op.probe_baud_rate = baud_rate;
+    app->op.probe_index = index;
+    app->op.probe_count = count;
+    lora_tester_op_progress(app, step);
+}
+
+void lora_tester_op_progress_probe(
+    LoraTesterApp* app,
+    uint32_t baud_rate,
+    uint8_t index,
+    uint8_t count) {
+    lora_tester_op_progress_rate(app, LoraTesterOpStepProbe, baud_rate, index, count);
+}
+
+bool lora_tester_op_cancelled(LoraTesterApp* app) {
+    return lora_tester_op_on_worker(app) && app->op.cancel;
+}
+
+void lora_tester_op_input_handled(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    if(!op->input_pending) {
+        return;
+    }
+    op->input_pending = false;
+    op->input_last_us =
+        (DWT->CYCCNT - op->input_cycles) / furi_hal_cortex_instructions_per_microsecond();
+    if(op->input_last_us > op->input_max_us) {
+        op->input_max_us = op->input_last_us;
+    }
+}
+
+/** Stamp Back and Ok presses, the ones that leave a scene or pick a menu item */
+static void lora_tester_op_input_callback(const void* message, void* context) {
+    const InputEvent* event = message;
+    LoraTesterApp* app = context;
+
+    if(event->type == InputTypeShort &&
+       (event->key == InputKeyBack || event->key == InputKeyOk)) {
+        // A press nothing reports as handled is superseded by the next one
+        app->op.input_cycles = DWT->CYCCNT;
+        app->op.input_pending = true;
+    }
+}
+
+void lora_tester_op_init(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    memset(op, 0, sizeof(LoraTesterOp));
+    op->path = furi_string_alloc();
+    for(uint8_t i = 0; i < LORA_TESTER_OP_QUEUE_SIZE; i++) {
+        op->queue[i].path = furi_string_alloc();
+    }
+    op->input_events = furi_record_open(RECORD_INPUT_EVENTS);
+    op->input_subscription =
+        furi_pubsub_subscribe(op->input_events, lora_tester_op_input_callback, app);
+}
+
+void lora_tester_op_deinit(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+
+    // Queued restores still run, they free the scene workers they wait for
+    lora_tester_op_cancel(app);
+    while(op->thread) {
+        furi_thread_join(op->thread);
+        if(!lora_tester_op_start_queued(app)) {
+            furi_thread_free(op->thread);
+            op->thread = NULL;
+        }
+    }
+
+    furi_pubsub_unsubscribe(op->input_events, op->input_subscription);
+    furi_record_close(RECORD_INPUT_EVENTS);
+    FURI_LOG_I(TAG, "Input handled within %luus", op->input_max_us);
+    for(uint8_t i = 0; i < LORA_TESTER_OP_QUEUE_SIZE; i++) {
+        furi_string_free(op->queue[i].path);
+    }
+    furi_string_free(op->path);
+}
@@ -0,0 +1,157 @@
+#include "lora_uart.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <furi_hal_serial.h>
+#include <inttypes.h>
+#include <string.h>
+
+#define TAG "LoRaTester"
+#define LORA_TESTER_UART_ID FuriHalSerialIdUsart
+/** Bytes handed to the consumer per call, drained onto the ISR stack */
+#define LORA_TESTER_UART_RX_CHUNK 32
+
+struct LoraTesterUart {
+    FuriHalSerialHandle* handle;
+    /** Held for the whole of a session */
+    FuriMutex* mutex;
+    uint32_t baud_rate;
+    /** Swapped with interrupts off so the ISR never sees a callback with the wrong context */
+    LoraTesterUartRxCallback callback;
+    void* context;
+    uint32_t claims;
+    uint32_t inits;
+};
+
+static void lora_tester_uart_rx_cb(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    void* context) {
+    LoraTesterUart* uart = context;
+    LoraTesterUartRxCallback callback = uart->callback;
+    uint8_t data[LORA_TESTER_UART_RX_CHUNK];
+    size_t length = 0;
+
+    // The FIFO is drained even without a consumer, so nothing stale reaches the next one
+    if(event & FuriHalSerialRxEventData) {
+        while(furi_hal_serial_async_rx_available(handle)) {
+            data[length++] = furi_hal_serial_async_rx(handle);
+            if(length == sizeof(data)) {
+                if(callback) {
+                    callback(data, length, false, uart->context);
+                }
+                length = 0;
+            }
+        }
+    }
+
+    bool idle = event & FuriHalSerialRxEventIdle;
+    if(callback && (length || idle)) {
+        callback(data, length, idle, uart->context);
+    }
+}
+
+static bool lora_tester_uart_open(LoraTesterUart* uart, uint32_t baud_rate) {
+    if(uart->handle) {
+        return true;
+    }
+
+    uart->handle = furi_hal_serial_control_acquire(LORA_TESTER_UART_ID);
+    if(!uart->handle) {
+        FURI_LOG_E(TAG, "Failed to acquire serial handle");
+        return false;
+    }
+
+    furi_hal_serial_init(uart->handle, baud_rate);
+    uart->baud_rate = baud_rate;
+    uart->inits++;
+    furi_hal_serial_async_rx_start(uart->handle, lora_tester_uart_rx_cb, uart, false);
+    FURI_LOG_I(TAG, "Serial port open at %" PRIu32 " baud", baud_rate);
+    return true;
+}
+
+static void lora_tester_uart_route(
+    LoraTesterUart* uart,
+    LoraTesterUartRxCallback callback,
+    void* context) {
+    FURI_CRITICAL_ENTER();
+    uart->callback = callback;
+    uart->context = context;
+    FURI_CRITICAL_EXIT();
+}
+
+LoraTesterUart* lora_tester_uart_alloc(void) {
+    LoraTesterUart* uart = malloc(sizeof(LoraTesterUart));
+    memset(uart, 0, sizeof(LoraTesterUart));
+    uart->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    return uart;
+}
+
+void lora_tester_uart_free(LoraTesterUart* uart) {
+    furi_assert(uart);
+    furi_assert(!uart->callback);
+
+    if(uart->handle) {
+        furi_hal_serial_async_rx_stop(uart->handle);
+        furi_hal_serial_deinit(uart->handle);
+        furi_hal_serial_control_release(uart->handle);
+    }
+    FURI_LOG_I(
+        TAG, "Serial port: %" PRIu32 " claims, %" PRIu32 " inits", uart->claims, uart->inits);
+    furi_mutex_free(uart->mutex);
+    free(uart);
+}
+
+bool lora_tester_uart_claim(
+    LoraTesterUart* uart,
+    uint32_t baud_rate,
+    LoraTesterUartRxCallback callback,
+    void* context,
+    uint32_t timeout_ms) {
+    furi_assert(uart);
+
+    if(furi_mutex_acquire(uart->mutex, furi_ms_to_ticks(timeout_ms)) != FuriStatusOk) {
+        FURI_LOG_E(TAG, "Serial port still in use after %" PRIu32 "ms", timeout_ms);
+        return false;
+    }
+    if(!lora_tester_uart_open(uart, baud_rate)) {
+        furi_mutex_release(uart->mutex);
+        return false;
+    }
+
+    lora_tester_uart_set_baud_rate(uart, baud_rate);
+    lora_tester_uart_route(uart, callback, context);
+    uart->claims++;
+    return true;
+}
+
+void lora_tester_uart_release(LoraTesterUart* uart) {
+    furi_assert(uart);
+    lora_tester_uart_route(uart, NULL, NULL);
+    furi_mutex_release(uart->mutex);
+}
+
+void lora_tester_uart_set_baud_rate(LoraTesterUart* uart, uint32_t baud_rate) {
+    furi_assert(uart);
+    furi_assert(uart->handle);
+    if(uart->baud_rate != baud_rate) {
+        furi_hal_serial_set_br(uart->handle, baud_rate);
+        uart->baud_rate = baud_rate;
+    }
+}
+
+void lora_tester_uart_tx(LoraTesterUart* uart, const uint8_t* data, size_t length) {
+    furi_assert(uart);
+    furi_assert(uart->handle);
+    furi_hal_serial_tx(uart->handle, data, length);
+    furi_hal_serial_tx_wait_complete(uart->handle);
+}
+
+uint32_t lora_tester_uart_get_claims(LoraTesterUart* uart) {
+    furi_assert(uart);
+    return uart->claims;
+}
+
+uint32_t lora_tester_uart_get_inits(LoraTesterUart* uart) {
+    furi_assert(uart);
+    return uart->inits;
+}
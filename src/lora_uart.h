@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Wait for the port when another consumer holds it, normally a scene still tearing down */
+#define LORA_TESTER_UART_CLAIM_TIMEOUT_MS 1000
+
+/** Called from the USART interrupt with the bytes drained in one pass
+ *
+ * @param      data     received bytes, valid only during the call
+ * @param      length   number of bytes, 0 when only idle is reported
+ * @param      idle     the line went quiet for a character time after data
+ * @param      context  consumer context
+ */
+typedef void (*LoraTesterUartRxCallback)(
+    const uint8_t* data,
+    size_t length,
+    bool idle,
+    void* context);
+
+/** USART shared by everything that talks to the module.
+ *
+ * The port is acquired and initialised on first use and kept until the app
+ * exits. Consumers claim it for a session, which sets the baud rate and
+ * routes RX to their callback, and release it when done. Nothing is torn
+ * down between sessions, so a claim costs a mutex and at most a baud rate
+ * change.
+ */
+typedef struct LoraTesterUart LoraTesterUart;
+
+LoraTesterUart* lora_tester_uart_alloc(void);
+
+/** Deinitialise and release the USART, no session may be open */
+void lora_tester_uart_free(LoraTesterUart* uart);
+
+/** Take the port for exclusive use
+ *
+ * Must be released from the same thread.
+ *
+ * @param      callback  RX callback, NULL to drop received bytes
+ *
+ * @return     false if the USART can't be acquired or another session
+ *             didn't end within timeout_ms
+ */
+bool lora_tester_uart_claim(
+    LoraTesterUart* uart,
+    uint32_t baud_rate,
+    LoraTesterUartRxCallback callback,
+    void* context,
+    uint32_t timeout_ms);
+
+/** End a session, RX is dropped until the next claim */
+void lora_tester_uart_release(LoraTesterUart* uart);
+
+/** Change the rate inside a session, a no-op when it is already set */
+void lora_tester_uart_set_baud_rate(LoraTesterUart* uart, uint32_t baud_rate);
+
+/** Send data and wait until the last bit has left the shift register */
+void lora_tester_uart_tx(LoraTesterUart* uart, const uint8_t* data, size_t length);
+
+/** Claims made so far, and how many of them had to acquire and initialise the USART */
+uint32_t lora_tester_uart_get_claims(LoraTesterUart* uart);
+uint32_t lora_tester_uart_get_inits(LoraTesterUart* uart);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,76 @@
+#include "../lora_tester_app_i.h"
+
+static uint32_t bench_per(uint64_t cycles, uint32_t count) {
+    return count ? (uint32_t)(cycles / count) : 0;
+}
+
+static void bench_show_results(LoraTesterApp* app) {
+    LoraTesterOp* op = &app->op;
+    FuriString* text = app->text_box_store;
+
+    furi_string_printf(
+        text,
+        "%s, %u packets\nCycles per byte (ISR/worker),\nper refresh, drops, latency\n\n",
+        op->bench_recorded ? "bench.bin" : "Synthetic",
+        op->bench_packets);
+    for(uint8_t i = 0; i < op->bench_count; i++) {
+        const LoraRxBenchResult* result = &op->bench[i];
+        furi_string_cat_printf(
+            text,
+            "%lu: %lu/%lu, %lu\n  %lu lost, %lu/%lums\n",
+            result->baud_rate,
+            bench_per(result->isr_cycles, result->bytes),
+            bench_per(result->worker_cycles, result->bytes),
+            bench_per(result->refresh_cycles, result->refreshes),
+            result->dropped + result->overruns,
+            result->latency_mean_us / 1000,
+            result->latency_max_us / 1000);
+    }
+    if(op->bench_max_rate) {
+        furi_string_cat_printf(text, "\nMax rate: %lu baud\n", op->bench_max_rate);
+    }
+
+    text_box_set_text(app->text_box, furi_string_get_cstr(text));
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewTextBox);
+}
+
+void lora_tester_scene_bench_on_enter(void* context) {
+    LoraTesterApp* app = context;
+
+    text_box_reset(app->text_box);
+    text_box_set_font(app->text_box, TextBoxFontText);
+    furi_string_reset(app->text_box_store);
+
+    lora_tester_op_start_bench(app);
+    lora_tester_op_show_progress(app, "RX Benchmark");
+}
+
+bool lora_tester_scene_bench_on_event(void* context, SceneManagerEvent event) {
+    LoraTesterApp* app = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        if(event.event == LoraTesterCustomEventOpProgress) {
+            lora_tester_op_update_progress(app);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpDone) {
+            if(lora_tester_op_take_result(app, LoraTesterOpBench)) {
+                bench_show_results(app);
+            }
+            consumed = true;
+        }
+    } else if(event.type == SceneManagerEventTypeBack) {
+        consumed = scene_manager_search_and_switch_to_previous_scene(
+            app->scene_manager, LoraTesterSceneStart);
+    }
+
+    return consumed;
+}
+
+void lora_tester_scene_bench_on_exit(void* context) {
+    LoraTesterApp* app = context;
+
+    lora_tester_op_cancel(app);
+    text_box_reset(app->text_box);
+    furi_string_reset(app->text_box_store);
+}
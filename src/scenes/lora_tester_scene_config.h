@@ -5,5 +5,11 @@ ADD_SCENE(lora_tester, configure, Configure)
 ADD_SCENE(lora_tester, config_load, ConfigLoad)
 ADD_SCENE(lora_tester, about, About)
 ADD_SCENE(lora_tester, receive, Receive)
+ADD_SCENE(lora_tester, send, Send)
+ADD_SCENE(lora_tester, send_targets, SendTargets)
+ADD_SCENE(lora_tester, send_file, SendFile)
+ADD_SCENE(lora_tester, rssi, Rssi)
+ADD_SCENE(lora_tester, survey, Survey)
+ADD_SCENE(lora_tester, bench, Bench)
 ADD_SCENE(lora_tester, address_input, AddressInput)
 ADD_SCENE(lora_tester, encryption_key, EncryptionKey)
@@ -1,62 +1,35 @@
 #include "../lora_tester_app_i.h"
-#include <furi_hal_serial.h>
 #include <furi_hal.h>
 #include <gui/elements.h>
 #include "../lora_config_binary_convert.h"
 #include "lora_tester_icons.h"
 
-#define LORA_RX_BUFFER_SIZE 256
-#define LORA_SEARCH_TIMEOUT 3000
-
-static uint8_t rx_buffer[LORA_RX_BUFFER_SIZE];
-static size_t rx_buffer_index = 0;
-static LoRaMode original_mode;
 
 static void update_channel_range(LoraTesterApp* app, uint8_t air_data_rate_index);
+static uint8_t air_data_rate_bw_bits(uint8_t air_data_rate_index);
 static void update_frequency_display(LoraTesterApp* app, uint8_t channel, uint8_t bw);
 
-static const char* uart_rates[] =
-    {"1200", "2400", "4800", "9600", "19200", "38400", "57600", "115200"};
-static const char* sub_packet_sizes[] = {"200", "128", "64", "32"};
-static const char* air_data_rates[] = {
-    "15.6k, SF:5,125kHz",
-    "9.37k, SF:6,125kHz",
-    "5.47k, SF:7,125kHz",
-    "3.12k, SF:8,125kHz",
-    "1.76k, SF:9,125kHz",
-    "31.25k, SF:5,250kHz",
-    "18.8k, SF:6,250kHz",
-    "11k, SF:7,250kHz",
-    "6.25k, SF:8,250kHz",
-    "3.51k, SF:9,250kHz",
-    "1.95k, SF:10,250kHz",
-    "62.5k, SF:5,500kHz",
-    "37.5k, SF:6,500kHz",
-    "21.9k, SF:7,500kHz",
-    "12.5k, SF:8,500kHz",
-    "7.03k, SF:9,500kHz",
-    "3.9k, SF:10,500kHz",
-    "2.14k, SF:11,500kHz"};
 static const char* rssi_options[] = {"Disable", "Enable"};
-static const char* tx_powers[] = {"22", "17", "13", "0"};
 static const char* transmission_methods[] = {"Transparent", "Fixed"};
-static const char* wor_cycles[] = {"500", "1000", "1500", "2000", "2500", "3000", "3500", "4000"};
+static LoRaConfig loaded_config;
+
+static uint8_t value_index(const uint32_t* values, size_t count, uint32_t value) {
+    for(size_t i = 0; i < count; i++) {
+        if(values[i] == value) {
+            return i;
+        }
+    }
+    return 0;
+}
 
-static uint32_t get_current_baud_rate(LoraTesterApp* app) {
-    return app->baud_rate;
+static void set_number_text(VariableItem* item, uint32_t value) {
+    char value_str[12];
+    snprintf(value_str, sizeof(value_str), "%lu", value);
+    variable_item_set_current_value_text(item, value_str);
 }
 
-static uint8_t get_max_channel(uint8_t bw) {
-    switch(bw) {
-    case 0: // BW125kHz
-        return 37;
-    case 1: // BW250kHz
-        return 36;
-    case 2: // BW500kHz
-        return 30;
-    default:
-        return 0;
-    }
+static uint8_t air_data_rate_bw_bits(uint8_t air_data_rate_index) {
+    return LORA_CONFIG_BW_BITS(lora_air_data_rates[air_data_rate_index].code);
 }
 
 static void update_frequency_display(LoraTesterApp* app, uint8_t channel, uint8_t bw) {
@@ -66,26 +39,15 @@ static void update_frequency_display(LoraTesterApp* app, uint8_t channel, uint8_
         return;
     }
 
-    float base_freq;
-    switch(bw) {
-    case 0: // BW125kHz
-        base_freq = 920.6f;
-        break;
-    case 1: // BW250kHz
-        base_freq = 920.7f;
-        break;
-    case 2: // BW500kHz
-        base_freq = 920.8f;
-        break;
-    default:
+    uint32_t khz = lora_config_channel_khz(channel, bw);
+    if(khz == 0) {
         FURI_LOG_E("LoRaTester", "Invalid bandwidth value: %d", bw);
         return;
     }
 
-    float frequency = base_freq + channel * 0.2f;
-
     char freq_str[32];
-    int ret = snprintf(freq_str, sizeof(freq_str), "%d (%.1f MHz)", channel, (double)frequency);
+    int ret = snprintf(
+        freq_str, sizeof(freq_str), "%d (%lu.%lu MHz)", channel, khz / 1000, khz % 1000 / 100);
     if(ret < 0 || ret >= (int)sizeof(freq_str)) {
         FURI_LOG_E("LoRaTester", "Error formatting frequency string");
         return;
@@ -101,77 +63,30 @@ static void update_frequency_display(LoraTesterApp* app, uint8_t channel, uint8_
     FURI_LOG_I("LoRaTester", "Updated frequency display: %s", freq_str);
 }
 
-static void lora_tester_uart_rx_callback(
-    FuriHalSerialHandle* handle,
-    FuriHalSerialRxEvent event,
-    void* context) {
-    UNUSED(context);
-
-    if(event == FuriHalSerialRxEventData) {
-        uint8_t data = furi_hal_serial_async_rx(handle);
-        if(rx_buffer_index < LORA_RX_BUFFER_SIZE) {
-            rx_buffer[rx_buffer_index++] = data;
-        }
-    }
-}
-
 static void get_current_config(LoraTesterApp* app, LoRaConfig* config) {
-    // 初期値を設定
-    memset(config, 0, sizeof(LoRaConfig));
-    config->baud_rate = 9600;
-    config->bw = 125;
-    config->sf = 7;
-    config->subpacket_size = 200;
-    config->transmitting_power = 13;
-    config->wor_cycle = 2000;
+    // Address and key aren't editable here, keep what was read
+    *config = loaded_config;
 
     for(int i = 0; i < ConfigureItemCount; i++) {
         VariableItem* item = app->config_items->items[i];
         uint8_t index = variable_item_get_current_value_index(item);
 
         switch(i) {
-        case ConfigureItemAddress:
-            config->own_address = index;
-            break;
         case ConfigureItemUARTRate:
-            config->baud_rate = atoi(uart_rates[index]);
+            config->baud_rate = lora_config_uart_rates[index];
             break;
         case ConfigureItemAirDataRate:
-            if(index < 5) {
-                config->bw = 125;
-                config->sf = index + 5;
-            } else if(index < 11) {
-                config->bw = 250;
-                config->sf = (index - 5) + 5;
-            } else {
-                config->bw = 500;
-                config->sf = (index - 11) + 5;
-            }
+            config->bw = lora_air_data_rates[index].bw;
+            config->sf = lora_air_data_rates[index].sf;
             break;
         case ConfigureItemSubPacketSize:
-            config->subpacket_size = atoi(sub_packet_sizes[index]);
+            config->subpacket_size = lora_config_subpacket_sizes[index];
             break;
         case ConfigureItemRSSIAmbient:
             config->rssi_ambient_noise_flag = index;
             break;
         case ConfigureItemTxPower:
-            switch(index) {
-            case 0:
-                config->transmitting_power = 22;
-                break;
-            case 1:
-                config->transmitting_power = 17;
-                break;
-            case 2:
-                config->transmitting_power = 13;
-                break;
-            case 3:
-                config->transmitting_power = 0;
-                break;
-            default:
-                config->transmitting_power = 13;
-                break;
-            }
+            config->transmitting_power = lora_config_tx_powers[index];
             break;
         case ConfigureItemChannel:
             config->own_channel = index;
@@ -183,10 +98,7 @@ static void get_current_config(LoraTesterApp* app, LoRaConfig* config) {
             config->transmission_method_type = index;
             break;
         case ConfigureItemWORCycle:
-            config->wor_cycle = (index + 1) * 500;
-            break;
-        case ConfigureItemEncryptionKey:
-            config->encryption_key = index;
+            config->wor_cycle = lora_config_wor_cycles[index];
             break;
         default:
             break;
@@ -194,145 +106,79 @@ static void get_current_config(LoraTesterApp* app, LoRaConfig* config) {
     }
 }
 
-static void show_saved_popup(LoraTesterApp* app) {
-    popup_reset(app->popup);
-
-    popup_set_header(app->popup, "SAVED!!", 24, 10, AlignCenter, AlignTop);
-    popup_set_icon(app->popup, 22, 6, &I_DolphinNice_96x59);
-    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewPopup);
-    furi_delay_ms(1000);
-    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+static void configure_popup_callback(void* context) {
+    LoraTesterApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventPopupDone);
 }
 
-static void send_config_to_lora_module(LoraTesterApp* app) {
-    LoRaConfig config;
-    get_current_config(app, &config);
-
-    uint8_t command[11] = {0xC0, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-    // Address
-    command[3] = (config.own_address >> 8) & 0xFF;
-    command[4] = config.own_address & 0xFF;
-
-    // UART Rate and Air Data Rate
-    uint8_t uart_rate_bits = 0;
-    switch(config.baud_rate) {
-    case 1200:
-        uart_rate_bits = 0;
-        break;
-    case 2400:
-        uart_rate_bits = 1;
-        break;
-    case 4800:
-        uart_rate_bits = 2;
-        break;
-    case 9600:
-        uart_rate_bits = 3;
-        break;
-    case 19200:
-        uart_rate_bits = 4;
-        break;
-    case 38400:
-        uart_rate_bits = 5;
-        break;
-    case 57600:
-        uart_rate_bits = 6;
-        break;
-    case 115200:
-        uart_rate_bits = 7;
-        break;
-    default:
-        uart_rate_bits = 3;
-        break; // Default to 9600
-    }
-
-    uint8_t air_data_rate_bits = 0;
-    if(config.bw == 125) {
-        air_data_rate_bits = (config.sf - 5) * 4;
-    } else if(config.bw == 250) {
-        air_data_rate_bits = 1 + (config.sf - 5) * 4;
-    } else if(config.bw == 500) {
-        air_data_rate_bits = 2 + (config.sf - 5) * 4;
-    }
+/** Show header for a second, the popup timeout brings the list back */
+static void show_saved_popup(LoraTesterApp* app, const char* header, bool success) {
+    popup_reset(app->popup);
 
-    command[5] = (uart_rate_bits << 5) | air_data_rate_bits;
-
-    // Sub Packet Size, RSSI Ambient, and Tx Power
-    uint8_t sub_packet_bits = 0;
-    switch(config.subpacket_size) {
-    case 200:
-        sub_packet_bits = 0;
-        break;
-    case 128:
-        sub_packet_bits = 1;
-        break;
-    case 64:
-        sub_packet_bits = 2;
-        break;
-    case 32:
-        sub_packet_bits = 3;
-        break;
-    default:
-        sub_packet_bits = 0;
-        break;
+    if(success) {
+        popup_set_header(app->popup, header, 24, 10, AlignCenter, AlignTop);
+        popup_set_icon(app->popup, 22, 6, &I_DolphinNice_96x59);
+    } else {
+        popup_set_header(app->popup, "Write failed", 64, 10, AlignCenter, AlignTop);
+        popup_set_text(app->popup, header, 64, 36, AlignCenter, AlignCenter);
     }
+    popup_set_context(app->popup, app);
+    popup_set_callback(app->popup, configure_popup_callback);
+    popup_set_timeout(app->popup, 1000);
+    popup_enable_timeout(app->popup);
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewPopup);
+}
 
-    uint8_t tx_power_bits = 0;
-    switch(config.transmitting_power) {
-    case 22:
-        tx_power_bits = 0;
-        break;
-    case 17:
-        tx_power_bits = 1;
-        break;
-    case 13:
-        tx_power_bits = 2;
-        break;
-    case 0:
-        tx_power_bits = 3;
-        break;
-    default:
-        tx_power_bits = 2;
-        break; // Default to 13dBm
+static void update_save_state(LoraTesterApp* app) {
+    VariableItem* item = app->config_items->items[ConfigureItemSave];
+    if(item) {
+        variable_item_set_current_value_text(item, app->shadow.trial ? "Unsaved" : "Saved");
     }
+}
 
-    command[6] = (sub_packet_bits << 6) | (config.rssi_ambient_noise_flag << 5) | tx_power_bits;
-
-    // Channel
-    command[7] = config.own_channel;
+static void send_config_to_lora_module(LoraTesterApp* app, bool temporary) {
+    LoRaConfig config;
+    get_current_config(app, &config);
 
-    // RSSI Byte, Transmission Method, and WOR Cycle
-    uint8_t wor_cycle_bits = (config.wor_cycle / 500) - 1;
-    if(wor_cycle_bits > 7) wor_cycle_bits = 7;
+    uint8_t registers[LORA_CONFIG_REG_COUNT];
+    lora_config_encode(&config, registers);
 
-    command[8] = (config.rssi_byte_flag << 7) | (config.transmission_method_type << 6) |
-                 wor_cycle_bits;
+    lora_tester_op_start_apply(app, registers, temporary);
+    lora_tester_op_show_progress(app, temporary ? "Trying Config" : "Saving Config");
+}
 
-    // Encryption Key
-    command[9] = (config.encryption_key >> 8) & 0xFF;
-    command[10] = config.encryption_key & 0xFF;
+/** The list can't change under the popup, so it still holds what was sent */
+static void config_sent(LoraTesterApp* app) {
+    bool temporary = app->op.temporary;
+    size_t writes = app->op.writes;
 
-    uint32_t current_baud_rate = get_current_baud_rate(app);
-    FuriHalSerialHandle* serial_handle = furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
-    if(serial_handle == NULL) {
-        FURI_LOG_E("LoRaTester", "Failed to acquire serial handle");
+    if(app->op.status != LoraModuleStatusOk) {
+        show_saved_popup(app, lora_module_status_name(app->op.status), false);
         return;
     }
 
-    furi_hal_serial_init(serial_handle, current_baud_rate);
-    furi_hal_serial_enable_direction(
-        serial_handle, FuriHalSerialDirectionRx | FuriHalSerialDirectionTx);
-
-    furi_hal_serial_tx(serial_handle, command, sizeof(command));
-    furi_hal_serial_tx_wait_complete(serial_handle);
-
-    furi_delay_ms(100);
-
-    furi_hal_serial_deinit(serial_handle);
-    furi_hal_serial_control_release(serial_handle);
+    LoRaConfig config;
+    get_current_config(app, &config);
+    loaded_config = config;
+    FURI_LOG_I(
+        "LoRaTester",
+        "Config %s at %lu baud in %u writes",
+        temporary ? "tried" : "saved",
+        app->baud_rate,
+        writes);
+    update_save_state(app);
+    if(writes == 0) {
+        show_saved_popup(app, "NO CHANGE", true);
+    } else {
+        show_saved_popup(app, temporary ? "TRYING" : "SAVED!!", true);
+    }
+}
 
-    FURI_LOG_I("LoRaTester", "Config sent to LoRa module at %lu baud", current_baud_rate);
-    show_saved_popup(app);
+static void configure_enter_callback(void* context, uint32_t index) {
+    LoraTesterApp* app = context;
+    if(index == ConfigureItemSave || index == ConfigureItemTry) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, index);
+    }
 }
 
 static void configure_item_change_callback(VariableItem* item) {
@@ -351,26 +197,31 @@ static void configure_item_change_callback(VariableItem* item) {
                 FURI_LOG_D("LoRaTester", "Address changed to: %s", value_str);
             } break;
             case ConfigureItemUARTRate:
-                variable_item_set_current_value_text(item, uart_rates[index]);
-                FURI_LOG_D("LoRaTester", "UART Rate changed to: %s", uart_rates[index]);
+                set_number_text(item, lora_config_uart_rates[index]);
+                FURI_LOG_D(
+                    "LoRaTester", "UART Rate changed to: %lu", lora_config_uart_rates[index]);
                 break;
             case ConfigureItemAirDataRate:
-                variable_item_set_current_value_text(item, air_data_rates[index]);
-                FURI_LOG_D("LoRaTester", "Air Data Rate changed to: %s", air_data_rates[index]);
+                variable_item_set_current_value_text(item, lora_air_data_rates[index].name);
+                FURI_LOG_D(
+                    "LoRaTester", "Air Data Rate changed to: %s", lora_air_data_rates[index].name);
                 update_channel_range(app, index);
                 break;
             case ConfigureItemSubPacketSize:
-                variable_item_set_current_value_text(item, sub_packet_sizes[index]);
+                set_number_text(item, lora_config_subpacket_sizes[index]);
                 FURI_LOG_D(
-                    "LoRaTester", "Sub Packet Size changed to: %s", sub_packet_sizes[index]);
+                    "LoRaTester",
+                    "Sub Packet Size changed to: %lu",
+                    lora_config_subpacket_sizes[index]);
                 break;
             case ConfigureItemRSSIAmbient:
                 variable_item_set_current_value_text(item, rssi_options[index]);
                 FURI_LOG_D("LoRaTester", "RSSI Ambient changed to: %s", rssi_options[index]);
                 break;
             case ConfigureItemTxPower:
-                variable_item_set_current_value_text(item, tx_powers[index]);
-                FURI_LOG_D("LoRaTester", "Tx Power changed to: %s", tx_powers[index]);
+                set_number_text(item, lora_config_tx_powers[index]);
+                FURI_LOG_D(
+                    "LoRaTester", "Tx Power changed to: %lu", lora_config_tx_powers[index]);
                 break;
             case ConfigureItemChannel: {
                 char channel_str[8];
@@ -384,8 +235,8 @@ static void configure_item_change_callback(VariableItem* item) {
                 if(air_data_rate_item) {
                     uint8_t air_data_rate_index =
                         variable_item_get_current_value_index(air_data_rate_item);
-                    uint8_t bw = air_data_rate_index / 5;
-                    update_frequency_display(app, index, bw);
+                    update_frequency_display(
+                        app, index, air_data_rate_bw_bits(air_data_rate_index));
                 }
             } break;
             case ConfigureItemRSSIByte:
@@ -397,8 +248,9 @@ static void configure_item_change_callback(VariableItem* item) {
                 FURI_LOG_D("LoRaTester", "Tx Method changed to: %s", transmission_methods[index]);
                 break;
             case ConfigureItemWORCycle:
-                variable_item_set_current_value_text(item, wor_cycles[index]);
-                FURI_LOG_D("LoRaTester", "WOR Cycle changed to: %s", wor_cycles[index]);
+                set_number_text(item, lora_config_wor_cycles[index]);
+                FURI_LOG_D(
+                    "LoRaTester", "WOR Cycle changed to: %lu", lora_config_wor_cycles[index]);
                 break;
             case ConfigureItemEncryptionKey: {
                 char key_str[16];
@@ -406,10 +258,6 @@ static void configure_item_change_callback(VariableItem* item) {
                 variable_item_set_current_value_text(item, key_str);
                 FURI_LOG_D("LoRaTester", "Encryption Key changed to: %s", key_str);
             } break;
-            case ConfigureItemSave:
-                FURI_LOG_I("LoRaTester", "Save button pressed");
-                send_config_to_lora_module(app);
-                break;
             default:
                 FURI_LOG_W("LoRaTester", "Unknown item changed, index: %d", i);
                 break;
@@ -421,8 +269,8 @@ static void configure_item_change_callback(VariableItem* item) {
 
 // Channel の範囲を更新する関数
 static void update_channel_range(LoraTesterApp* app, uint8_t air_data_rate_index) {
-    uint8_t bw = air_data_rate_index / 5; // Approximate BW from air data rate index
-    uint8_t max_channel = get_max_channel(bw);
+    uint8_t bw = air_data_rate_bw_bits(air_data_rate_index);
+    uint8_t max_channel = lora_config_max_channel(bw);
 
     VariableItem* channel_item = app->config_items->items[ConfigureItemChannel];
     if(channel_item) {
@@ -439,46 +287,21 @@ static void update_channel_range(LoraTesterApp* app, uint8_t air_data_rate_index
     }
 }
 
-static void load_configure_data(LoraTesterApp* app) {
-    uint32_t current_baud_rate = get_current_baud_rate(app);
-    FuriHalSerialHandle* serial_handle = furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
-    if(serial_handle == NULL) {
-        FURI_LOG_E("LoRaTester", "Failed to acquire serial handle");
-        return;
-    }
-
-    furi_hal_serial_init(serial_handle, current_baud_rate);
-    furi_hal_serial_enable_direction(
-        serial_handle, FuriHalSerialDirectionRx | FuriHalSerialDirectionTx);
-
-    rx_buffer_index = 0;
-    furi_hal_serial_async_rx_start(serial_handle, lora_tester_uart_rx_callback, NULL, true);
-
-    uint8_t command[] = {0xC1, 0x00, 0x08};
-    furi_hal_serial_tx(serial_handle, command, sizeof(command));
-    furi_hal_serial_tx_wait_complete(serial_handle);
-
-    uint32_t start_time = furi_get_tick();
-    while(furi_get_tick() - start_time < LORA_SEARCH_TIMEOUT) {
-        if(rx_buffer_index >= 11) {
-            break;
-        }
-        furi_delay_ms(100);
-    }
-
-    furi_hal_serial_async_rx_stop(serial_handle);
-    furi_hal_serial_deinit(serial_handle);
-    furi_hal_serial_control_release(serial_handle);
-
-    if(rx_buffer_index >= 11) {
-        FURI_LOG_I("LoRaTester", "Received %d bytes from LoRa module", rx_buffer_index);
+static void load_configure_data(
+    LoraTesterApp* app,
+    LoraModuleStatus status,
+    const uint8_t* registers) {
+    if(status == LoraModuleStatusOk) {
         VariableItemList* var_item_list = app->var_item_list;
         VariableItem* item;
         char value_str[32];
+        uint8_t index;
+
+        LoRaConfig* config = &loaded_config;
+        lora_config_decode(registers, config);
 
         // Address
-        uint16_t address = (rx_buffer[3] << 8) | rx_buffer[4];
-        snprintf(value_str, sizeof(value_str), "0x%04X", address);
+        snprintf(value_str, sizeof(value_str), "0x%04X", config->own_address);
         item = variable_item_list_add(
             var_item_list, "Address", 1, configure_item_change_callback, app);
         app->config_items->items[ConfigureItemAddress] = item;
@@ -486,38 +309,52 @@ static void load_configure_data(LoraTesterApp* app) {
         FURI_LOG_D("LoRaTester", "Address set to: %s", value_str);
 
         // UART Rate
-        uint8_t uart_rate = (rx_buffer[5] & 0b11100000) >> 5;
+        index = value_index(
+            lora_config_uart_rates, COUNT_OF(lora_config_uart_rates), config->baud_rate);
         item = variable_item_list_add(
-            var_item_list, "UART Rate", COUNT_OF(uart_rates), configure_item_change_callback, app);
+            var_item_list,
+            "UART Rate",
+            COUNT_OF(lora_config_uart_rates),
+            configure_item_change_callback,
+            app);
         app->config_items->items[ConfigureItemUARTRate] = item;
-        variable_item_set_current_value_index(item, uart_rate);
-        variable_item_set_current_value_text(item, uart_rates[uart_rate]);
-        FURI_LOG_D("LoRaTester", "UART Rate set to: %s", uart_rates[uart_rate]);
+        variable_item_set_current_value_index(item, index);
+        set_number_text(item, config->baud_rate);
+        FURI_LOG_D("LoRaTester", "UART Rate set to: %lu", config->baud_rate);
 
         // Air Data Rate
-        uint8_t air_data_rate = rx_buffer[5] & 0b00011111;
+        int air_data_rate = lora_air_data_rate_find(config->bw, config->sf);
+        if(air_data_rate < 0) {
+            LoRaConfig defaults;
+            lora_config_set_defaults(&defaults);
+            air_data_rate = lora_air_data_rate_find(defaults.bw, defaults.sf);
+        }
         item = variable_item_list_add(
-            var_item_list, "ADR", COUNT_OF(air_data_rates), configure_item_change_callback, app);
+            var_item_list, "ADR", lora_air_data_rate_count, configure_item_change_callback, app);
         app->config_items->items[ConfigureItemAirDataRate] = item;
         variable_item_set_current_value_index(item, air_data_rate);
-        variable_item_set_current_value_text(item, air_data_rates[air_data_rate]);
-        FURI_LOG_D("LoRaTester", "Air Data Rate set to: %s", air_data_rates[air_data_rate]);
+        variable_item_set_current_value_text(item, lora_air_data_rates[air_data_rate].name);
+        FURI_LOG_D(
+            "LoRaTester", "Air Data Rate set to: %s", lora_air_data_rates[air_data_rate].name);
 
         // Sub Packet Size
-        uint8_t sub_packet_size = (rx_buffer[6] & 0b11000000) >> 6;
+        index = value_index(
+            lora_config_subpacket_sizes,
+            COUNT_OF(lora_config_subpacket_sizes),
+            config->subpacket_size);
         item = variable_item_list_add(
             var_item_list,
             "Sub Packet Size",
-            COUNT_OF(sub_packet_sizes),
+            COUNT_OF(lora_config_subpacket_sizes),
             configure_item_change_callback,
             app);
         app->config_items->items[ConfigureItemSubPacketSize] = item;
-        variable_item_set_current_value_index(item, sub_packet_size);
-        variable_item_set_current_value_text(item, sub_packet_sizes[sub_packet_size]);
-        FURI_LOG_D("LoRaTester", "Sub Packet Size set to: %s", sub_packet_sizes[sub_packet_size]);
+        variable_item_set_current_value_index(item, index);
+        set_number_text(item, config->subpacket_size);
+        FURI_LOG_D("LoRaTester", "Sub Packet Size set to: %d", config->subpacket_size);
 
         // RSSI Ambient Noise Flag
-        uint8_t rssi_ambient = (rx_buffer[6] & 0b00100000) >> 5;
+        index = config->rssi_ambient_noise_flag;
         item = variable_item_list_add(
             var_item_list,
             "RSSI Ambient",
@@ -525,23 +362,28 @@ static void load_configure_data(LoraTesterApp* app) {
             configure_item_change_callback,
             app);
         app->config_items->items[ConfigureItemRSSIAmbient] = item;
-        variable_item_set_current_value_index(item, rssi_ambient);
-        variable_item_set_current_value_text(item, rssi_options[rssi_ambient]);
-        FURI_LOG_D("LoRaTester", "RSSI Ambient set to: %s", rssi_options[rssi_ambient]);
+        variable_item_set_current_value_index(item, index);
+        variable_item_set_current_value_text(item, rssi_options[index]);
+        FURI_LOG_D("LoRaTester", "RSSI Ambient set to: %s", rssi_options[index]);
 
         // Transmitting Power
-        uint8_t transmit_power = rx_buffer[6] & 0b00000011;
+        index = value_index(
+            lora_config_tx_powers, COUNT_OF(lora_config_tx_powers), config->transmitting_power);
         item = variable_item_list_add(
-            var_item_list, "Tx Power", COUNT_OF(tx_powers), configure_item_change_callback, app);
+            var_item_list,
+            "Tx Power",
+            COUNT_OF(lora_config_tx_powers),
+            configure_item_change_callback,
+            app);
         app->config_items->items[ConfigureItemTxPower] = item;
-        variable_item_set_current_value_index(item, transmit_power);
-        variable_item_set_current_value_text(item, tx_powers[transmit_power]);
-        FURI_LOG_D("LoRaTester", "Tx Power set to: %s", tx_powers[transmit_power]);
+        variable_item_set_current_value_index(item, index);
+        set_number_text(item, config->transmitting_power);
+        FURI_LOG_D("LoRaTester", "Tx Power set to: %d", config->transmitting_power);
 
         // Channel
-        uint8_t channel = rx_buffer[7];
-        uint8_t bw = air_data_rate / 5; // Approximate BW from air data rate
-        uint8_t max_channel = get_max_channel(bw);
+        uint8_t channel = config->own_channel;
+        uint8_t bw = air_data_rate_bw_bits(air_data_rate);
+        uint8_t max_channel = lora_config_max_channel(bw);
         item = variable_item_list_add(
             var_item_list, "Channel", max_channel + 1, configure_item_change_callback, app);
         app->config_items->items[ConfigureItemChannel] = item;
@@ -554,7 +396,7 @@ static void load_configure_data(LoraTesterApp* app) {
         update_frequency_display(app, channel, bw);
 
         // RSSI Byte
-        uint8_t rssi_byte = (rx_buffer[8] & 0b10000000) >> 7;
+        index = config->rssi_byte_flag;
         item = variable_item_list_add(
             var_item_list,
             "RSSI Byte",
@@ -562,12 +404,12 @@ static void load_configure_data(LoraTesterApp* app) {
             configure_item_change_callback,
             app);
         app->config_items->items[ConfigureItemRSSIByte] = item;
-        variable_item_set_current_value_index(item, rssi_byte);
-        variable_item_set_current_value_text(item, rssi_options[rssi_byte]);
-        FURI_LOG_D("LoRaTester", "RSSI Byte set to: %s", rssi_options[rssi_byte]);
+        variable_item_set_current_value_index(item, index);
+        variable_item_set_current_value_text(item, rssi_options[index]);
+        FURI_LOG_D("LoRaTester", "RSSI Byte set to: %s", rssi_options[index]);
 
         // Transmission Method
-        uint8_t transmission_method = (rx_buffer[8] & 0b01000000) >> 6;
+        index = config->transmission_method_type;
         item = variable_item_list_add(
             var_item_list,
             "Tx Method",
@@ -575,36 +417,44 @@ static void load_configure_data(LoraTesterApp* app) {
             configure_item_change_callback,
             app);
         app->config_items->items[ConfigureItemTransmissionMethod] = item;
-        variable_item_set_current_value_index(item, transmission_method);
-        variable_item_set_current_value_text(item, transmission_methods[transmission_method]);
-        FURI_LOG_D(
-            "LoRaTester", "Tx Method set to: %s", transmission_methods[transmission_method]);
+        variable_item_set_current_value_index(item, index);
+        variable_item_set_current_value_text(item, transmission_methods[index]);
+        FURI_LOG_D("LoRaTester", "Tx Method set to: %s", transmission_methods[index]);
 
         // WOR Cycle
-        uint8_t wor_cycle = rx_buffer[8] & 0b00000111;
+        index = value_index(
+            lora_config_wor_cycles, COUNT_OF(lora_config_wor_cycles), config->wor_cycle);
         item = variable_item_list_add(
-            var_item_list, "WOR Cycle", COUNT_OF(wor_cycles), configure_item_change_callback, app);
+            var_item_list,
+            "WOR Cycle",
+            COUNT_OF(lora_config_wor_cycles),
+            configure_item_change_callback,
+            app);
         app->config_items->items[ConfigureItemWORCycle] = item;
-        variable_item_set_current_value_index(item, wor_cycle);
-        variable_item_set_current_value_text(item, wor_cycles[wor_cycle]);
-        FURI_LOG_D("LoRaTester", "WOR Cycle set to: %s", wor_cycles[wor_cycle]);
+        variable_item_set_current_value_index(item, index);
+        set_number_text(item, config->wor_cycle);
+        FURI_LOG_D("LoRaTester", "WOR Cycle set to: %d", config->wor_cycle);
 
         // Encryption Key
-        uint16_t encryption_key = (rx_buffer[9] << 8) | rx_buffer[10];
-        snprintf(value_str, sizeof(value_str), "0x%04X", encryption_key);
+        snprintf(value_str, sizeof(value_str), "0x%04X", config->encryption_key);
         item = variable_item_list_add(
             var_item_list, "Encryption Key", 1, configure_item_change_callback, app);
         app->config_items->items[ConfigureItemEncryptionKey] = item;
         variable_item_set_current_value_text(item, value_str);
         FURI_LOG_D("LoRaTester", "Encryption Key set to: %s", value_str);
 
-        // Save button
-        item =
-            variable_item_list_add(var_item_list, "Save", 1, configure_item_change_callback, app);
+        // Save button, OK on it goes through configure_enter_callback
+        item = variable_item_list_add(var_item_list, "Save", 1, NULL, app);
         app->config_items->items[ConfigureItemSave] = item;
+        update_save_state(app);
+
+        // Try button, applies with C2 so nothing is written to flash
+        item = variable_item_list_add(var_item_list, "Try", 1, NULL, app);
+        app->config_items->items[ConfigureItemTry] = item;
         variable_item_set_current_value_text(item, "Press OK");
+
+        variable_item_list_set_enter_callback(var_item_list, configure_enter_callback, app);
     } else {
-        FURI_LOG_E("LoRaTester", "Failed to receive data from LoRa module");
         variable_item_list_add(app->var_item_list, "Error", 0, NULL, NULL);
         variable_item_list_add(app->var_item_list, "Failed to load config", 0, NULL, NULL);
     }
@@ -624,15 +474,17 @@ void lora_tester_scene_configure_on_enter(void* context) {
     }
     memset(app->config_items, 0, sizeof(ConfigureItemsList));
 
-    original_mode = app->current_mode;
-    lora_tester_set_mode(app, LoRaMode_Config);
-
-    furi_delay_ms(100);
-
     variable_item_list_reset(app->var_item_list);
-    load_configure_data(app);
 
-    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+    if(lora_tester_shadow_current(app)) {
+        uint8_t registers[LORA_CONFIG_REG_COUNT];
+        LoraModuleStatus status = lora_tester_read_registers(app, registers, false);
+        load_configure_data(app, status, registers);
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+    } else {
+        lora_tester_op_start_read(app, false);
+        lora_tester_op_show_progress(app, "Reading Config");
+    }
 }
 
 bool lora_tester_scene_configure_on_event(void* context, SceneManagerEvent event) {
@@ -640,15 +492,26 @@ bool lora_tester_scene_configure_on_event(void* context, SceneManagerEvent event
     bool consumed = false;
 
     if(event.type == SceneManagerEventTypeBack) {
-        FURI_LOG_D(
-            "LoRaTester", "Restoring original LoRa mode: %s", lora_mode_names[original_mode]);
-        lora_tester_set_mode(app, original_mode);
-
         scene_manager_previous_scene(app->scene_manager);
         consumed = true;
     } else if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == ConfigureItemSave) {
-            send_config_to_lora_module(app);
+        if(event.event == ConfigureItemSave || event.event == ConfigureItemTry) {
+            send_config_to_lora_module(app, event.event == ConfigureItemTry);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpProgress) {
+            lora_tester_op_update_progress(app);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpDone) {
+            if(lora_tester_op_take_result(app, LoraTesterOpRead)) {
+                load_configure_data(app, app->op.status, app->op.registers);
+                view_dispatcher_switch_to_view(
+                    app->view_dispatcher, LoraTesterAppViewVarItemList);
+            } else if(lora_tester_op_take_result(app, LoraTesterOpApply)) {
+                config_sent(app);
+            }
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventPopupDone) {
+            view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
             consumed = true;
         }
     }
@@ -658,6 +521,8 @@ bool lora_tester_scene_configure_on_event(void* context, SceneManagerEvent event
 
 void lora_tester_scene_configure_on_exit(void* context) {
     LoraTesterApp* app = context;
+    lora_tester_op_cancel(app);
+    popup_reset(app->popup);
     variable_item_list_reset(app->var_item_list);
     if(app->config_items != NULL) {
         free(app->config_items);
@@ -1,11 +1,5 @@
 #include "../lora_tester_app_i.h"
 
-static LoRaMode original_mode;
-
-static uint32_t get_current_baud_rate(LoraTesterApp* app) {
-    return app->baud_rate;
-}
-
 static void lora_tester_scene_encryption_key_callback(void* context) {
     LoraTesterApp* app = context;
     view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventByteInputDone);
@@ -15,10 +9,6 @@ void lora_tester_scene_encryption_key_on_enter(void* context) {
     LoraTesterApp* app = context;
     ByteInput* byte_input = app->byte_input;
 
-    original_mode = app->current_mode;
-    lora_tester_set_mode(app, LoRaMode_Config);
-    furi_delay_ms(100);
-
     byte_input_set_header_text(byte_input, "Enter Encryption Key");
     byte_input_set_result_callback(
         byte_input,
@@ -40,37 +30,17 @@ bool lora_tester_scene_encryption_key_on_event(void* context, SceneManagerEvent
             uint16_t encryption_key = app->encryption_key;
             FURI_LOG_D("LoRaTester", "New encryption key: 0x%04X", encryption_key);
 
-            uint32_t current_baud_rate = get_current_baud_rate(app);
-            FuriHalSerialHandle* serial_handle =
-                furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
-            if(serial_handle == NULL) {
-                FURI_LOG_E("LoRaTester", "Failed to acquire serial handle");
-                return consumed;
+            uint8_t registers[2] = {encryption_key & 0xFF, (encryption_key >> 8) & 0xFF};
+            lora_tester_op_start_write(app, LoraRegCryptH, registers, sizeof(registers));
+            lora_tester_op_show_progress(app, "Writing Key");
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpProgress) {
+            lora_tester_op_update_progress(app);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpDone) {
+            if(lora_tester_op_take_result(app, LoraTesterOpWrite)) {
+                scene_manager_previous_scene(app->scene_manager);
             }
-
-            furi_hal_serial_init(serial_handle, current_baud_rate);
-            furi_hal_serial_enable_direction(
-                serial_handle, FuriHalSerialDirectionRx | FuriHalSerialDirectionTx);
-
-            uint8_t command[5] = {
-                0xC0, 0x06, 0x02, encryption_key & 0xFF, (encryption_key >> 8) & 0xFF};
-            furi_hal_serial_tx(serial_handle, command, sizeof(command));
-            furi_hal_serial_tx_wait_complete(serial_handle);
-            furi_delay_ms(100);
-
-            FURI_LOG_D(
-                "LoRaTester",
-                "Command sent: %02X %02X %02X %02X %02X",
-                command[0],
-                command[1],
-                command[2],
-                command[3],
-                command[4]);
-
-            furi_hal_serial_deinit(serial_handle);
-            furi_hal_serial_control_release(serial_handle);
-
-            scene_manager_previous_scene(app->scene_manager);
             consumed = true;
         }
     } else if(event.type == SceneManagerEventTypeBack) {
@@ -83,8 +53,6 @@ bool lora_tester_scene_encryption_key_on_event(void* context, SceneManagerEvent
 
 void lora_tester_scene_encryption_key_on_exit(void* context) {
     LoraTesterApp* app = context;
+    lora_tester_op_cancel(app);
     byte_input_set_result_callback(app->byte_input, NULL, NULL, NULL, NULL, 0);
-
-    furi_delay_ms(100);
-    lora_tester_set_mode(app, original_mode);
 }
\ No newline at end of file
@@ -1,47 +1,74 @@
 #include "../lora_tester_app_i.h"
-#include <furi_hal_serial.h>
 #include <gui/elements.h>
 
-#define UART_CH (FuriHalSerialIdUsart)
-#define MAX_BUFFER_SIZE 256
-
-static FuriHalSerialHandle* serial_handle = NULL;
+#define RX_FLUSH_INTERVAL_MS 20
+#define RX_REFRESH_FPS 8
+#define RX_STATS_INTERVAL_MS 1000
 
 static bool init_receive_context(LoraTesterApp* app);
 static void cleanup_receive_context(LoraTesterApp* app);
-static void cleanup_uart();
-static void reset_text_box(LoraTesterApp* app);
+static void cleanup_uart(LoraTesterApp* app);
 
 static uint32_t get_current_baud_rate(LoraTesterApp* app) {
     return app->baud_rate;
 }
 
-static void
-    uart_on_irq_cb(FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* context) {
+static void uart_on_rx_cb(const uint8_t* data, size_t length, bool idle, void* context) {
     LoraTesterApp* app = (LoraTesterApp*)context;
-    if(app && app->receive_context) {
-        ReceiveContext* receive_context = app->receive_context;
+    if(app && app->receive_context && app->worker_thread) {
+        uint32_t wake =
+            lora_rx_path_isr(&app->receive_context->rx, data, length, idle, furi_get_tick());
 
-        if(event == FuriHalSerialRxEventData) {
-            uint8_t data = furi_hal_serial_async_rx(handle);
-            furi_stream_buffer_send(receive_context->rx_stream, &data, 1, 0);
-            furi_thread_flags_set(furi_thread_get_id(app->worker_thread), WorkerEventRx);
+        uint32_t flags = 0;
+        if(wake & LoraRxPathWakeData) {
+            flags |= WorkerEventRx;
+        }
+        if(wake & LoraRxPathWakeIdle) {
+            flags |= WorkerEventRxIdle;
+        }
+        if(flags) {
+            furi_thread_flags_set(furi_thread_get_id(app->worker_thread), flags);
         }
     }
 }
 
+static void aux_edge_cb(bool level, void* context) {
+    LoraTesterApp* app = (LoraTesterApp*)context;
+    // AUX rises once the module has finished writing a received packet to the UART
+    if(level && app->worker_thread) {
+        furi_thread_flags_set(furi_thread_get_id(app->worker_thread), WorkerEventAux);
+    }
+}
+
+static void packet_received_cb(const LoraRxPacket* packet, void* context) {
+    ReceiveContext* receive_context = (ReceiveContext*)context;
+
+    if(receive_context->capture) {
+        lora_capture_write(receive_context->capture, packet);
+    }
+
+    furi_mutex_acquire(receive_context->mutex, FuriWaitForever);
+    lora_byte_log_mark_packet(&receive_context->history);
+    lora_byte_log_append(&receive_context->history, packet->data, packet->length);
+    lora_rx_stats_add(&receive_context->stats, packet->length, packet->start_tick);
+    receive_context->last_length = packet->length;
+    receive_context->last_rssi = packet->has_rssi ? -(256 - packet->rssi) : 0;
+    furi_mutex_release(receive_context->mutex);
+}
+
 static int32_t uart_worker(void* context) {
     LoraTesterApp* app = (LoraTesterApp*)context;
     ReceiveContext* receive_context = app->receive_context;
-    uint8_t data[MAX_BUFFER_SIZE];
-    size_t length = 0;
-    FuriString* new_str = furi_string_alloc();
+    LoraRxPath* rx = &receive_context->rx;
 
     while(1) {
-        uint32_t events =
-            furi_thread_flags_wait(WORKER_ALL_EVENTS, FuriFlagWaitAny, FuriWaitForever);
+        // Only arm the flush timer while bytes are pending, otherwise sleep until the ISR wakes us
+        uint32_t timeout = lora_rx_path_pending(rx) ? RX_FLUSH_INTERVAL_MS : FuriWaitForever;
+        uint32_t events = furi_thread_flags_wait(WORKER_ALL_EVENTS, FuriFlagWaitAny, timeout);
 
-        if(events & FuriFlagError) {
+        if(events == (uint32_t)FuriFlagErrorTimeout) {
+            events = WorkerEventRx;
+        } else if(events & FuriFlagError) {
             FURI_LOG_E("LoRaTester", "Worker thread error");
             break;
         }
@@ -51,36 +78,32 @@ static int32_t uart_worker(void* context) {
             break;
         }
 
-        if(events & WorkerEventRx) {
-            length =
-                furi_stream_buffer_receive(receive_context->rx_stream, data, MAX_BUFFER_SIZE, 0);
-            if(length > 0) {
-                furi_mutex_acquire(receive_context->mutex, FuriWaitForever);
-
-                for(size_t i = 0; i < length; i++) {
-                    furi_string_cat_printf(new_str, "%02X", data[i]);
-                    furi_string_push_back(new_str, ' ');
-                }
-
-                size_t new_text_length =
-                    furi_string_size(app->text_box_store) + furi_string_size(new_str);
-                if(new_text_length >= LORA_TESTER_TEXT_BOX_STORE_SIZE - 1) {
-                    size_t remove_length = new_text_length - LORA_TESTER_TEXT_BOX_STORE_SIZE + 1;
-                    furi_string_right(app->text_box_store, remove_length);
-                }
-
-                furi_string_cat(app->text_box_store, new_str);
-                furi_string_reset(new_str);
-
-                furi_mutex_release(receive_context->mutex);
+        if(events & (WorkerEventRx | WorkerEventRxIdle | WorkerEventAux)) {
+            uint32_t now = furi_get_tick();
+            uint32_t packets = lora_rx_path_drain(rx, now, events & WorkerEventAux);
 
+            // Requests that come too soon are picked up by the next tick instead
+            if(packets && lora_refresh_limiter_request(&receive_context->refresh, now)) {
                 view_dispatcher_send_custom_event(
                     app->view_dispatcher, LoraTesterCustomEventRefreshView);
             }
         }
     }
 
-    furi_string_free(new_str);
+    FURI_LOG_I(
+        "LoRaTester",
+        "RX: %lu bytes in %lu packets, %lu wakeups, %lu dropped",
+        rx->bytes,
+        rx->framer.packets,
+        rx->wakeups,
+        rx->ring.dropped);
+    FURI_LOG_I(
+        "LoRaTester",
+        "Refresh: %lu requests, %lu redraws, %lu merged",
+        receive_context->refresh.requests,
+        receive_context->refresh.draws,
+        receive_context->refresh.merged);
+
     return 0;
 }
 
@@ -95,10 +118,26 @@ static bool init_receive_context(LoraTesterApp* app) {
     }
 
     ReceiveContext* context = app->receive_context;
-    context->rx_stream = furi_stream_buffer_alloc(MAX_BUFFER_SIZE, 1);
+    // Until the module has been read the trailing RSSI byte can't be told from data
+    LoRaConfig config;
+    bool rssi_byte = lora_tester_current_config(app, &config) && config.rssi_byte_flag;
+    lora_rx_path_init(
+        &context->rx,
+        lora_rx_framer_gap_ms(get_current_baud_rate(app)),
+        rssi_byte,
+        packet_received_cb,
+        context);
+    lora_byte_log_reset(&context->history);
+    lora_refresh_limiter_init(&context->refresh, RX_REFRESH_FPS);
+    context->capture_start = furi_get_tick();
+    lora_rx_stats_reset(&context->stats, context->capture_start);
+    context->last_length = 0;
+    context->last_rssi = 0;
+    context->capture = NULL;
+    context->uart_claimed = false;
     context->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
 
-    if(!context->rx_stream || !context->mutex) {
+    if(!context->mutex) {
         FURI_LOG_E("LoRaTester", "Failed to allocate receive context resources");
         cleanup_receive_context(app);
         return false;
@@ -112,9 +151,11 @@ static void cleanup_receive_context(LoraTesterApp* app) {
     FURI_LOG_D("LoRaTester", "Cleaning up receive context");
     if(app->receive_context) {
         ReceiveContext* context = app->receive_context;
-        if(context->rx_stream) {
-            furi_stream_buffer_free(context->rx_stream);
-            context->rx_stream = NULL;
+        // The view reads the history at draw time, detach it first
+        lora_hex_view_set_source(app->hex_view, NULL, NULL);
+        if(context->capture) {
+            lora_capture_free(context->capture);
+            context->capture = NULL;
         }
         if(context->mutex) {
             furi_mutex_free(context->mutex);
@@ -125,72 +166,123 @@ static void cleanup_receive_context(LoraTesterApp* app) {
     }
 }
 
-static void cleanup_uart() {
+static void cleanup_uart(LoraTesterApp* app) {
     FURI_LOG_D("LoRaTester", "Cleaning up UART");
-    if(serial_handle) {
-        furi_hal_serial_async_rx_stop(serial_handle);
-        furi_hal_serial_deinit(serial_handle);
-        furi_hal_serial_control_release(serial_handle);
-        serial_handle = NULL;
+    if(app->receive_context && app->receive_context->uart_claimed) {
+        lora_tester_uart_release(app->uart);
+        app->receive_context->uart_claimed = false;
+    }
+}
+
+static void format_stats_panel(LoraTesterApp* app, uint32_t now) {
+    ReceiveContext* receive_context = app->receive_context;
+    LoraRxStatsSummary summary[LoraRxStatsWindowCount];
+    char panel[LORA_RX_STATS_PANEL_SIZE];
+
+    furi_mutex_acquire(receive_context->mutex, FuriWaitForever);
+    for(size_t window = 0; window < LoraRxStatsWindowCount; window++) {
+        lora_rx_stats_get(&receive_context->stats, window, now, &summary[window]);
     }
+    furi_mutex_release(receive_context->mutex);
+
+    lora_rx_stats_format_panel(summary, panel, sizeof(panel));
+    lora_hex_view_set_panel(app->hex_view, panel);
 }
 
-static void reset_text_box(LoraTesterApp* app) {
-    FURI_LOG_D("LoRaTester", "Resetting text box");
-    furi_assert(app);
-    furi_assert(app->text_box);
-    furi_assert(app->text_box_store);
+static void refresh_view(LoraTesterApp* app) {
+    ReceiveContext* receive_context = app->receive_context;
+    lora_refresh_limiter_begin_draw(&receive_context->refresh, furi_get_tick());
+
+    // Bytes per worker wakeup in tenths, the number batching in the ISR is meant to raise
+    LoraRxPath* rx = &receive_context->rx;
+    uint32_t per_wakeup = rx->wakeups ? (uint64_t)rx->bytes * 10 / rx->wakeups : 0;
+
+    // Only the status line is built here, the view formats the visible rows itself
+    char header[32];
+    if(receive_context->capture) {
+        LoraCaptureStats stats;
+        lora_capture_get_stats(receive_context->capture, &stats);
+        uint32_t throughput = stats.write_ms ? stats.bytes_written / stats.write_ms : 0;
+        snprintf(
+            header,
+            sizeof(header),
+            "REC %lu D%lu %luKB/s %lu.%lu/w",
+            stats.records,
+            stats.dropped,
+            throughput,
+            per_wakeup / 10,
+            per_wakeup % 10);
+    } else {
+        furi_mutex_acquire(receive_context->mutex, FuriWaitForever);
+        uint32_t packets = receive_context->rx.framer.packets;
+        uint32_t length = receive_context->last_length;
+        int16_t rssi = receive_context->last_rssi;
+        furi_mutex_release(receive_context->mutex);
+
+        size_t used;
+        if(packets == 0) {
+            used = snprintf(header, sizeof(header), "Waiting...");
+        } else if(rssi) {
+            used = snprintf(header, sizeof(header), "#%lu %luB %ddBm", packets, length, rssi);
+        } else {
+            used = snprintf(header, sizeof(header), "#%lu %luB", packets, length);
+        }
+        if(rx->wakeups && used < sizeof(header)) {
+            snprintf(
+                header + used,
+                sizeof(header) - used,
+                " %lu.%lu/w D%lu",
+                per_wakeup / 10,
+                per_wakeup % 10,
+                rx->ring.dropped);
+        }
+    }
 
-    text_box_reset(app->text_box);
-    furi_string_reset(app->text_box_store);
-    furi_string_printf(app->text_box_store, "Waiting for data...\n");
-    text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
+    format_stats_panel(app, furi_get_tick());
+    lora_hex_view_set_header(app->hex_view, header);
 }
 
 void lora_tester_scene_receive_on_enter(void* context) {
     FURI_LOG_I("LoRaTester", "Entering receive scene");
     LoraTesterApp* app = context;
 
-    reset_text_box(app);
-
     if(!init_receive_context(app)) {
         FURI_LOG_E("LoRaTester", "Failed to initialize receive context");
         return;
     }
 
-    const uint8_t max_retries = 5;
-    for(uint8_t retry = 0; retry < max_retries; retry++) {
-        FURI_LOG_D("LoRaTester", "Attempting to acquire serial handle (attempt %d)", retry + 1);
-        serial_handle = furi_hal_serial_control_acquire(UART_CH);
-        if(serial_handle) {
-            FURI_LOG_D("LoRaTester", "Successfully acquired serial handle");
-            break;
-        }
-        FURI_LOG_W("LoRaTester", "Failed to acquire serial handle, retrying...");
-        furi_delay_ms(100);
-    }
-
-    if(!serial_handle) {
-        FURI_LOG_E("LoRaTester", "Failed to acquire serial handle after %d attempts", max_retries);
-        cleanup_receive_context(app);
-        return;
-    }
+    lora_hex_view_set_source(
+        app->hex_view, &app->receive_context->history, app->receive_context->mutex);
+    lora_hex_view_set_header(app->hex_view, "Waiting for data...");
 
     uint32_t current_baud_rate = get_current_baud_rate(app);
-    FURI_LOG_D("LoRaTester", "Initializing UART with baud rate: %lu", current_baud_rate);
-    furi_hal_serial_init(serial_handle, current_baud_rate);
-    furi_hal_serial_async_rx_start(serial_handle, uart_on_irq_cb, app, true);
+
+    if(scene_manager_get_scene_state(app->scene_manager, LoraTesterSceneReceive) ==
+       LoraTesterReceiveModeCapture) {
+        app->receive_context->capture = lora_capture_alloc(app->storage, current_baud_rate);
+        if(!app->receive_context->capture) {
+            lora_hex_view_set_header(app->hex_view, "SD capture failed");
+        }
+    }
 
     if(app->worker_thread) {
         FURI_LOG_D("LoRaTester", "Freeing existing worker thread");
         furi_thread_free(app->worker_thread);
     }
     FURI_LOG_D("LoRaTester", "Creating new worker thread");
-    app->worker_thread = furi_thread_alloc_ex("LoRaReceiverWorker", 1024, uart_worker, app);
+    app->worker_thread = furi_thread_alloc_ex("LoRaReceiverWorker", 2048, uart_worker, app);
     furi_thread_start(app->worker_thread);
 
-    FURI_LOG_D("LoRaTester", "Switching to text box view");
-    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewTextBox);
+    // The ISRs signal the worker thread, so it must exist before RX is routed here
+    lora_aux_set_callback(app->aux, aux_edge_cb, app);
+    app->receive_context->uart_claimed = lora_tester_uart_claim(
+        app->uart, current_baud_rate, uart_on_rx_cb, app, LORA_TESTER_UART_CLAIM_TIMEOUT_MS);
+    if(!app->receive_context->uart_claimed) {
+        lora_hex_view_set_header(app->hex_view, "Serial port busy");
+    }
+
+    FURI_LOG_D("LoRaTester", "Switching to hex view");
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewHexView);
     FURI_LOG_I(
         "LoRaTester", "Receive scene setup complete with baud rate: %lu", current_baud_rate);
 }
@@ -202,15 +294,24 @@ bool lora_tester_scene_receive_on_event(void* context, SceneManagerEvent event)
     if(event.type == SceneManagerEventTypeCustom) {
         if(event.event == LoraTesterCustomEventRefreshView) {
             if(app->receive_context && app->receive_context->mutex) {
-                furi_mutex_acquire(app->receive_context->mutex, FuriWaitForever);
-                text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
-                furi_mutex_release(app->receive_context->mutex);
+                refresh_view(app);
                 consumed = true;
             }
         }
+    } else if(event.type == SceneManagerEventTypeTick) {
+        if(app->receive_context && app->receive_context->mutex) {
+            ReceiveContext* receive_context = app->receive_context;
+            uint32_t now = furi_get_tick();
+            // Rates and capture counters keep moving without new packets to show
+            bool stats_stale = now - receive_context->refresh.last_draw >= RX_STATS_INTERVAL_MS;
+            if(stats_stale || lora_refresh_limiter_due(&receive_context->refresh, now)) {
+                refresh_view(app);
+            }
+        }
     } else if(event.type == SceneManagerEventTypeBack) {
         FURI_LOG_D("LoRaTester", "Back button pressed in receive scene");
-        cleanup_uart();
+        lora_aux_set_callback(app->aux, NULL, NULL);
+        cleanup_uart(app);
         if(app->worker_thread) {
             FURI_LOG_D("LoRaTester", "Stopping worker thread");
             furi_thread_flags_set(furi_thread_get_id(app->worker_thread), WorkerEventStop);
@@ -219,7 +320,6 @@ bool lora_tester_scene_receive_on_event(void* context, SceneManagerEvent event)
             app->worker_thread = NULL;
         }
         cleanup_receive_context(app);
-        reset_text_box(app);
         consumed = false;
     }
 
@@ -230,7 +330,8 @@ void lora_tester_scene_receive_on_exit(void* context) {
     FURI_LOG_I("LoRaTester", "Exiting receive scene");
     LoraTesterApp* app = context;
 
-    cleanup_uart();
+    lora_aux_set_callback(app->aux, NULL, NULL);
+    cleanup_uart(app);
     if(app->worker_thread) {
         FURI_LOG_D("LoRaTester", "Stopping worker thread");
         furi_thread_flags_set(furi_thread_get_id(app->worker_thread), WorkerEventStop);
@@ -239,7 +340,6 @@ void lora_tester_scene_receive_on_exit(void* context) {
         app->worker_thread = NULL;
     }
     cleanup_receive_context(app);
-    reset_text_box(app);
 
     FURI_LOG_I("LoRaTester", "Receive scene cleanup complete");
 }
@@ -0,0 +1,258 @@
+#include "../lora_tester_app_i.h"
+#include <furi_hal.h>
+
+/** How long the module gets to answer a query before it counts as lost */
+#define RSSI_REPLY_TIMEOUT_MS 200
+#define RSSI_DEFAULT_PERIOD_INDEX 1
+
+static const uint32_t rssi_periods_ms[] = {100, 200, 500, 1000, 2000};
+
+static void rssi_uart_rx_cb(const uint8_t* data, size_t length, bool idle, void* context) {
+    LoraTesterApp* app = context;
+    RssiContext* rssi_context = app->rssi_context;
+    UNUSED(idle);
+
+    for(size_t i = 0; i < length; i++) {
+        if(!rssi_context->reply_pending) {
+            rssi_context->data_bytes++;
+            continue;
+        }
+        // Received packets can arrive around the reply, only C1 00 02 <a> <b> is taken
+        switch(lora_rssi_parser_feed(&rssi_context->parser, data[i])) {
+        case LoraRssiParserData:
+            rssi_context->data_bytes++;
+            break;
+        case LoraRssiParserReply:
+            memcpy(rssi_context->reply, rssi_context->parser.values, sizeof(rssi_context->reply));
+            rssi_context->reply_pending = false;
+            furi_thread_flags_set(furi_thread_get_id(rssi_context->thread), WorkerEventRx);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void rssi_aux_cb(bool level, void* context) {
+    LoraTesterApp* app = context;
+    RssiContext* rssi_context = app->rssi_context;
+    if(level && rssi_context && rssi_context->thread) {
+        furi_thread_flags_set(furi_thread_get_id(rssi_context->thread), WorkerEventAux);
+    }
+}
+
+/** Wait for the stop flag for up to timeout_ms
+ *
+ * @return     false if the worker was asked to stop
+ */
+static bool rssi_sleep(uint32_t timeout_ms) {
+    uint32_t events = furi_thread_flags_wait(WorkerEventStop, FuriFlagWaitAny, timeout_ms);
+    return events == (uint32_t)FuriFlagErrorTimeout;
+}
+
+static int32_t rssi_worker(void* context) {
+    LoraTesterApp* app = context;
+    RssiContext* rssi_context = app->rssi_context;
+    const uint8_t command[LORA_RSSI_COMMAND_SIZE] = LORA_RSSI_COMMAND;
+
+    while(true) {
+        uint32_t start = furi_get_tick();
+        uint32_t period = rssi_periods_ms[rssi_context->period_index];
+
+        // Only query while the module is idle, so the reply never queues behind a packet
+        if(!lora_aux_read(app->aux)) {
+            furi_thread_flags_clear(WorkerEventAux);
+            uint32_t events =
+                furi_thread_flags_wait(WorkerEventStop | WorkerEventAux, FuriFlagWaitAny, period);
+            if(events != (uint32_t)FuriFlagErrorTimeout && (events & WorkerEventStop)) {
+                break;
+            }
+            continue;
+        }
+
+        furi_thread_flags_clear(WorkerEventRx);
+        lora_rssi_parser_reset(&rssi_context->parser);
+        rssi_context->reply_pending = true;
+        lora_tester_uart_tx(app->uart, command, sizeof(command));
+
+        uint32_t events = furi_thread_flags_wait(
+            WorkerEventStop | WorkerEventRx, FuriFlagWaitAny, RSSI_REPLY_TIMEOUT_MS);
+        if(events == (uint32_t)FuriFlagErrorTimeout) {
+            rssi_context->reply_pending = false;
+            rssi_context->timeouts++;
+        } else if(events & WorkerEventStop) {
+            break;
+        } else if(events & WorkerEventRx) {
+            furi_mutex_acquire(rssi_context->mutex, FuriWaitForever);
+            lora_rssi_history_push(&rssi_context->history, lora_rssi_dbm(rssi_context->reply[0]));
+            furi_mutex_release(rssi_context->mutex);
+            rssi_context->last_packet_dbm =
+                rssi_context->reply[1] ? lora_rssi_dbm(rssi_context->reply[1]) : 0;
+        }
+        rssi_context->polls++;
+        view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventRssiUpdate);
+
+        uint32_t elapsed = furi_get_tick() - start;
+        if(elapsed < period && !rssi_sleep(period - elapsed)) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static void rssi_refresh_view(LoraTesterApp* app) {
+    RssiContext* rssi_context = app->rssi_context;
+    char header[32];
+
+    if(rssi_context->switching) {
+        snprintf(header, sizeof(header), "%s", lora_tester_op_get_text(app));
+    } else if(!rssi_context->uart_claimed) {
+        snprintf(header, sizeof(header), "Serial port busy");
+    } else if(rssi_context->mode_failed) {
+        snprintf(header, sizeof(header), "Module not ready");
+    } else if(rssi_context->ambient_disabled) {
+        snprintf(header, sizeof(header), "Enable RSSI Ambient");
+    } else if(rssi_context->polls && rssi_context->timeouts == rssi_context->polls) {
+        snprintf(
+            header,
+            sizeof(header),
+            "No reply, %lums",
+            rssi_periods_ms[rssi_context->period_index]);
+    } else if(rssi_context->last_packet_dbm) {
+        snprintf(
+            header,
+            sizeof(header),
+            "Pkt %ddBm %lums",
+            rssi_context->last_packet_dbm,
+            rssi_periods_ms[rssi_context->period_index]);
+    } else {
+        snprintf(
+            header, sizeof(header), "Pkt -- %lums", rssi_periods_ms[rssi_context->period_index]);
+    }
+    lora_rssi_view_set_header(app->rssi_view, header);
+}
+
+static void rssi_step_callback(int8_t step, void* context) {
+    LoraTesterApp* app = context;
+    RssiContext* rssi_context = app->rssi_context;
+
+    int8_t index = rssi_context->period_index + step;
+    if(index >= 0 && index < (int8_t)COUNT_OF(rssi_periods_ms)) {
+        rssi_context->period_index = index;
+        rssi_refresh_view(app);
+    }
+}
+
+static void rssi_cleanup(LoraTesterApp* app) {
+    RssiContext* rssi_context = app->rssi_context;
+    if(!rssi_context) {
+        return;
+    }
+
+    lora_aux_set_callback(app->aux, NULL, NULL);
+    if(rssi_context->thread) {
+        // Every wait in the worker wakes on the stop flag, this doesn't wait on the module
+        furi_thread_flags_set(furi_thread_get_id(rssi_context->thread), WorkerEventStop);
+        furi_thread_join(rssi_context->thread);
+        furi_thread_free(rssi_context->thread);
+    }
+    if(rssi_context->uart_claimed) {
+        lora_tester_uart_release(app->uart);
+    }
+    lora_rssi_view_set_step_callback(app->rssi_view, NULL, NULL);
+    lora_rssi_view_set_source(app->rssi_view, NULL, NULL);
+    furi_mutex_free(rssi_context->mutex);
+    // Waits on AUX, so it runs on the op worker after the switch to normal mode
+    lora_tester_op_start_restore(app, rssi_context->original_mode, NULL, NULL, NULL);
+
+    free(rssi_context);
+    app->rssi_context = NULL;
+}
+
+static void rssi_begin(LoraTesterApp* app, bool ready) {
+    RssiContext* rssi_context = app->rssi_context;
+
+    rssi_context->switching = false;
+    rssi_context->mode_failed = !ready;
+    rssi_context->thread = furi_thread_alloc_ex("LoRaRssiWorker", 1024, rssi_worker, app);
+    rssi_context->uart_claimed = lora_tester_uart_claim(
+        app->uart, app->baud_rate, rssi_uart_rx_cb, app, LORA_TESTER_UART_CLAIM_TIMEOUT_MS);
+    if(rssi_context->uart_claimed) {
+        lora_aux_set_callback(app->aux, rssi_aux_cb, app);
+        furi_thread_start(rssi_context->thread);
+    } else {
+        furi_thread_free(rssi_context->thread);
+        rssi_context->thread = NULL;
+    }
+
+    rssi_refresh_view(app);
+    lora_rssi_view_update(app->rssi_view);
+}
+
+void lora_tester_scene_rssi_on_enter(void* context) {
+    LoraTesterApp* app = context;
+
+    rssi_cleanup(app);
+    app->rssi_context = malloc(sizeof(RssiContext));
+    memset(app->rssi_context, 0, sizeof(RssiContext));
+    RssiContext* rssi_context = app->rssi_context;
+    rssi_context->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    rssi_context->period_index = RSSI_DEFAULT_PERIOD_INDEX;
+    lora_rssi_history_reset(&rssi_context->history);
+
+    // Only a known-off setting is reported, an unread module may well have it on
+    LoRaConfig config;
+    if(lora_tester_current_config(app, &config)) {
+        rssi_context->ambient_disabled = !config.rssi_ambient_noise_flag;
+    }
+
+    // The RSSI registers are only served in normal mode, the worker starts once it is in
+    rssi_context->original_mode = app->current_mode;
+    rssi_context->switching = true;
+    lora_tester_op_start_mode(app, LoRaMode_Normal);
+
+    lora_rssi_view_set_source(app->rssi_view, &rssi_context->history, rssi_context->mutex);
+    lora_rssi_view_set_step_callback(app->rssi_view, rssi_step_callback, app);
+
+    rssi_refresh_view(app);
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewRssiView);
+}
+
+bool lora_tester_scene_rssi_on_event(void* context, SceneManagerEvent event) {
+    LoraTesterApp* app = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        if((event.event == LoraTesterCustomEventRssiUpdate ||
+            event.event == LoraTesterCustomEventOpProgress) &&
+           app->rssi_context) {
+            rssi_refresh_view(app);
+            lora_rssi_view_update(app->rssi_view);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpDone) {
+            if(lora_tester_op_take_result(app, LoraTesterOpMode)) {
+                rssi_begin(app, app->op.status == LoraModuleStatusOk);
+            }
+            consumed = true;
+        }
+    } else if(event.type == SceneManagerEventTypeBack) {
+        consumed = scene_manager_search_and_switch_to_previous_scene(
+            app->scene_manager, LoraTesterSceneStart);
+    }
+
+    return consumed;
+}
+
+void lora_tester_scene_rssi_on_exit(void* context) {
+    LoraTesterApp* app = context;
+
+    FURI_LOG_I(
+        "LoRaTester",
+        "RSSI meter: %lu polls, %lu timeouts, %lu data bytes",
+        app->rssi_context->polls,
+        app->rssi_context->timeouts,
+        app->rssi_context->data_bytes);
+    lora_tester_op_cancel(app);
+    rssi_cleanup(app);
+}
@@ -1,25 +1,231 @@
-// THIS FUCNTION IS NOT WORKING
-//STILL WIP NOW
-
 #include "../lora_tester_app_i.h"
-#include <furi_hal_serial.h>
 #include <furi_hal.h>
-#include <furi_hal_light.h>
 
-#define UART_BAUD_RATE (9600)
+#define SEND_QUEUE_DEPTH 4
+#define SEND_AUX_TIMEOUT_MS 2000
+
+/** Write a frame and wait for the module to transmit it, so back-to-back frames stay
+ * separate packets
+ *
+ * @return     false if AUX stayed low
+ */
+static bool send_frame(LoraTesterApp* app, const uint8_t* frame, size_t length) {
+    // Edges from the previous frame must not satisfy the wait for this one
+    furi_thread_flags_clear(WorkerEventAux | WorkerEventAuxLow);
+    lora_tester_uart_tx(app->uart, frame, length);
+
+    LoraTesterTxWait wait = lora_tester_wait_tx(app, SEND_AUX_TIMEOUT_MS);
+    if(wait == LoraTesterTxTimeout) {
+        FURI_LOG_W("LoRaTester", "AUX stayed low for %dms", SEND_AUX_TIMEOUT_MS);
+    }
+    return wait == LoraTesterTxSent;
+}
+
+static int32_t send_worker(void* context) {
+    LoraTesterApp* app = context;
+    SendContext* send_context = app->send_context;
+    SendMessage message;
+
+    while(furi_message_queue_get(send_context->queue, &message, FuriWaitForever) == FuriStatusOk) {
+        // An empty message is the stop request
+        if(message.length == 0) {
+            break;
+        }
+
+        uint32_t start = furi_get_tick();
+        bool sent = true;
+        if(send_context->fixed) {
+            // Same payload to every target, only the header in front of it changes
+            for(size_t i = 0; i < send_context->targets.count && sent; i++) {
+                const LoraAddressEntry* target = &send_context->targets.entries[i];
+                lora_fixed_header_write(message.frame, target);
+                sent = send_frame(app, message.frame, LORA_FIXED_HEADER_SIZE + message.length);
+                FURI_LOG_D(
+                    "LoRaTester",
+                    "Sent to %s 0x%04X ch%u",
+                    target->name,
+                    target->address,
+                    target->channel);
+            }
+        } else {
+            sent = send_frame(app, SEND_MESSAGE_PAYLOAD(&message), message.length);
+        }
+        uint32_t done = furi_get_tick();
+
+        send_context->last_failed = !sent;
+        if(!sent) {
+            send_context->failed++;
+        }
+
+        uint32_t latency = done - message.keypress_tick;
+        send_context->last_wire_ms = done - start;
+        send_context->last_latency_ms = latency;
+        if(latency > send_context->max_latency_ms) {
+            send_context->max_latency_ms = latency;
+        }
+        __atomic_add_fetch(&send_context->sent, 1, __ATOMIC_RELEASE);
+
+        FURI_LOG_I(
+            "LoRaTester",
+            "%s %u bytes: %lums from keypress, %lums on the wire",
+            sent ? "Sent" : "Failed to send",
+            message.length,
+            latency,
+            send_context->last_wire_ms);
+        if(!send_context->stopping) {
+            view_dispatcher_send_custom_event(
+                app->view_dispatcher, LoraTesterCustomEventSendDone);
+        }
+    }
+
+    // Edges must not reach this thread once it is gone
+    lora_aux_set_callback(app->aux, NULL, NULL);
+    return 0;
+}
 
 static void lora_tester_scene_send_text_input_callback(void* context) {
     LoraTesterApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventTextInputDone);
+    SendContext* send_context = app->send_context;
+    SendMessage message;
+
+    // Runs with the text input model locked: take a copy for the worker and
+    // leave the header update to the custom event
+    message.keypress_tick = furi_get_tick();
+    message.length = strlen(app->text_input_store);
+    memcpy(SEND_MESSAGE_PAYLOAD(&message), app->text_input_store, message.length);
+
+    if(furi_message_queue_put(send_context->queue, &message, 0) == FuriStatusOk) {
+        send_context->queued++;
+        send_context->last_rejected = false;
+    } else {
+        send_context->rejected++;
+        send_context->last_rejected = true;
+    }
+    view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventSendDone);
+}
+
+static void send_update_status(LoraTesterApp* app) {
+    SendContext* send_context = app->send_context;
+    uint32_t sent = __atomic_load_n(&send_context->sent, __ATOMIC_ACQUIRE);
+
+    if(send_context->last_rejected) {
+        snprintf(
+            send_context->status,
+            sizeof(send_context->status),
+            "Busy, %lu dropped",
+            send_context->rejected);
+    } else if(sent < send_context->queued) {
+        snprintf(
+            send_context->status,
+            sizeof(send_context->status),
+            "Sending %lu...",
+            send_context->queued - sent);
+    } else if(send_context->last_failed) {
+        snprintf(
+            send_context->status,
+            sizeof(send_context->status),
+            "AUX timeout, %lu failed",
+            send_context->failed);
+    } else {
+        snprintf(
+            send_context->status,
+            sizeof(send_context->status),
+            "#%lu %lums max %lums",
+            sent,
+            send_context->last_latency_ms,
+            send_context->max_latency_ms);
+    }
+    uart_text_input_set_header_text(app->text_input, send_context->status);
+}
+
+static bool send_open_session(LoraTesterApp* app) {
+    SendContext* send_context = app->send_context;
+
+    // Nothing is expected back, received bytes are dropped
+    send_context->uart_claimed = lora_tester_uart_claim(
+        app->uart, app->baud_rate, NULL, NULL, LORA_TESTER_UART_CLAIM_TIMEOUT_MS);
+    if(!send_context->uart_claimed) {
+        return false;
+    }
+    FURI_LOG_I("LoRaTester", "Send session open at %lu baud", app->baud_rate);
+    return true;
+}
+
+static void send_cleanup(LoraTesterApp* app) {
+    SendContext* send_context = app->send_context;
+    if(!send_context) {
+        return;
+    }
+
+    if(send_context->thread) {
+        SendMessage stop = {.length = 0};
+        send_context->stopping = true;
+        furi_message_queue_put(send_context->queue, &stop, FuriWaitForever);
+        furi_thread_join(send_context->thread);
+        furi_thread_free(send_context->thread);
+    }
+    if(send_context->uart_claimed) {
+        lora_tester_uart_release(app->uart);
+    }
+    if(send_context->queue) {
+        furi_message_queue_free(send_context->queue);
+    }
+
+    FURI_LOG_I(
+        "LoRaTester",
+        "Send: %lu sent, %lu failed, %lu rejected, max latency %lums",
+        send_context->sent,
+        send_context->failed,
+        send_context->rejected,
+        send_context->max_latency_ms);
+
+    free(send_context);
+    app->send_context = NULL;
 }
 
 void lora_tester_scene_send_on_enter(void* context) {
     LoraTesterApp* app = context;
 
-    uart_text_input_set_header_text(app->text_input, "Enter message to send");
+    send_cleanup(app);
+    app->send_context = malloc(sizeof(SendContext));
+    memset(app->send_context, 0, sizeof(SendContext));
+    SendContext* send_context = app->send_context;
+    snprintf(send_context->status, sizeof(send_context->status), "Enter message to send");
+
+    if(scene_manager_get_scene_state(app->scene_manager, LoraTesterSceneSend) ==
+       LoraTesterSendModeFixed) {
+        send_context->fixed = true;
+        send_context->targets = app->send_targets;
+        LoRaConfig config;
+        if(!lora_tester_current_config(app, &config)) {
+            // Only known once the module has been read
+            snprintf(send_context->status, sizeof(send_context->status), "Tx Method not Fixed?");
+        } else if(!config.transmission_method_type) {
+            snprintf(send_context->status, sizeof(send_context->status), "Tx Method not Fixed");
+        } else {
+            snprintf(
+                send_context->status,
+                sizeof(send_context->status),
+                "Message to %u targets",
+                send_context->targets.count);
+        }
+    }
+
+    // One session for the lifetime of the scene, not one per message
+    if(send_open_session(app)) {
+        send_context->queue = furi_message_queue_alloc(SEND_QUEUE_DEPTH, sizeof(SendMessage));
+        send_context->thread = furi_thread_alloc_ex("LoRaSendWorker", 1024, send_worker, app);
+        furi_thread_start(send_context->thread);
+        lora_aux_set_callback(
+            app->aux, lora_tester_aux_worker_cb, furi_thread_get_id(send_context->thread));
+    } else {
+        snprintf(send_context->status, sizeof(send_context->status), "Serial port busy");
+    }
+
+    uart_text_input_set_header_text(app->text_input, send_context->status);
     uart_text_input_set_result_callback(
         app->text_input,
-        lora_tester_scene_send_text_input_callback,
+        send_context->thread ? lora_tester_scene_send_text_input_callback : NULL,
         app,
         app->text_input_store,
         TEXT_INPUT_STORE_SIZE,
@@ -33,33 +239,16 @@ bool lora_tester_scene_send_on_event(void* context, SceneManagerEvent event) {
     bool consumed = false;
 
     if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == LoraTesterCustomEventTextInputDone) {
-            FuriHalSerialHandle* serial_handle =
-                furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
-            if(serial_handle != NULL) {
-                furi_hal_serial_init(serial_handle, UART_BAUD_RATE);
-                furi_hal_serial_enable_direction(
-                    serial_handle, FuriHalSerialDirectionRx | FuriHalSerialDirectionTx);
-
-                furi_hal_serial_tx(
-                    serial_handle, (uint8_t*)app->text_input_store, strlen(app->text_input_store));
-
-                furi_hal_serial_tx_wait_complete(serial_handle);
-
-                FURI_LOG_I("LoRaTester", "Sent: %s", app->text_input_store);
-
-                furi_hal_serial_deinit(serial_handle);
-                furi_hal_serial_control_release(serial_handle);
-            } else {
-                FURI_LOG_E("LoRaTester", "Failed to acquire serial handle");
-            }
-
-            scene_manager_previous_scene(app->scene_manager);
+        if(event.event == LoraTesterCustomEventSendDone && app->send_context) {
+            send_update_status(app);
             consumed = true;
         }
     } else if(event.type == SceneManagerEventTypeBack) {
-        consumed = scene_manager_search_and_switch_to_previous_scene(
-            app->scene_manager, LoraTesterSceneStart);
+        // Fixed mode goes back to the target list to pick another batch
+        if(!app->send_context || !app->send_context->fixed) {
+            consumed = scene_manager_search_and_switch_to_previous_scene(
+                app->scene_manager, LoraTesterSceneStart);
+        }
     }
 
     return consumed;
@@ -67,5 +256,8 @@ bool lora_tester_scene_send_on_event(void* context, SceneManagerEvent event) {
 
 void lora_tester_scene_send_on_exit(void* context) {
     LoraTesterApp* app = context;
-    UNUSED(app);
+
+    // The header points into the context about to be freed
+    uart_text_input_set_header_text(app->text_input, "");
+    send_cleanup(app);
 }
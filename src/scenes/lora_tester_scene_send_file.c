@@ -0,0 +1,245 @@
+#include "../lora_tester_app_i.h"
+#include <furi_hal.h>
+#include <dialogs/dialogs.h>
+#include <toolbox/path.h>
+#include "lora_tester_icons.h"
+
+#define FILE_SEND_DIRECTORY "/ext/LoRa_Setting"
+#define FILE_SEND_MAX_CHUNK 200
+#define FILE_SEND_REFRESH_MS 250
+/** How long AUX may stay low before the chunk is given up on */
+#define FILE_SEND_AUX_TIMEOUT_MS 5000
+
+static int32_t file_send_worker(void* context) {
+    LoraTesterApp* app = context;
+    FileSendContext* file_send_context = app->file_send_context;
+    File* file = storage_file_alloc(app->storage);
+    uint8_t chunk[FILE_SEND_MAX_CHUNK];
+    uint32_t last_refresh = 0;
+    bool stopped = false;
+
+    if(!storage_file_open(
+           file, furi_string_get_cstr(file_send_context->path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(
+            "LoRaTester", "Failed to open %s", furi_string_get_cstr(file_send_context->path));
+        file_send_context->failed = true;
+    } else {
+        file_send_context->file_size = storage_file_size(file);
+        uint32_t start = furi_get_tick();
+        bool running = true;
+
+        while(running) {
+            size_t length = storage_file_read(file, chunk, file_send_context->chunk_size);
+            if(length == 0) {
+                break;
+            }
+
+            // Edges from the previous chunk must not satisfy the wait for this one
+            furi_thread_flags_clear(WorkerEventAux | WorkerEventAuxLow);
+            lora_tester_uart_tx(app->uart, chunk, length);
+
+            uint32_t stall_start = furi_get_tick();
+            LoraTesterTxWait wait = lora_tester_wait_tx(app, FILE_SEND_AUX_TIMEOUT_MS);
+            uint32_t now = furi_get_tick();
+
+            running = wait != LoraTesterTxStopped;
+            if(wait == LoraTesterTxTimeout) {
+                file_send_context->aux_timeouts++;
+            }
+
+            file_send_context->stall_ms += now - stall_start;
+            file_send_context->bytes_sent += length;
+            file_send_context->chunks++;
+            file_send_context->elapsed_ms = now - start;
+
+            if(running && now - last_refresh >= FILE_SEND_REFRESH_MS) {
+                last_refresh = now;
+                view_dispatcher_send_custom_event(
+                    app->view_dispatcher, LoraTesterCustomEventFileSendUpdate);
+            }
+        }
+        storage_file_close(file);
+        stopped = !running;
+
+        FURI_LOG_I(
+            "LoRaTester",
+            "File send: %lu/%lu bytes in %lu chunks, %lums, %lums on AUX, %lu AUX timeouts",
+            file_send_context->bytes_sent,
+            file_send_context->file_size,
+            file_send_context->chunks,
+            file_send_context->elapsed_ms,
+            file_send_context->stall_ms,
+            file_send_context->aux_timeouts);
+    }
+
+    storage_file_free(file);
+    file_send_context->done = true;
+    // Edges must not reach this thread once it is gone, whether or not it was stopped
+    lora_aux_set_callback(app->aux, NULL, NULL);
+    // After a stop the scene is on its way out and has nothing left to show, a stop
+    // that came in outside the AUX wait is still pending in the flags
+    if(!stopped && !(furi_thread_flags_get() & WorkerEventStop)) {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, LoraTesterCustomEventFileSendUpdate);
+    }
+    return 0;
+}
+
+static void file_send_refresh_view(LoraTesterApp* app) {
+    FileSendContext* file_send_context = app->file_send_context;
+    FuriString* filename = furi_string_alloc();
+    path_extract_filename(file_send_context->path, filename, false);
+
+    furi_string_printf(app->text_box_store, "%s\n", furi_string_get_cstr(filename));
+    if(file_send_context->failed) {
+        furi_string_cat_printf(app->text_box_store, "Failed to open file\n");
+    } else {
+        uint32_t elapsed = file_send_context->elapsed_ms ? file_send_context->elapsed_ms : 1;
+        uint32_t chunks_per_10s = (uint64_t)file_send_context->chunks * 10000 / elapsed;
+        furi_string_cat_printf(
+            app->text_box_store,
+            "%lu/%lu B, %u B chunks\n"
+            "Goodput: %lu B/s\n"
+            "Chunks: %lu.%lu/s\n"
+            "AUX stall: %lums (%lu%%)\n",
+            file_send_context->bytes_sent,
+            file_send_context->file_size,
+            file_send_context->chunk_size,
+            (uint32_t)((uint64_t)file_send_context->bytes_sent * 1000 / elapsed),
+            chunks_per_10s / 10,
+            chunks_per_10s % 10,
+            file_send_context->stall_ms,
+            file_send_context->stall_ms * 100 / elapsed);
+        if(file_send_context->aux_timeouts) {
+            furi_string_cat_printf(
+                app->text_box_store, "AUX timeouts: %lu\n", file_send_context->aux_timeouts);
+        }
+        if(file_send_context->done) {
+            furi_string_cat_printf(app->text_box_store, "Done\n");
+        }
+    }
+    text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
+
+    furi_string_free(filename);
+}
+
+static void file_send_cleanup(LoraTesterApp* app) {
+    FileSendContext* file_send_context = app->file_send_context;
+    if(!file_send_context) {
+        return;
+    }
+
+    if(file_send_context->thread) {
+        furi_thread_flags_set(furi_thread_get_id(file_send_context->thread), WorkerEventStop);
+        furi_thread_join(file_send_context->thread);
+        furi_thread_free(file_send_context->thread);
+    }
+    if(file_send_context->uart_claimed) {
+        lora_tester_uart_release(app->uart);
+    }
+    furi_string_free(file_send_context->path);
+    free(file_send_context);
+    app->file_send_context = NULL;
+}
+
+/** Start sending once the module's sub-packet size is known */
+static void
+    file_send_begin(LoraTesterApp* app, LoraModuleStatus status, const uint8_t* registers) {
+    FileSendContext* file_send_context = app->file_send_context;
+
+    text_box_reset(app->text_box);
+    if(status != LoraModuleStatusOk) {
+        furi_string_printf(
+            app->text_box_store, "LoRa module: %s\n", lora_module_status_name(status));
+        text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewTextBox);
+        return;
+    }
+
+    // One chunk per sub-packet, so the module never has to split or merge them
+    LoRaConfig config;
+    lora_config_decode(registers, &config);
+    file_send_context->chunk_size = config.subpacket_size <= FILE_SEND_MAX_CHUNK ?
+                                        config.subpacket_size :
+                                        FILE_SEND_MAX_CHUNK;
+
+    file_send_context->uart_claimed = lora_tester_uart_claim(
+        app->uart, app->baud_rate, NULL, NULL, LORA_TESTER_UART_CLAIM_TIMEOUT_MS);
+    if(file_send_context->uart_claimed) {
+        file_send_context->thread =
+            furi_thread_alloc_ex("LoRaFileSendWorker", 1024, file_send_worker, app);
+        furi_thread_start(file_send_context->thread);
+        lora_aux_set_callback(
+            app->aux, lora_tester_aux_worker_cb, furi_thread_get_id(file_send_context->thread));
+        file_send_refresh_view(app);
+    } else {
+        furi_string_printf(app->text_box_store, "Serial port busy\n");
+        text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
+    }
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewTextBox);
+}
+
+void lora_tester_scene_send_file_on_enter(void* context) {
+    LoraTesterApp* app = context;
+
+    DialogsFileBrowserOptions browser_options;
+    dialog_file_browser_set_basic_options(&browser_options, "*", &I_lora_10px);
+    browser_options.base_path = FILE_SEND_DIRECTORY;
+
+    if(!dialog_file_browser_show(app->dialogs, app->file_path, app->file_path, &browser_options)) {
+        FURI_LOG_D("LoRaTester", "File selection cancelled");
+        scene_manager_search_and_switch_to_previous_scene(
+            app->scene_manager, LoraTesterSceneStart);
+        return;
+    }
+
+    file_send_cleanup(app);
+    app->file_send_context = malloc(sizeof(FileSendContext));
+    memset(app->file_send_context, 0, sizeof(FileSendContext));
+    app->file_send_context->path = furi_string_alloc_set(app->file_path);
+
+    // The chunk size comes from the module's registers
+    if(lora_tester_shadow_current(app)) {
+        uint8_t registers[LORA_CONFIG_REG_COUNT];
+        LoraModuleStatus status = lora_tester_read_registers(app, registers, false);
+        file_send_begin(app, status, registers);
+    } else {
+        lora_tester_op_start_read(app, false);
+        lora_tester_op_show_progress(app, "Reading Sub-packet");
+    }
+}
+
+bool lora_tester_scene_send_file_on_event(void* context, SceneManagerEvent event) {
+    LoraTesterApp* app = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        if(event.event == LoraTesterCustomEventFileSendUpdate && app->file_send_context) {
+            file_send_refresh_view(app);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpProgress) {
+            lora_tester_op_update_progress(app);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpDone) {
+            if(lora_tester_op_take_result(app, LoraTesterOpRead) && app->file_send_context) {
+                file_send_begin(app, app->op.status, app->op.registers);
+            }
+            consumed = true;
+        }
+    } else if(event.type == SceneManagerEventTypeBack) {
+        consumed = scene_manager_search_and_switch_to_previous_scene(
+            app->scene_manager, LoraTesterSceneStart);
+    }
+
+    return consumed;
+}
+
+void lora_tester_scene_send_file_on_exit(void* context) {
+    LoraTesterApp* app = context;
+
+    lora_tester_op_cancel(app);
+    file_send_cleanup(app);
+    text_box_reset(app->text_box);
+    furi_string_reset(app->text_box_store);
+}
@@ -0,0 +1,165 @@
+#include "../lora_tester_app_i.h"
+
+typedef enum {
+    SendTargetsEventSend = LORA_ADDRESS_BOOK_MAX_ENTRIES + 1,
+} SendTargetsEvent;
+
+static const char* send_target_values[] = {"Skip", "Send"};
+
+static void send_targets_entry_changed(VariableItem* item) {
+    LoraTesterApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+    uint8_t entry = variable_item_list_get_selected_item_index(app->var_item_list);
+
+    if(index) {
+        app->send_selection |= 1UL << entry;
+    } else {
+        app->send_selection &= ~(1UL << entry);
+    }
+    variable_item_set_current_value_text(item, send_target_values[index]);
+}
+
+static void send_targets_broadcast_changed(VariableItem* item) {
+    LoraTesterApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+    char value_str[8];
+
+    // Index 0 is off, the rest are channels 0..send_targets_max_channel
+    app->broadcast_channel = index;
+    if(index) {
+        snprintf(value_str, sizeof(value_str), "Ch %d", index - 1);
+        variable_item_set_current_value_text(item, value_str);
+    } else {
+        variable_item_set_current_value_text(item, "Off");
+    }
+}
+
+/** Highest channel of the module's bandwidth, the 125kHz range while it's unknown */
+static uint8_t send_targets_max_channel(LoraTesterApp* app) {
+    uint8_t max_channel = 0;
+    if(lora_tester_shadow_current(app)) {
+        max_channel =
+            lora_config_max_channel(LORA_CONFIG_BW_BITS(app->shadow.registers[LoraReg0]));
+    }
+    return max_channel ? max_channel : lora_config_max_channel(0);
+}
+
+static void send_targets_popup_callback(void* context) {
+    LoraTesterApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventPopupDone);
+}
+
+static void send_targets_show_empty(LoraTesterApp* app) {
+    popup_reset(app->popup);
+    popup_set_header(app->popup, "No targets", 64, 10, AlignCenter, AlignTop);
+    popup_set_text(
+        app->popup, "Pick an entry or a\nbroadcast channel", 64, 36, AlignCenter, AlignCenter);
+    popup_set_context(app->popup, app);
+    popup_set_callback(app->popup, send_targets_popup_callback);
+    popup_set_timeout(app->popup, 1500);
+    popup_enable_timeout(app->popup);
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewPopup);
+}
+
+static void send_targets_enter_callback(void* context, uint32_t index) {
+    LoraTesterApp* app = context;
+    if(index == app->address_book.count + 1) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, SendTargetsEventSend);
+    }
+}
+
+static void send_targets_collect(LoraTesterApp* app) {
+    SendTargets* targets = &app->send_targets;
+    targets->count = 0;
+
+    for(size_t i = 0; i < app->address_book.count; i++) {
+        if(app->send_selection & (1UL << i)) {
+            targets->entries[targets->count++] = app->address_book.entries[i];
+        }
+    }
+
+    if(app->broadcast_channel) {
+        LoraAddressEntry* broadcast = &targets->entries[targets->count++];
+        snprintf(broadcast->name, sizeof(broadcast->name), "Broadcast");
+        broadcast->address = LORA_ADDRESS_BROADCAST;
+        broadcast->channel = app->broadcast_channel - 1;
+    }
+}
+
+void lora_tester_scene_send_targets_on_enter(void* context) {
+    LoraTesterApp* app = context;
+    VariableItemList* var_item_list = app->var_item_list;
+    char label[LORA_ADDRESS_BOOK_NAME_SIZE + 12];
+
+    variable_item_list_reset(var_item_list);
+
+    if(!lora_address_book_load(&app->address_book, app->storage)) {
+        app->send_selection = 0;
+    }
+    // Selection bits of entries that no longer exist are meaningless
+    app->send_selection &= (1UL << app->address_book.count) - 1;
+
+    for(size_t i = 0; i < app->address_book.count; i++) {
+        const LoraAddressEntry* entry = &app->address_book.entries[i];
+        // Star our own address so it isn't picked by mistake
+        snprintf(
+            label,
+            sizeof(label),
+            "%s %04X/%u%s",
+            entry->name,
+            entry->address,
+            entry->channel,
+            entry->address == app->address ? "*" : "");
+        VariableItem* item = variable_item_list_add(
+            var_item_list, label, COUNT_OF(send_target_values), send_targets_entry_changed, app);
+        uint8_t selected = (app->send_selection >> i) & 1;
+        variable_item_set_current_value_index(item, selected);
+        variable_item_set_current_value_text(item, send_target_values[selected]);
+    }
+
+    uint8_t max_channel = send_targets_max_channel(app);
+    // A channel picked under a wider range may not exist at this bandwidth
+    if(app->broadcast_channel > max_channel + 1) {
+        app->broadcast_channel = 0;
+    }
+    VariableItem* item = variable_item_list_add(
+        var_item_list, "Broadcast", max_channel + 2, send_targets_broadcast_changed, app);
+    variable_item_set_current_value_index(item, app->broadcast_channel);
+    send_targets_broadcast_changed(item);
+
+    variable_item_list_add(var_item_list, "Write Message", 0, NULL, NULL);
+    variable_item_list_set_enter_callback(var_item_list, send_targets_enter_callback, app);
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+}
+
+bool lora_tester_scene_send_targets_on_event(void* context, SceneManagerEvent event) {
+    LoraTesterApp* app = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom && event.event == SendTargetsEventSend) {
+        send_targets_collect(app);
+        if(app->send_targets.count == 0) {
+            FURI_LOG_W("LoRaTester", "No send targets selected");
+            send_targets_show_empty(app);
+        } else {
+            scene_manager_set_scene_state(
+                app->scene_manager, LoraTesterSceneSend, LoraTesterSendModeFixed);
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneSend);
+        }
+        consumed = true;
+    } else if(
+        event.type == SceneManagerEventTypeCustom &&
+        event.event == LoraTesterCustomEventPopupDone) {
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void lora_tester_scene_send_targets_on_exit(void* context) {
+    LoraTesterApp* app = context;
+    popup_reset(app->popup);
+    variable_item_list_reset(app->var_item_list);
+}
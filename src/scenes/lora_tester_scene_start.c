@@ -9,7 +9,15 @@ typedef enum {
     LoraTesterItemExportConfig,
     LoraTesterItemLoadConfig,
     LoraTesterItemReceive,
+    LoraTesterItemCapture,
+    LoraTesterItemSend,
+    LoraTesterItemSendFixed,
+    LoraTesterItemSendFile,
     LoraTesterItemStats,
+    LoraTesterItemRefresh,
+    LoraTesterItemRssi,
+    LoraTesterItemSurvey,
+    LoraTesterItemBench,
     LoraTesterItemAbout,
     LoraTesterItemCount
 } LoraTesterItem;
@@ -21,12 +29,37 @@ static void lora_tester_scene_start_var_list_enter_callback(void* context, uint3
     view_dispatcher_send_custom_event(app->view_dispatcher, index);
 }
 
+static void lora_tester_scene_start_popup_callback(void* context) {
+    LoraTesterApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventPopupDone);
+}
+
+/** Tell the user the module didn't come back after a mode change, the popup
+ * timeout brings the menu back
+ */
+static void lora_tester_scene_start_show_mode_timeout(LoraTesterApp* app) {
+    app->mode_timeout = false;
+    popup_reset(app->popup);
+    popup_set_header(app->popup, "Module not ready", 64, 10, AlignCenter, AlignTop);
+    popup_set_text(
+        app->popup, "AUX stayed low after\nthe mode change", 64, 36, AlignCenter, AlignCenter);
+    popup_set_context(app->popup, app);
+    popup_set_callback(app->popup, lora_tester_scene_start_popup_callback);
+    popup_set_timeout(app->popup, 1500);
+    popup_enable_timeout(app->popup);
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewPopup);
+}
+
 static void lora_tester_scene_start_var_list_change_callback(VariableItem* item) {
     LoraTesterApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
 
     variable_item_set_current_value_text(item, lora_mode_names[index]);
-    lora_tester_set_mode(app, (LoRaMode)index);
+    bool ready = lora_tester_set_mode(app, (LoRaMode)index);
+    lora_tester_invalidate_registers(app);
+    if(!ready) {
+        lora_tester_scene_start_show_mode_timeout(app);
+    }
 }
 
 static void lora_tester_scene_start_baud_rate_change_callback(VariableItem* item) {
@@ -77,7 +110,15 @@ void lora_tester_scene_start_on_enter(void* context) {
         "Export Config",
         "Load Config",
         "Receive",
+        "Capture to SD",
+        "Send",
+        "Send Fixed",
+        "Send File",
         "Stats",
+        "Refresh from Module",
+        "RSSI Meter",
+        "Channel Survey",
+        "RX Benchmark",
         "About"};
     for(unsigned int i = 0; i < COUNT_OF(menu_items); i++) {
         variable_item_list_add(var_item_list, menu_items[i], 0, NULL, NULL);
@@ -89,7 +130,12 @@ void lora_tester_scene_start_on_enter(void* context) {
     variable_item_list_set_selected_item(
         var_item_list, scene_manager_get_scene_state(app->scene_manager, LoraTesterSceneStart));
 
-    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+    // A scene that timed out restoring the mode on its way out leaves it to the menu
+    if(app->mode_timeout) {
+        lora_tester_scene_start_show_mode_timeout(app);
+    } else {
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+    }
 }
 
 bool lora_tester_scene_start_on_event(void* context, SceneManagerEvent event) {
@@ -119,17 +165,70 @@ bool lora_tester_scene_start_on_event(void* context, SceneManagerEvent event) {
             consumed = true;
             break;
         case LoraTesterItemReceive:
+            scene_manager_set_scene_state(
+                app->scene_manager, LoraTesterSceneReceive, LoraTesterReceiveModeView);
             scene_manager_next_scene(app->scene_manager, LoraTesterSceneReceive);
             consumed = true;
             break;
+        case LoraTesterItemCapture:
+            scene_manager_set_scene_state(
+                app->scene_manager, LoraTesterSceneReceive, LoraTesterReceiveModeCapture);
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneReceive);
+            consumed = true;
+            break;
+        case LoraTesterItemSend:
+            scene_manager_set_scene_state(
+                app->scene_manager, LoraTesterSceneSend, LoraTesterSendModeTransparent);
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneSend);
+            consumed = true;
+            break;
+        case LoraTesterItemSendFixed:
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneSendTargets);
+            consumed = true;
+            break;
+        case LoraTesterItemSendFile:
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneSendFile);
+            consumed = true;
+            break;
         case LoraTesterItemStats:
+            scene_manager_set_scene_state(
+                app->scene_manager, LoraTesterSceneStat, LoraTesterStatModeCached);
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneStat);
+            consumed = true;
+            break;
+        case LoraTesterItemRefresh:
+            scene_manager_set_scene_state(
+                app->scene_manager, LoraTesterSceneStat, LoraTesterStatModeRefresh);
             scene_manager_next_scene(app->scene_manager, LoraTesterSceneStat);
             consumed = true;
             break;
+        case LoraTesterItemRssi:
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneRssi);
+            consumed = true;
+            break;
+        case LoraTesterItemSurvey:
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneSurvey);
+            consumed = true;
+            break;
+        case LoraTesterItemBench:
+            scene_manager_next_scene(app->scene_manager, LoraTesterSceneBench);
+            consumed = true;
+            break;
         case LoraTesterItemAbout:
             scene_manager_next_scene(app->scene_manager, LoraTesterSceneAbout);
             consumed = true;
             break;
+        case LoraTesterCustomEventPopupDone:
+            view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewVarItemList);
+            consumed = true;
+            break;
+        case LoraTesterCustomEventOpDone:
+            // A restore left by the scene before may finish after the menu is back
+            if(app->mode_timeout) {
+                lora_tester_scene_start_show_mode_timeout(app);
+            }
+            consumed = true;
+            break;
         default:
             break;
         }
@@ -143,5 +242,6 @@ bool lora_tester_scene_start_on_event(void* context, SceneManagerEvent event) {
 
 void lora_tester_scene_start_on_exit(void* context) {
     LoraTesterApp* app = context;
+    popup_reset(app->popup);
     variable_item_list_reset(app->var_item_list);
 }
\ No newline at end of file
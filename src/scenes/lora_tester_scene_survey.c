@@ -0,0 +1,304 @@
+#include "../lora_tester_app_i.h"
+#include <furi_hal.h>
+
+/** How long the module gets to answer an RSSI query before it counts as lost */
+#define SURVEY_REPLY_TIMEOUT_MS 200
+#define SURVEY_REPLY_SIZE 5
+/* 50ms on each of the 38 narrowest channels plus the retune costs about 3s a
+ * sweep, shorter dwells trade noise in the averages for a faster band */
+#define SURVEY_DEFAULT_DWELL_INDEX 1
+
+static const uint32_t survey_dwells_ms[] = {20, 50, 100, 200};
+
+static bool survey_stop_requested(void) {
+    return furi_thread_flags_get() & WorkerEventStop;
+}
+
+/** Move the module to channel with a C2 write and return to normal mode,
+ * where the RSSI registers are served
+ */
+static LoraModuleStatus survey_tune(LoraTesterApp* app, uint8_t channel) {
+    lora_tester_set_mode(app, LoRaMode_Config);
+    LoraModuleStatus status = lora_module_write_registers_temporary(
+        app->module, LoraReg2, &channel, 1, LORA_MODULE_TIMEOUT_MS);
+    lora_tester_set_mode(app, LoRaMode_Normal);
+    return status;
+}
+
+/** Average the ambient noise of the current channel for dwell_ms
+ *
+ * Replies mixed with received packets fail the header check and are dropped.
+ */
+static void
+    survey_measure(SurveyContext* survey_context, uint8_t channel, uint32_t dwell_ms) {
+    LoraTesterApp* app = survey_context->app;
+    const uint8_t command[LORA_RSSI_COMMAND_SIZE] = LORA_RSSI_COMMAND;
+    uint8_t reply[SURVEY_REPLY_SIZE];
+    LoraRssiParser parser;
+    int32_t sum = 0;
+    uint32_t samples = 0;
+    uint32_t start = furi_get_tick();
+
+    do {
+        LoraModuleStatus status = lora_module_transact(
+            app->module, command, sizeof(command), reply, sizeof(reply), SURVEY_REPLY_TIMEOUT_MS);
+        if(status != LoraModuleStatusOk) {
+            survey_context->status = status;
+            survey_context->errors++;
+            continue;
+        }
+
+        lora_rssi_parser_reset(&parser);
+        LoraRssiParserResult result = LoraRssiParserData;
+        for(size_t i = 0; i < sizeof(reply); i++) {
+            result = lora_rssi_parser_feed(&parser, reply[i]);
+        }
+        if(result == LoraRssiParserReply) {
+            sum += lora_rssi_dbm(parser.values[0]);
+            samples++;
+        } else {
+            survey_context->status = LoraModuleStatusBadResponse;
+            survey_context->errors++;
+        }
+    } while(!survey_stop_requested() && furi_get_tick() - start < dwell_ms);
+
+    furi_mutex_acquire(survey_context->mutex, FuriWaitForever);
+    lora_survey_set(&survey_context->survey, channel, sum, samples);
+    furi_mutex_release(survey_context->mutex);
+    survey_context->samples += samples;
+}
+
+/** Owns its context from the start, the scene may leave while it restores the module */
+static int32_t survey_worker(void* context) {
+    SurveyContext* survey_context = context;
+    LoraTesterApp* app = survey_context->app;
+
+    if(!lora_module_open(app->module, app->baud_rate)) {
+        survey_context->status = LoraModuleStatusBusy;
+        view_dispatcher_send_custom_event(app->view_dispatcher, LoraTesterCustomEventSurveyUpdate);
+        return 0;
+    }
+
+    // The ambient register reads 0 unless REG1 enables it, so turn it on for the sweep
+    uint8_t reg1 = survey_context->original_registers[0] | LORA_CONFIG_REG1_RSSI_AMBIENT;
+    LoraModuleStatus enabled = LoraModuleStatusOk;
+    if(reg1 != survey_context->original_registers[0]) {
+        lora_tester_set_mode(app, LoRaMode_Config);
+        enabled = lora_module_write_registers_temporary(
+            app->module, LoraReg1, &reg1, 1, LORA_MODULE_TIMEOUT_MS);
+        if(enabled != LoraModuleStatusOk) {
+            survey_context->status = enabled;
+            survey_context->errors++;
+            view_dispatcher_send_custom_event(
+                app->view_dispatcher, LoraTesterCustomEventSurveyUpdate);
+        }
+    }
+
+    // Without the ambient register every channel would average the 0 it reads
+    while(enabled == LoraModuleStatusOk && !survey_stop_requested()) {
+        uint32_t start = furi_get_tick();
+        uint8_t channel;
+
+        for(channel = 0; channel < survey_context->survey.channels; channel++) {
+            if(survey_stop_requested()) {
+                break;
+            }
+
+            furi_mutex_acquire(survey_context->mutex, FuriWaitForever);
+            survey_context->survey.current = channel;
+            furi_mutex_release(survey_context->mutex);
+            view_dispatcher_send_custom_event(
+                app->view_dispatcher, LoraTesterCustomEventSurveyUpdate);
+
+            LoraModuleStatus status = survey_tune(app, channel);
+            if(status == LoraModuleStatusOk) {
+                survey_measure(
+                    survey_context, channel, survey_dwells_ms[survey_context->dwell_index]);
+            } else {
+                survey_context->status = status;
+                survey_context->errors++;
+            }
+        }
+
+        if(channel == survey_context->survey.channels) {
+            survey_context->sweep_ms = furi_get_tick() - start;
+            survey_context->sweeps++;
+        }
+    }
+
+    // Back to the channel and REG1 the module ran before, still without touching flash
+    lora_tester_set_mode(app, LoRaMode_Config);
+    LoraModuleStatus restored = lora_module_write_registers_temporary(
+        app->module,
+        LoraReg1,
+        survey_context->original_registers,
+        sizeof(survey_context->original_registers),
+        LORA_MODULE_TIMEOUT_MS);
+    if(restored != LoraModuleStatusOk) {
+        // The module may be left on a surveyed channel, don't trust the shadow
+        FURI_LOG_E("LoRaTester", "Failed to restore channel after survey");
+        lora_tester_invalidate_registers(app);
+    }
+    lora_module_close(app->module);
+
+    return 0;
+}
+
+static void survey_refresh_view(LoraTesterApp* app) {
+    SurveyContext* survey_context = app->survey_context;
+    uint32_t dwell = survey_dwells_ms[survey_context->dwell_index];
+    char header[32];
+
+    if(survey_context->status != LoraModuleStatusOk && survey_context->samples == 0) {
+        snprintf(
+            header,
+            sizeof(header),
+            "LoRa module: %s",
+            lora_module_status_name(survey_context->status));
+    } else if(survey_context->sweeps) {
+        snprintf(
+            header,
+            sizeof(header),
+            "%lums/ch, sweep %lu.%lus",
+            dwell,
+            survey_context->sweep_ms / 1000,
+            survey_context->sweep_ms % 1000 / 100);
+    } else {
+        snprintf(
+            header,
+            sizeof(header),
+            "%lums/ch, ch %u/%u",
+            dwell,
+            survey_context->survey.current,
+            survey_context->survey.channels);
+    }
+    lora_survey_view_set_header(app->survey_view, header);
+}
+
+static void survey_step_callback(int8_t step, void* context) {
+    LoraTesterApp* app = context;
+    SurveyContext* survey_context = app->survey_context;
+
+    int8_t index = survey_context->dwell_index + step;
+    if(index >= 0 && index < (int8_t)COUNT_OF(survey_dwells_ms)) {
+        survey_context->dwell_index = index;
+        survey_refresh_view(app);
+    }
+}
+
+static void survey_free(void* context) {
+    SurveyContext* survey_context = context;
+    furi_mutex_free(survey_context->mutex);
+    free(survey_context);
+}
+
+static void survey_cleanup(LoraTesterApp* app) {
+    SurveyContext* survey_context = app->survey_context;
+    if(!survey_context) {
+        return;
+    }
+
+    lora_survey_view_set_step_callback(app->survey_view, NULL, NULL);
+    lora_survey_view_set_source(app->survey_view, NULL, NULL);
+    app->survey_context = NULL;
+    if(survey_context->thread) {
+        // The worker puts REG1 and the channel back before it stops, the op worker waits for it
+        furi_thread_flags_set(furi_thread_get_id(survey_context->thread), WorkerEventStop);
+        lora_tester_op_start_restore(
+            app,
+            survey_context->original_mode,
+            survey_context->thread,
+            survey_free,
+            survey_context);
+    } else {
+        survey_free(survey_context);
+    }
+}
+
+static void survey_begin(LoraTesterApp* app, LoraModuleStatus status, const uint8_t* registers) {
+    SurveyContext* survey_context = app->survey_context;
+
+    survey_context->status = status;
+    if(status == LoraModuleStatusOk) {
+        uint8_t bw = LORA_CONFIG_BW_BITS(registers[LoraReg0]);
+        lora_survey_reset(&survey_context->survey, lora_config_max_channel(bw) + 1);
+        survey_context->original_registers[0] = registers[LoraReg1];
+        survey_context->original_registers[1] = registers[LoraReg2];
+        survey_context->original_mode = app->current_mode;
+
+        survey_context->thread =
+            furi_thread_alloc_ex("LoRaSurveyWorker", 1024, survey_worker, survey_context);
+        furi_thread_start(survey_context->thread);
+    } else {
+        lora_survey_reset(&survey_context->survey, 0);
+    }
+
+    survey_refresh_view(app);
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoraTesterAppViewSurveyView);
+}
+
+void lora_tester_scene_survey_on_enter(void* context) {
+    LoraTesterApp* app = context;
+
+    survey_cleanup(app);
+    app->survey_context = malloc(sizeof(SurveyContext));
+    memset(app->survey_context, 0, sizeof(SurveyContext));
+    SurveyContext* survey_context = app->survey_context;
+    survey_context->app = app;
+    survey_context->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    survey_context->dwell_index = SURVEY_DEFAULT_DWELL_INDEX;
+
+    lora_survey_view_set_source(app->survey_view, &survey_context->survey, survey_context->mutex);
+    lora_survey_view_set_step_callback(app->survey_view, survey_step_callback, app);
+
+    // The band and the channel to return to come from the module's registers, a busy op
+    // may be a previous survey still putting them back
+    if(lora_tester_shadow_current(app) && !lora_tester_op_busy(app)) {
+        uint8_t registers[LORA_CONFIG_REG_COUNT];
+        LoraModuleStatus status = lora_tester_read_registers(app, registers, false);
+        survey_begin(app, status, registers);
+    } else {
+        lora_tester_op_start_read(app, false);
+        lora_tester_op_show_progress(app, "Reading Band");
+    }
+}
+
+bool lora_tester_scene_survey_on_event(void* context, SceneManagerEvent event) {
+    LoraTesterApp* app = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        if(event.event == LoraTesterCustomEventSurveyUpdate && app->survey_context) {
+            survey_refresh_view(app);
+            lora_survey_view_update(app->survey_view);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpProgress) {
+            lora_tester_op_update_progress(app);
+            consumed = true;
+        } else if(event.event == LoraTesterCustomEventOpDone) {
+            if(lora_tester_op_take_result(app, LoraTesterOpRead)) {
+                survey_begin(app, app->op.status, app->op.registers);
+            }
+            consumed = true;
+        }
+    } else if(event.type == SceneManagerEventTypeBack) {
+        consumed = scene_manager_search_and_switch_to_previous_scene(
+            app->scene_manager, LoraTesterSceneStart);
+    }
+
+    return consumed;
+}
+
+void lora_tester_scene_survey_on_exit(void* context) {
+    LoraTesterApp* app = context;
+
+    FURI_LOG_I(
+        "LoRaTester",
+        "Channel survey: %lu sweeps, last %lums, %lu samples, %lu errors",
+        app->survey_context->sweeps,
+        app->survey_context->sweep_ms,
+        app->survey_context->samples,
+        app->survey_context->errors);
+    lora_tester_op_cancel(app);
+    survey_cleanup(app);
+}
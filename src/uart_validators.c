@@ -42,9 +42,7 @@ ValidatorIsFile* validator_is_file_alloc_init(
 
     instance->app_path_folder = strdup(app_path_folder);
     instance->app_extension = app_extension;
-    if(current_name != NULL) {
-        instance->current_name = strdup(current_name);
-    }
+    instance->current_name = current_name != NULL ? strdup(current_name) : NULL;
 
     return instance;
 }